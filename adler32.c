@@ -6,6 +6,7 @@
 #include "zbuild.h"
 #include "functable.h"
 #include "adler32_p.h"
+#include "checksum_parallel_p.h"
 
 #ifdef ZLIB_COMPAT
 unsigned long Z_EXPORT PREFIX(adler32_z)(unsigned long adler, const unsigned char *buf, size_t len) {
@@ -36,6 +37,35 @@ uint32_t Z_EXPORT PREFIX(adler32)(uint32_t adler, const unsigned char *buf, uint
 }
 #endif
 
+/* ========================================================================= */
+#ifdef ZLIB_COMPAT
+/* Checksums converted from unsigned long per call to the functable */
+#define ADLER32_MULTI_CHUNK 256
+
+void Z_EXPORT PREFIX(adler32_multi)(unsigned long *adler, const unsigned char * const *buf, const size_t *len,
+                                    size_t count) {
+    uint32_t sum[ADLER32_MULTI_CHUNK];
+
+    while (count) {
+        size_t i, n = MIN(count, ADLER32_MULTI_CHUNK);
+        for (i = 0; i < n; i++)
+            sum[i] = (uint32_t)adler[i];
+        FUNCTABLE_CALL(adler32_multi)(sum, buf, len, n);
+        for (i = 0; i < n; i++)
+            adler[i] = sum[i];
+        adler += n;
+        buf += n;
+        len += n;
+        count -= n;
+    }
+}
+#else
+void Z_EXPORT PREFIX(adler32_multi)(uint32_t *adler, const unsigned char * const *buf, const size_t *len,
+                                    size_t count) {
+    FUNCTABLE_CALL(adler32_multi)(adler, buf, len, count);
+}
+#endif
+
 /* ========================================================================= */
 static uint32_t adler32_combine_(uint32_t adler1, uint32_t adler2, z_off64_t len2) {
     uint32_t sum1;
@@ -75,3 +105,32 @@ uint32_t Z_EXPORT PREFIX4(adler32_combine)(uint32_t adler1, uint32_t adler2, z_o
     return adler32_combine_(adler1, adler2, len2);
 }
 #endif
+
+/* ========================================================================= */
+static uint32_t adler32_parallel_(uint32_t adler, const uint8_t *buf, size_t len, int32_t threads) {
+    checksum_parallel par;
+    size_t i;
+
+    if (!checksum_parallel_run(&par, FUNCTABLE_FPTR(adler32), adler, ADLER32_INITIAL_VALUE, buf, len, threads))
+        return FUNCTABLE_CALL(adler32)(adler, buf, len);
+
+    adler = par.sum[0];
+    for (i = 1; i < par.slices; i++)
+        adler = adler32_combine_(adler, par.sum[i], (z_off64_t)(i == par.slices - 1 ? par.last_len : par.slice_len));
+    return adler;
+}
+
+#ifdef ZLIB_COMPAT
+unsigned long Z_EXPORT PREFIX(adler32_parallel)(unsigned long adler, const unsigned char *buf, size_t len,
+                                                int threads) {
+    if (buf == NULL)
+        return ADLER32_INITIAL_VALUE;
+    return (unsigned long)adler32_parallel_((uint32_t)adler, buf, len, threads);
+}
+#else
+uint32_t Z_EXPORT PREFIX(adler32_parallel)(uint32_t adler, const unsigned char *buf, size_t len, int32_t threads) {
+    if (buf == NULL)
+        return ADLER32_INITIAL_VALUE;
+    return adler32_parallel_(adler, buf, len, threads);
+}
+#endif
@@ -0,0 +1,16 @@
+/* checksum_multi_c.c -- Checksums of several independent buffers, one buffer at a time
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "functable.h"
+
+Z_INTERNAL void adler32_multi_c(uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        adler[i] = FUNCTABLE_CALL(adler32)(adler[i], buf[i], len[i]);
+}
+
+Z_INTERNAL void crc32_multi_c(uint32_t *crc, const uint8_t * const *buf, const size_t *len, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        crc[i] = FUNCTABLE_CALL(crc32)(crc[i], buf[i], len[i]);
+}
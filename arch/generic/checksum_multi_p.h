@@ -0,0 +1,31 @@
+/* checksum_multi_p.h -- Private inline functions shared by the multi-buffer checksum variants
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef CHECKSUM_MULTI_P_H_
+#define CHECKSUM_MULTI_P_H_
+
+#include "zbuild.h"
+
+/* Buffers the SIMD variants checksum side by side. Each lane runs its own dependency chain, so the lanes keep
+ * the vector units busy on buffers far too short for the single-buffer kernels to reach their steady state.
+ */
+#define MULTI_LANES 4
+
+typedef uint32_t (*multi_single_func)(uint32_t sum, const uint8_t *buf, size_t len);
+
+/* Returns the index of the next buffer of at least min_len bytes, or count when none are left. Shorter buffers
+ * skipped on the way are finished with single, setting up a lane for them costs more than it saves.
+ */
+static inline size_t multi_next(uint32_t *sum, const uint8_t * const *buf, const size_t *len, size_t count,
+                                size_t *next, size_t min_len, multi_single_func single) {
+    while (*next < count) {
+        size_t i = (*next)++;
+        if (len[i] >= min_len)
+            return i;
+        sum[i] = single(sum[i], buf[i], len[i]);
+    }
+    return count;
+}
+
+#endif
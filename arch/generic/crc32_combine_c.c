@@ -0,0 +1,18 @@
+/* crc32_combine_c.c -- Bit-serial CRC-32 combine operators
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "zutil.h"
+#include "crc32_braid_p.h"
+#include "crc32_braid_tbl.h"
+#include "crc32_braid_comb_p.h"
+
+Z_INTERNAL void crc32_combine_gen_c(uint32_t *op, const z_off64_t *len2, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        op[i] = x2nmodp(len2[i], 3);
+}
+
+Z_INTERNAL uint32_t crc32_combine_op_c(uint32_t crc1, uint32_t crc2, const uint32_t op) {
+    return multmodp(op, crc1) ^ crc2;
+}
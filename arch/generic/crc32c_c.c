@@ -0,0 +1,14 @@
+/* crc32c_c.c -- CRC-32C with slicing-by-8 tables
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "crc32c_p.h"
+
+Z_INTERNAL uint32_t crc32c_c(uint32_t crc, const uint8_t *buf, size_t len) {
+    return ~crc32c_slice8(~crc, NULL, buf, len, 0);
+}
+
+Z_INTERNAL uint32_t crc32c_copy_c(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len) {
+    return ~crc32c_slice8(~crc, dst, src, len, 1);
+}
@@ -0,0 +1,14 @@
+/* crc64_c.c -- CRC-64/XZ with slicing-by-8 tables
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "crc64_p.h"
+
+Z_INTERNAL uint64_t crc64_c(uint64_t crc, const uint8_t *buf, size_t len) {
+    return ~crc64_slice8(~crc, NULL, buf, len, 0);
+}
+
+Z_INTERNAL uint64_t crc64_copy_c(uint64_t crc, uint8_t *dst, const uint8_t *src, size_t len) {
+    return ~crc64_slice8(~crc, dst, src, len, 1);
+}
@@ -0,0 +1,24 @@
+/* entropy_probe_c.c -- Estimate the order-0 entropy of a block of data
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "entropy_probe_p.h"
+
+Z_INTERNAL uint32_t entropy_probe_c(const uint8_t *buf, size_t len) {
+    uint32_t hist[3][16] = {{0}};
+    uint32_t total = 0;
+
+    for (size_t off = 0; off + PROBE_SAMPLE_LEN <= len; off += PROBE_SAMPLE_STRIDE) {
+        const uint8_t *p = buf + off;
+        for (int i = 0; i < PROBE_SAMPLE_LEN; i++) {
+            unsigned lo = p[i] & 15, hi = p[i] >> 4;
+            hist[PROBE_LO][lo]++;
+            hist[PROBE_HI][hi]++;
+            hist[PROBE_XOR][lo ^ hi]++;
+        }
+        total += PROBE_SAMPLE_LEN;
+    }
+
+    return entropy_probe_finish(hist, total);
+}
@@ -0,0 +1,49 @@
+/* entropy_probe_p.h -- Private inline functions shared by the entropy probe variants
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ENTROPY_PROBE_P_H_
+#define ENTROPY_PROBE_P_H_
+
+#include "zbuild.h"
+#include "zutil_p.h"
+
+/* The probe looks at PROBE_SAMPLE_LEN bytes out of every PROBE_SAMPLE_STRIDE bytes of input. All variants
+ * sample the same bytes and count them exactly, so they return identical estimates for the same input.
+ */
+#define PROBE_SAMPLE_LEN    32
+#define PROBE_SAMPLE_STRIDE 128
+
+/* Histograms kept per sampled byte b: low nibble, high nibble and low ^ high nibble. Any two of the three
+ * determine b, so the entropy sum of any pair is an upper bound on the order-0 entropy of the bytes. Unlike a
+ * 256-bin byte histogram these map directly onto 8-bit SIMD compares.
+ */
+#define PROBE_LO  0
+#define PROBE_HI  1
+#define PROBE_XOR 2
+
+/* Entropy of a 16-bin histogram in bits per symbol with 8 fractional bits */
+static inline uint32_t probe_hist_entropy(const uint32_t *hist, uint32_t total) {
+    uint64_t sum = 0;
+
+    for (int i = 0; i < 16; i++) {
+        if (hist[i])
+            sum += (uint64_t)hist[i] * zng_log2_q8(hist[i]);
+    }
+    return zng_log2_q8(total) - (uint32_t)(sum / total);
+}
+
+/* Estimated bits per byte with 8 fractional bits, ranging from 0 to 8 << 8 */
+static inline uint32_t entropy_probe_finish(uint32_t hist[3][16], uint32_t total) {
+    uint32_t lo, hi, xr;
+
+    if (total == 0)
+        return 0;
+
+    lo = probe_hist_entropy(hist[PROBE_LO], total);
+    hi = probe_hist_entropy(hist[PROBE_HI], total);
+    xr = probe_hist_entropy(hist[PROBE_XOR], total);
+    return MIN(lo + hi, MIN(lo + xr, hi + xr));
+}
+
+#endif
@@ -8,17 +8,20 @@
 #include "zendian.h"
 #include "deflate.h"
 #include "crc32_braid_p.h"
+#include "inftrees.h"
 
 typedef uint32_t (*adler32_func)(uint32_t adler, const uint8_t *buf, size_t len);
 typedef uint32_t (*adler32_copy_func)(uint32_t adler, uint8_t *dst, const uint8_t *src, size_t len);
 typedef uint32_t (*compare256_func)(const uint8_t *src0, const uint8_t *src1);
 typedef uint32_t (*crc32_func)(uint32_t crc, const uint8_t *buf, size_t len);
 typedef uint32_t (*crc32_copy_func)(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+typedef uint32_t (*entropy_probe_func)(const uint8_t *buf, size_t len);
 typedef void     (*slide_hash_func)(deflate_state *s);
 
 
 uint32_t adler32_c(uint32_t adler, const uint8_t *buf, size_t len);
 uint32_t adler32_copy_c(uint32_t adler, uint8_t *dst, const uint8_t *src, size_t len);
+void     adler32_multi_c(uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count);
 
 uint8_t* chunkmemset_safe_c(uint8_t *out, uint8_t *from, unsigned len, unsigned left);
 
@@ -27,6 +30,14 @@ uint32_t compare256_c(const uint8_t *src0, const uint8_t *src1);
 uint32_t crc32_braid(uint32_t crc, const uint8_t *buf, size_t len);
 uint32_t crc32_braid_internal(uint32_t c, const uint8_t *buf, size_t len);
 uint32_t crc32_copy_braid(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+void     crc32_combine_gen_c(uint32_t *op, const z_off64_t *len2, size_t count);
+uint32_t crc32_combine_op_c(uint32_t crc1, uint32_t crc2, const uint32_t op);
+void     crc32_multi_c(uint32_t *crc, const uint8_t * const *buf, const size_t *len, size_t count);
+
+uint32_t crc32c_c(uint32_t crc, const uint8_t *buf, size_t len);
+uint32_t crc32c_copy_c(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+uint64_t crc64_c(uint64_t crc, const uint8_t *buf, size_t len);
+uint64_t crc64_copy_c(uint64_t crc, uint8_t *dst, const uint8_t *src, size_t len);
 
 #ifndef WITHOUT_CHORBA
   uint32_t crc32_chorba(uint32_t crc, const uint8_t *buf, size_t len);
@@ -37,17 +48,24 @@ uint32_t crc32_copy_braid(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t
   uint32_t crc32_copy_chorba(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
 #endif
 
+uint32_t entropy_probe_c(const uint8_t *buf, size_t len);
+
 void     inflate_fast_c(PREFIX3(stream) *strm, uint32_t start);
+int      inflate_table_c(codetype type, uint16_t *lens, unsigned codes, code **table, unsigned *bits, uint16_t *work);
 
 uint32_t longest_match_c(deflate_state *const s, uint32_t cur_match);
 uint32_t longest_match_slow_c(deflate_state *const s, uint32_t cur_match);
 
+block_state deflate_medium(deflate_state *s, int flush);
+block_state deflate_quick(deflate_state *s, int flush);
+
 void     slide_hash_c(deflate_state *s);
 
 #ifdef DISABLE_RUNTIME_CPU_DETECTION
 // Generic code
 #  define native_adler32 adler32_c
 #  define native_adler32_copy adler32_copy_c
+#  define native_adler32_multi adler32_multi_c
 #  define native_chunkmemset_safe chunkmemset_safe_c
 #ifndef WITHOUT_CHORBA
 #  define native_crc32 crc32_chorba
@@ -56,11 +74,22 @@ void     slide_hash_c(deflate_state *s);
 #  define native_crc32 crc32_braid
 #  define native_crc32_copy crc32_copy_braid
 #endif
+#  define native_crc32_combine_gen crc32_combine_gen_c
+#  define native_crc32_combine_op crc32_combine_op_c
+#  define native_crc32_multi crc32_multi_c
+#  define native_crc32c crc32c_c
+#  define native_crc32c_copy crc32c_copy_c
+#  define native_crc64 crc64_c
+#  define native_crc64_copy crc64_copy_c
+#  define native_entropy_probe entropy_probe_c
 #  define native_inflate_fast inflate_fast_c
+#  define native_inflate_table inflate_table_c
 #  define native_slide_hash slide_hash_c
 #  define native_longest_match longest_match_c
 #  define native_longest_match_slow longest_match_slow_c
 #  define native_compare256 compare256_c
+#  define native_deflate_medium deflate_medium
+#  define native_deflate_quick deflate_quick
 #endif
 
 #endif
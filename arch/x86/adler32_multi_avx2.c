@@ -0,0 +1,82 @@
+/* adler32_multi_avx2.c -- AVX2 Adler-32 of several independent buffers
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_AVX2
+
+#include "zbuild.h"
+#include "adler32_multi_p.h"
+
+#include <immintrin.h>
+
+extern uint32_t adler32_avx2(uint32_t adler, const uint8_t *src, size_t len);
+
+#define ADLER_MULTI_BLOCK_AVX2 32
+
+/* Weighted sum of the 32 bytes in vbuf, the first byte counting 32 times and the last once */
+static inline __m256i adler32_multi_dot_avx2(__m256i vbuf) {
+    const __m256i dot2v = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                           16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i dot3v = _mm256_set1_epi16(1);
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(vbuf, dot2v), dot3v);
+}
+
+/* One 32-byte block of one lane, vs3 collects the running s1 of earlier blocks to be scaled by the block size */
+Z_FORCEINLINE static void adler32_multi_block_avx2(__m256i *vs1, __m256i *vs2, __m256i *vs3, const uint8_t *src) {
+    __m256i vbuf = _mm256_loadu_si256((const __m256i *)src);
+
+    *vs3 = _mm256_add_epi32(*vs3, *vs1);
+    *vs1 = _mm256_add_epi32(*vs1, _mm256_sad_epu8(vbuf, _mm256_setzero_si256()));
+    *vs2 = _mm256_add_epi32(*vs2, adler32_multi_dot_avx2(vbuf));
+}
+
+/* The tail of one lane, the last tail bytes of the block ending at end */
+Z_FORCEINLINE static void adler32_multi_tail_avx2(__m256i *vt1, __m256i *vt2, const uint8_t *end, size_t tail) {
+    __m256i mask = _mm256_loadu_si256((const __m256i *)(adler32_multi_tail_mask + tail));
+    __m256i vbuf = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(end - ADLER_MULTI_BLOCK_AVX2)), mask);
+
+    *vt1 = _mm256_sad_epu8(vbuf, _mm256_setzero_si256());
+    *vt2 = adler32_multi_dot_avx2(vbuf);
+}
+
+/* Sums each of a, b, c and d into one lane of the result */
+static inline __m128i hsum4_epi32_avx2(__m256i a, __m256i b, __m256i c, __m256i d) {
+    __m256i sum = _mm256_hadd_epi32(_mm256_hadd_epi32(a, b), _mm256_hadd_epi32(c, d));
+    return _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+}
+
+static void adler32_multi_run_avx2(uint32_t *adler, const uint8_t * const *p, const size_t *blocks,
+                                   const size_t *tail, size_t max_blocks) {
+    size_t skip_0 = max_blocks - blocks[0], skip_1 = max_blocks - blocks[1];
+    size_t skip_2 = max_blocks - blocks[2], skip_3 = max_blocks - blocks[3];
+    __m256i vs1_0 = _mm256_setzero_si256(), vs1_1 = vs1_0, vs1_2 = vs1_0, vs1_3 = vs1_0;
+    __m256i vs2_0 = vs1_0, vs2_1 = vs1_0, vs2_2 = vs1_0, vs2_3 = vs1_0;
+    __m256i vs3_0 = vs1_0, vs3_1 = vs1_0, vs3_2 = vs1_0, vs3_3 = vs1_0;
+    __m256i vt1_0, vt1_1, vt1_2, vt1_3, vt2_0, vt2_1, vt2_2, vt2_3;
+
+    for (size_t i = 0; i < max_blocks; i++) {
+        adler32_multi_block_avx2(&vs1_0, &vs2_0, &vs3_0, adler32_multi_src(p[0], i, skip_0, ADLER_MULTI_BLOCK_AVX2));
+        adler32_multi_block_avx2(&vs1_1, &vs2_1, &vs3_1, adler32_multi_src(p[1], i, skip_1, ADLER_MULTI_BLOCK_AVX2));
+        adler32_multi_block_avx2(&vs1_2, &vs2_2, &vs3_2, adler32_multi_src(p[2], i, skip_2, ADLER_MULTI_BLOCK_AVX2));
+        adler32_multi_block_avx2(&vs1_3, &vs2_3, &vs3_3, adler32_multi_src(p[3], i, skip_3, ADLER_MULTI_BLOCK_AVX2));
+    }
+
+    adler32_multi_tail_avx2(&vt1_0, &vt2_0, p[0] + blocks[0] * ADLER_MULTI_BLOCK_AVX2 + tail[0], tail[0]);
+    adler32_multi_tail_avx2(&vt1_1, &vt2_1, p[1] + blocks[1] * ADLER_MULTI_BLOCK_AVX2 + tail[1], tail[1]);
+    adler32_multi_tail_avx2(&vt1_2, &vt2_2, p[2] + blocks[2] * ADLER_MULTI_BLOCK_AVX2 + tail[2], tail[2]);
+    adler32_multi_tail_avx2(&vt1_3, &vt2_3, p[3] + blocks[3] * ADLER_MULTI_BLOCK_AVX2 + tail[3], tail[3]);
+
+    __m128i s1 = hsum4_epi32_avx2(vs1_0, vs1_1, vs1_2, vs1_3);
+    __m128i s2 = hsum4_epi32_avx2(vs2_0, vs2_1, vs2_2, vs2_3);
+    __m128i s3 = hsum4_epi32_avx2(vs3_0, vs3_1, vs3_2, vs3_3);
+    __m128i t1 = hsum4_epi32_avx2(vt1_0, vt1_1, vt1_2, vt1_3);
+    __m128i t2 = hsum4_epi32_avx2(vt2_0, vt2_1, vt2_2, vt2_3);
+    s2 = _mm_add_epi32(s2, _mm_slli_epi32(s3, 5));
+    adler32_multi_store(adler, s1, s2, t1, t2, blocks, tail, ADLER_MULTI_BLOCK_AVX2);
+}
+
+Z_INTERNAL void adler32_multi_avx2(uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count) {
+    adler32_multi_impl(adler, buf, len, count, ADLER_MULTI_BLOCK_AVX2, adler32_multi_run_avx2, adler32_avx2);
+}
+
+#endif
@@ -0,0 +1,133 @@
+/* adler32_multi_p.h -- Lane scheduling and reduction shared by the x86 multi-buffer Adler-32 variants
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ADLER32_MULTI_P_H_
+#define ADLER32_MULTI_P_H_
+
+#include "adler32_p.h"
+#include "arch/generic/checksum_multi_p.h"
+
+#include <immintrin.h>
+
+/* Checksums blocks[i] blocks followed by tail[i] bytes of each of the MULTI_LANES buffers in p, every tail is
+ * shorter than a block and no lane covers more than NMAX bytes. Lanes start staggered so that they all end with
+ * the last of the max_blocks steps: a lane sums zeros until its own blocks start, which leaves its sums untouched
+ * as long as they start from zero, the initial checksum is added on at the end. adler holds one running checksum
+ * per lane on entry and on return.
+ */
+typedef void (*adler32_multi_run_func)(uint32_t *adler, const uint8_t * const *p, const size_t *blocks,
+                                       const size_t *tail, size_t max_blocks);
+
+/* Loaded at offset BLOCK - tail this keeps only the last tail bytes of a block. The run functions read a lane's
+ * tail as the block ending at the end of its buffer and mask off the bytes already summed, since a lane never
+ * takes a buffer shorter than a block that read always stays inside the buffer. The first 32 bytes double as the
+ * zero block the staggered lanes read before their own blocks start.
+ */
+static const uint8_t adler32_multi_tail_mask[64] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/* Block i of a lane whose own blocks start skip steps into the run */
+static inline const uint8_t *adler32_multi_src(const uint8_t *p, size_t i, size_t skip, const size_t BLOCK) {
+    return i < skip ? adler32_multi_tail_mask : p + (i - skip) * BLOCK;
+}
+
+/* Reduces each lane modulo BASE. Folding the high half twice using 65536 = 15 (mod BASE) takes any 32-bit value
+ * below 2 * BASE, a single conditional subtract finishes it.
+ */
+static inline __m128i adler32_multi_mod(__m128i x) {
+    const __m128i lo16 = _mm_set1_epi32(0xffff);
+    __m128i hi;
+
+    hi = _mm_srli_epi32(x, 16);
+    x = _mm_add_epi32(_mm_and_si128(x, lo16), _mm_sub_epi32(_mm_slli_epi32(hi, 4), hi));
+    hi = _mm_srli_epi32(x, 16);
+    x = _mm_add_epi32(_mm_and_si128(x, lo16), _mm_sub_epi32(_mm_slli_epi32(hi, 4), hi));
+    return _mm_min_epu32(x, _mm_sub_epi32(x, _mm_set1_epi32(BASE)));
+}
+
+/* Adds the initial checksums on to the sums of the data and packs them back into Adler-32 values. s1 and s2 are the
+ * sums of the blocks, tail_s1 and tail_s2 the plain and weighted sums of the tails. Each tail byte still has to
+ * shift s1 into s2 once, as does every byte for the initial s1.
+ */
+static inline void adler32_multi_store(uint32_t *adler, __m128i s1, __m128i s2, __m128i tail_s1, __m128i tail_s2,
+                                       const size_t *blocks, const size_t *tail, const size_t BLOCK) {
+    __m128i tail_len = _mm_setr_epi32((int)tail[0], (int)tail[1], (int)tail[2], (int)tail[3]);
+    __m128i total_len = _mm_add_epi32(tail_len, _mm_setr_epi32((int)(blocks[0] * BLOCK), (int)(blocks[1] * BLOCK),
+                                                               (int)(blocks[2] * BLOCK), (int)(blocks[3] * BLOCK)));
+    __m128i adler_in = _mm_setr_epi32((int)adler[0], (int)adler[1], (int)adler[2], (int)adler[3]);
+    __m128i s1_in = _mm_and_si128(adler_in, _mm_set1_epi32(0xffff));
+    __m128i s2_in = _mm_srli_epi32(adler_in, 16);
+
+    s2 = _mm_add_epi32(_mm_add_epi32(s2, tail_s2), _mm_mullo_epi32(s1, tail_len));
+    s2 = _mm_add_epi32(_mm_add_epi32(s2, s2_in), _mm_mullo_epi32(s1_in, total_len));
+    s1 = _mm_add_epi32(_mm_add_epi32(s1, tail_s1), s1_in);
+    s1 = adler32_multi_mod(s1);
+    s2 = adler32_multi_mod(s2);
+    _mm_storeu_si128((__m128i *)adler, _mm_or_si128(s1, _mm_slli_epi32(s2, 16)));
+}
+
+/* Hands buffers of at least BLOCK bytes out to the lanes. Each run covers the whole of every lane's buffer, up to
+ * NMAX bytes, so all four lanes are usually refilled together and the reduction is shared by four buffers. Buffers
+ * shorter than a block and those left over once there are no longer enough to fill every lane go through single.
+ */
+Z_FORCEINLINE static void adler32_multi_impl(uint32_t *adler, const uint8_t * const *buf, const size_t *len,
+                                             size_t count, const size_t BLOCK, adler32_multi_run_func run,
+                                             multi_single_func single) {
+    uint32_t sum[MULTI_LANES];
+    const uint8_t *p[MULTI_LANES];
+    size_t left[MULTI_LANES], blocks[MULTI_LANES], tail[MULTI_LANES], idx[MULTI_LANES];
+    size_t next = 0;
+    int lanes, j;
+
+    for (j = 0; j < MULTI_LANES; j++)
+        idx[j] = count;
+
+    for (lanes = 0; lanes < MULTI_LANES; lanes++) {
+        idx[lanes] = multi_next(adler, buf, len, count, &next, BLOCK, single);
+        if (idx[lanes] == count)
+            break;
+        sum[lanes] = adler[idx[lanes]];
+        p[lanes] = buf[idx[lanes]];
+        left[lanes] = len[idx[lanes]];
+    }
+
+    while (lanes == MULTI_LANES) {
+        size_t max_blocks = 0;
+        for (j = 0; j < MULTI_LANES; j++) {
+            blocks[j] = MIN(left[j], NMAX - BLOCK) / BLOCK;
+            left[j] -= blocks[j] * BLOCK;
+            tail[j] = left[j] < BLOCK ? left[j] : 0;
+            left[j] -= tail[j];
+            max_blocks = MAX(max_blocks, blocks[j]);
+        }
+
+        run(sum, p, blocks, tail, max_blocks);
+
+        for (j = 0; j < MULTI_LANES; j++) {
+            p[j] += blocks[j] * BLOCK + tail[j];
+            if (left[j])
+                continue;
+            adler[idx[j]] = sum[j];
+            idx[j] = multi_next(adler, buf, len, count, &next, BLOCK, single);
+            if (idx[j] == count) {
+                lanes--;
+                continue;
+            }
+            sum[j] = adler[idx[j]];
+            p[j] = buf[idx[j]];
+            left[j] = len[idx[j]];
+        }
+    }
+
+    /* Not enough buffers left to fill the lanes */
+    for (j = 0; j < MULTI_LANES; j++) {
+        if (idx[j] < count)
+            adler[idx[j]] = single(sum[j], p[j], left[j]);
+    }
+}
+
+#endif
@@ -0,0 +1,80 @@
+/* adler32_multi_sse41.c -- SSE4.1 Adler-32 of several independent buffers
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_SSE41
+
+#include "zbuild.h"
+#include "adler32_multi_p.h"
+
+#include <immintrin.h>
+
+extern uint32_t adler32_ssse3(uint32_t adler, const uint8_t *src, size_t len);
+
+#define ADLER_MULTI_BLOCK_SSE41 16
+
+/* Weighted sum of the 16 bytes in vbuf, the first byte counting 16 times and the last once */
+static inline __m128i adler32_multi_dot_sse41(__m128i vbuf) {
+    const __m128i dot2v = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i dot3v = _mm_set1_epi16(1);
+    return _mm_madd_epi16(_mm_maddubs_epi16(vbuf, dot2v), dot3v);
+}
+
+/* One 16-byte block of one lane, vs3 collects the running s1 of earlier blocks to be scaled by the block size */
+Z_FORCEINLINE static void adler32_multi_block_sse41(__m128i *vs1, __m128i *vs2, __m128i *vs3, const uint8_t *src) {
+    __m128i vbuf = _mm_loadu_si128((const __m128i *)src);
+
+    *vs3 = _mm_add_epi32(*vs3, *vs1);
+    *vs1 = _mm_add_epi32(*vs1, _mm_sad_epu8(vbuf, _mm_setzero_si128()));
+    *vs2 = _mm_add_epi32(*vs2, adler32_multi_dot_sse41(vbuf));
+}
+
+/* The tail of one lane, the last tail bytes of the block ending at end */
+Z_FORCEINLINE static void adler32_multi_tail_sse41(__m128i *vt1, __m128i *vt2, const uint8_t *end, size_t tail) {
+    __m128i mask = _mm_loadu_si128((const __m128i *)(adler32_multi_tail_mask + ADLER_MULTI_BLOCK_SSE41 + tail));
+    __m128i vbuf = _mm_and_si128(_mm_loadu_si128((const __m128i *)(end - ADLER_MULTI_BLOCK_SSE41)), mask);
+
+    *vt1 = _mm_sad_epu8(vbuf, _mm_setzero_si128());
+    *vt2 = adler32_multi_dot_sse41(vbuf);
+}
+
+/* Sums each of a, b, c and d into one lane of the result */
+static inline __m128i hsum4_epi32_sse41(__m128i a, __m128i b, __m128i c, __m128i d) {
+    return _mm_hadd_epi32(_mm_hadd_epi32(a, b), _mm_hadd_epi32(c, d));
+}
+
+static void adler32_multi_run_sse41(uint32_t *adler, const uint8_t * const *p, const size_t *blocks,
+                                    const size_t *tail, size_t max_blocks) {
+    size_t skip_0 = max_blocks - blocks[0], skip_1 = max_blocks - blocks[1];
+    size_t skip_2 = max_blocks - blocks[2], skip_3 = max_blocks - blocks[3];
+    __m128i vs1_0 = _mm_setzero_si128(), vs1_1 = vs1_0, vs1_2 = vs1_0, vs1_3 = vs1_0;
+    __m128i vs2_0 = vs1_0, vs2_1 = vs1_0, vs2_2 = vs1_0, vs2_3 = vs1_0;
+    __m128i vs3_0 = vs1_0, vs3_1 = vs1_0, vs3_2 = vs1_0, vs3_3 = vs1_0;
+    __m128i vt1_0, vt1_1, vt1_2, vt1_3, vt2_0, vt2_1, vt2_2, vt2_3;
+
+    for (size_t i = 0; i < max_blocks; i++) {
+        adler32_multi_block_sse41(&vs1_0, &vs2_0, &vs3_0, adler32_multi_src(p[0], i, skip_0, ADLER_MULTI_BLOCK_SSE41));
+        adler32_multi_block_sse41(&vs1_1, &vs2_1, &vs3_1, adler32_multi_src(p[1], i, skip_1, ADLER_MULTI_BLOCK_SSE41));
+        adler32_multi_block_sse41(&vs1_2, &vs2_2, &vs3_2, adler32_multi_src(p[2], i, skip_2, ADLER_MULTI_BLOCK_SSE41));
+        adler32_multi_block_sse41(&vs1_3, &vs2_3, &vs3_3, adler32_multi_src(p[3], i, skip_3, ADLER_MULTI_BLOCK_SSE41));
+    }
+
+    adler32_multi_tail_sse41(&vt1_0, &vt2_0, p[0] + blocks[0] * ADLER_MULTI_BLOCK_SSE41 + tail[0], tail[0]);
+    adler32_multi_tail_sse41(&vt1_1, &vt2_1, p[1] + blocks[1] * ADLER_MULTI_BLOCK_SSE41 + tail[1], tail[1]);
+    adler32_multi_tail_sse41(&vt1_2, &vt2_2, p[2] + blocks[2] * ADLER_MULTI_BLOCK_SSE41 + tail[2], tail[2]);
+    adler32_multi_tail_sse41(&vt1_3, &vt2_3, p[3] + blocks[3] * ADLER_MULTI_BLOCK_SSE41 + tail[3], tail[3]);
+
+    __m128i s1 = hsum4_epi32_sse41(vs1_0, vs1_1, vs1_2, vs1_3);
+    __m128i s2 = hsum4_epi32_sse41(vs2_0, vs2_1, vs2_2, vs2_3);
+    __m128i s3 = hsum4_epi32_sse41(vs3_0, vs3_1, vs3_2, vs3_3);
+    __m128i t1 = hsum4_epi32_sse41(vt1_0, vt1_1, vt1_2, vt1_3);
+    __m128i t2 = hsum4_epi32_sse41(vt2_0, vt2_1, vt2_2, vt2_3);
+    s2 = _mm_add_epi32(s2, _mm_slli_epi32(s3, 4));
+    adler32_multi_store(adler, s1, s2, t1, t2, blocks, tail, ADLER_MULTI_BLOCK_SSE41);
+}
+
+Z_INTERNAL void adler32_multi_sse41(uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count) {
+    adler32_multi_impl(adler, buf, len, count, ADLER_MULTI_BLOCK_SSE41, adler32_multi_run_sse41, adler32_ssse3);
+}
+
+#endif
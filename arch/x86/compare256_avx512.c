@@ -94,4 +94,17 @@ Z_INTERNAL uint32_t compare256_avx512(const uint8_t *src0, const uint8_t *src1)
 
 #include "match_tpl.h"
 
+/* The deflate_quick and deflate_medium loops, built here to have compare256 and longest_match inline */
+#define DEFLATE_QUICK           deflate_quick_avx512
+#define QUICK_COMPARE256        compare256_avx512_static
+
+#include "deflate_quick_tpl.h"
+
+#ifndef NO_MEDIUM_STRATEGY
+#define DEFLATE_MEDIUM          deflate_medium_avx512
+#define MEDIUM_LONGEST_MATCH    longest_match_avx512
+
+#include "deflate_medium_tpl.h"
+#endif
+
 #endif
@@ -0,0 +1,123 @@
+/* crc32_combine_pclmulqdq.c -- PCLMULQDQ CRC-32 combine operators
+ *
+ * multmodp() as a carry-less multiply followed by a Barrett reduction, with the constants crc32_pclmulqdq_tpl.h
+ * uses for its final reduction. Rather than x2nmodp()'s one multiply per bit of the length, operators are built
+ * from a table of the powers for each hex digit of it, at most sixteen multiplies for any length. Operators for
+ * several lengths are generated side by side so the multiply latency of one length hides behind the others.
+ *
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_PCLMULQDQ_CRC
+
+#include "zbuild.h"
+#include "zutil.h"
+
+#include <immintrin.h>
+#include <wmmintrin.h>
+
+/* x^0, the multiplicative identity in the reflected bit order */
+#define CRC_COMBINE_ONE 0x80000000
+
+/* Generated side by side */
+#define CRC_COMBINE_LANES 4
+
+/* crc32_combine_digit[i][d] is x^(8 * d * 16^i) modulo p(x), the operator for digit d in hex digit i of a length.
+ * A zero digit gives x^0, so that lanes with nothing left to multiply in stay as they are.
+ */
+static const uint32_t crc32_combine_digit[16][16] = {
+    {0x80000000, 0x00800000, 0x00008000, 0x00000080, 0xedb88320, 0x3b83984b, 0xe1351b80, 0xed59b63b,
+     0xb1e6b092, 0x1eb014d8, 0x8816eaf2, 0x533b85da, 0x6655004f, 0xe6050901, 0x77e1359f, 0x60c76fe0},
+    {0x80000000, 0xa06a2517, 0xed627dae, 0x15141c31, 0x88d14467, 0x4721589f, 0xe5b592b8, 0x6325605c,
+     0xd7bbfe6a, 0xdb54814c, 0x0eaee722, 0x784d2a56, 0x62b6ca4b, 0x291ea462, 0x6b1d2b53, 0x8fd2cd3c},
+    {0x80000000, 0xec447f11, 0x8e7ea170, 0x05616c82, 0x6427800e, 0x5ef840e2, 0xbf110f7e, 0x118f848e,
+     0x4d47bae0, 0xa84bdc84, 0x0b19ae7f, 0xaf5619bc, 0x6347a4bd, 0xd91ef3cb, 0x13d40d42, 0x5b6cda72},
+    {0x80000000, 0x09fe548f, 0x83852d0f, 0xe4b54665, 0x30362f1a, 0x668145e1, 0xf27674ad, 0xb8c9f94b,
+     0x7b5a9cc3, 0x866744b2, 0xc99622b9, 0xafe90854, 0xec735cea, 0xefe9d761, 0x0f9f0002, 0xf014301e},
+    {0x80000000, 0x31fec169, 0x9fec022a, 0x169810b5, 0x6c8dedc4, 0x2484f1bc, 0x0abf1a4f, 0x31ca80c2,
+     0x15d6874d, 0xbd2a626f, 0xaddc2f07, 0x6736439c, 0x07474644, 0xf4165146, 0xfb765627, 0xe2faf430},
+    {0x80000000, 0x5fde7a4e, 0xbad90e37, 0x799a8cf7, 0x2e4e5eef, 0x7ad256cc, 0x725d2aad, 0xc340f13e,
+     0x4eaba214, 0x05efb6ad, 0x36a60923, 0x65b78f8d, 0xdfcd2365, 0x55252240, 0x2177bc48, 0x3446c848},
+    {0x80000000, 0xa8a472c0, 0x429a969e, 0x3e855758, 0x148d302a, 0xec8302fa, 0x6633295b, 0x9dd77bf8,
+     0xc40ba6d0, 0xc0262b6b, 0x9c7b4c60, 0x48536a3e, 0x966bbc20, 0x21476b31, 0xa1c375b0, 0x33f2d7b5},
+    {0x80000000, 0xc4e22c3c, 0x40000000, 0x6271161e, 0x20000000, 0x31388b0f, 0x10000000, 0xf524c6a7,
+     0x08000000, 0x972ae073, 0x04000000, 0xa62df319, 0x02000000, 0xbeae7aac, 0x01000000, 0x5f573d56},
+    {0x80000000, 0x00800000, 0x00008000, 0x00000080, 0xedb88320, 0x3b83984b, 0xe1351b80, 0xed59b63b,
+     0xb1e6b092, 0x1eb014d8, 0x8816eaf2, 0x533b85da, 0x6655004f, 0xe6050901, 0x77e1359f, 0x60c76fe0},
+    {0x80000000, 0xa06a2517, 0xed627dae, 0x15141c31, 0x88d14467, 0x4721589f, 0xe5b592b8, 0x6325605c,
+     0xd7bbfe6a, 0xdb54814c, 0x0eaee722, 0x784d2a56, 0x62b6ca4b, 0x291ea462, 0x6b1d2b53, 0x8fd2cd3c},
+    {0x80000000, 0xec447f11, 0x8e7ea170, 0x05616c82, 0x6427800e, 0x5ef840e2, 0xbf110f7e, 0x118f848e,
+     0x4d47bae0, 0xa84bdc84, 0x0b19ae7f, 0xaf5619bc, 0x6347a4bd, 0xd91ef3cb, 0x13d40d42, 0x5b6cda72},
+    {0x80000000, 0x09fe548f, 0x83852d0f, 0xe4b54665, 0x30362f1a, 0x668145e1, 0xf27674ad, 0xb8c9f94b,
+     0x7b5a9cc3, 0x866744b2, 0xc99622b9, 0xafe90854, 0xec735cea, 0xefe9d761, 0x0f9f0002, 0xf014301e},
+    {0x80000000, 0x31fec169, 0x9fec022a, 0x169810b5, 0x6c8dedc4, 0x2484f1bc, 0x0abf1a4f, 0x31ca80c2,
+     0x15d6874d, 0xbd2a626f, 0xaddc2f07, 0x6736439c, 0x07474644, 0xf4165146, 0xfb765627, 0xe2faf430},
+    {0x80000000, 0x5fde7a4e, 0xbad90e37, 0x799a8cf7, 0x2e4e5eef, 0x7ad256cc, 0x725d2aad, 0xc340f13e,
+     0x4eaba214, 0x05efb6ad, 0x36a60923, 0x65b78f8d, 0xdfcd2365, 0x55252240, 0x2177bc48, 0x3446c848},
+    {0x80000000, 0xa8a472c0, 0x429a969e, 0x3e855758, 0x148d302a, 0xec8302fa, 0x6633295b, 0x9dd77bf8,
+     0xc40ba6d0, 0xc0262b6b, 0x9c7b4c60, 0x48536a3e, 0x966bbc20, 0x21476b31, 0xa1c375b0, 0x33f2d7b5},
+    {0x80000000, 0xc4e22c3c, 0x40000000, 0x6271161e, 0x20000000, 0x31388b0f, 0x10000000, 0xf524c6a7,
+     0x08000000, 0x972ae073, 0x04000000, 0xa62df319, 0x02000000, 0xbeae7aac, 0x01000000, 0x5f573d56}
+};
+
+/* Returns a(x) * b(x) modulo p(x) in the low 32 bits, both inputs in the low 32 bits and the rest zero. Unlike
+ * multmodp(), a may be zero.
+ */
+static inline __m128i crc32_combine_mulmod(__m128i a, __m128i b) {
+    const __m128i barrett_k = _mm_set_epi64x(0x1db710641, 0x1f7011641);
+    const __m128i lo32 = _mm_set_epi64x(0, 0xffffffff);
+    __m128i prod, t1, t2;
+
+    /* The 63-bit product moved up one so that x^0 lands on bit 63, its top half is then already in the reflected
+       order of a CRC and its bottom half holds x^32 and up, which the reduction folds back into it */
+    prod = _mm_slli_epi64(_mm_clmulepi64_si128(a, b, 0x00), 1);
+    t1 = _mm_clmulepi64_si128(_mm_and_si128(prod, lo32), barrett_k, 0x00);
+    t2 = _mm_clmulepi64_si128(_mm_and_si128(t1, lo32), barrett_k, 0x10);
+    return _mm_srli_epi64(_mm_xor_si128(prod, t2), 32);
+}
+
+/* Operator for hex digit i of len */
+static inline __m128i crc32_combine_factor(uint64_t len, unsigned i) {
+    return _mm_cvtsi32_si128((int)crc32_combine_digit[i][(len >> (i * 4)) & 15]);
+}
+
+Z_INTERNAL void crc32_combine_gen_pclmulqdq(uint32_t *op, const z_off64_t *len, size_t count) {
+    size_t i = 0;
+
+    for (; i + CRC_COMBINE_LANES <= count; i += CRC_COMBINE_LANES) {
+        uint64_t len0 = (uint64_t)len[i], len1 = (uint64_t)len[i + 1];
+        uint64_t len2 = (uint64_t)len[i + 2], len3 = (uint64_t)len[i + 3];
+        uint64_t digits = len0 | len1 | len2 | len3;
+        __m128i x0 = _mm_cvtsi32_si128((int)CRC_COMBINE_ONE), x1 = x0, x2 = x0, x3 = x0;
+
+        for (unsigned k = 0; k < 16 && (digits >> (k * 4)); k++) {
+            x0 = crc32_combine_mulmod(crc32_combine_factor(len0, k), x0);
+            x1 = crc32_combine_mulmod(crc32_combine_factor(len1, k), x1);
+            x2 = crc32_combine_mulmod(crc32_combine_factor(len2, k), x2);
+            x3 = crc32_combine_mulmod(crc32_combine_factor(len3, k), x3);
+        }
+        op[i] = (uint32_t)_mm_cvtsi128_si32(x0);
+        op[i + 1] = (uint32_t)_mm_cvtsi128_si32(x1);
+        op[i + 2] = (uint32_t)_mm_cvtsi128_si32(x2);
+        op[i + 3] = (uint32_t)_mm_cvtsi128_si32(x3);
+    }
+
+    /* A single length only multiplies in the digits that are not zero */
+    for (; i < count; i++) {
+        uint64_t digits = (uint64_t)len[i];
+        __m128i x = _mm_cvtsi32_si128((int)CRC_COMBINE_ONE);
+
+        for (unsigned k = 0; k < 16 && (digits >> (k * 4)); k++) {
+            if ((digits >> (k * 4)) & 15)
+                x = crc32_combine_mulmod(crc32_combine_factor(digits, k), x);
+        }
+        op[i] = (uint32_t)_mm_cvtsi128_si32(x);
+    }
+}
+
+Z_INTERNAL uint32_t crc32_combine_op_pclmulqdq(uint32_t crc1, uint32_t crc2, const uint32_t op) {
+    __m128i prod = crc32_combine_mulmod(_mm_cvtsi32_si128((int)op), _mm_cvtsi32_si128((int)crc1));
+    return (uint32_t)_mm_cvtsi128_si32(prod) ^ crc2;
+}
+
+#endif
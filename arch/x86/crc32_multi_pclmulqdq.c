@@ -0,0 +1,134 @@
+/* crc32_multi_pclmulqdq.c -- PCLMULQDQ CRC-32 of several independent buffers
+ *
+ * Uses the same folding constants as crc32_pclmulqdq_tpl.h, but keeps a single 128-bit fold state per buffer
+ * and advances MULTI_LANES buffers side by side, so the multiply latency of one lane hides behind the others
+ * instead of behind the four accumulators of one long buffer.
+ *
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_PCLMULQDQ_CRC
+
+#include "zbuild.h"
+#include "arch/generic/checksum_multi_p.h"
+
+#include <immintrin.h>
+#include <wmmintrin.h>
+#include <smmintrin.h> // _mm_extract_epi32
+
+extern uint32_t crc32_pclmulqdq(uint32_t crc, const uint8_t *buf, size_t len);
+
+#define CRC_MULTI_BLOCK 16
+
+/* State after the first 16 bytes of a buffer. The constant is the 0x9db42487 that crc32_pclmulqdq_tpl.h seeds
+ * its first accumulator with, already folded over the 64 bytes it stands in front of.
+ */
+static inline __m128i crc32_multi_start(uint32_t crc, const uint8_t *src) {
+    const __m128i init = _mm_set_epi64x(0, (int64_t)(0xb151b23afc8ce92cULL ^ crc));
+    return _mm_xor_si128(_mm_loadu_si128((const __m128i *)src), init);
+}
+
+/* Folds the state forward over the next 16 bytes of src */
+static inline __m128i crc32_multi_fold(__m128i crc_state, const uint8_t *src) {
+    const __m128i k12 = _mm_set_epi32(0x00000001, 0x751997d0, 0x00000000, 0xccaa009e);
+    __m128i x_low  = _mm_clmulepi64_si128(crc_state, k12, 0x01);
+    __m128i x_high = _mm_clmulepi64_si128(crc_state, k12, 0x10);
+    return _mm_xor_si128(_mm_xor_si128(x_low, x_high), _mm_loadu_si128((const __m128i *)src));
+}
+
+/* Folds in the rest of the buffer and reduces the state to the final CRC-32 */
+static uint32_t crc32_multi_finish(__m128i crc_state, const uint8_t *src, size_t len) {
+    const __m128i k12 = _mm_set_epi32(0x00000001, 0x751997d0, 0x00000000, 0xccaa009e);
+    const __m128i barrett_k = _mm_set_epi32(0x00000001, 0xdb710640, 0xb4e5b025, 0xf7011641);
+
+    for (; len >= CRC_MULTI_BLOCK; src += CRC_MULTI_BLOCK, len -= CRC_MULTI_BLOCK)
+        crc_state = crc32_multi_fold(crc_state, src);
+
+    if (len) {
+        const __m128i xmm_mask3 = _mm_set1_epi32((int32_t)0x80808080);
+        const __m128i xmm_seq = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        __m128i xmm_shl = _mm_add_epi8(xmm_seq, _mm_set1_epi8((char)len - 16));
+        __m128i xmm_shr = _mm_xor_si128(xmm_shl, xmm_mask3);
+        __m128i xmm_part = _mm_setzero_si128();
+
+        /* Shift the tail in from the top, folding out what it displaces */
+        __m128i xmm_overflow = _mm_shuffle_epi8(crc_state, xmm_shl);
+        crc_state = _mm_shuffle_epi8(crc_state, xmm_shr);
+        memcpy(&xmm_part, src, len);
+        crc_state = _mm_xor_si128(crc_state, _mm_shuffle_epi8(xmm_part, xmm_shl));
+
+        __m128i ovf_low  = _mm_clmulepi64_si128(xmm_overflow, k12, 0x01);
+        __m128i ovf_high = _mm_clmulepi64_si128(xmm_overflow, k12, 0x10);
+        crc_state = _mm_xor_si128(crc_state, _mm_xor_si128(ovf_low, ovf_high));
+    }
+
+    /* Reduce 128-bits to 32-bits using two-stage Barrett reduction */
+    __m128i x_tmp0 = _mm_clmulepi64_si128(crc_state, barrett_k, 0x00);
+    __m128i x_tmp1 = _mm_clmulepi64_si128(x_tmp0, barrett_k, 0x10);
+
+    x_tmp1 = _mm_blend_epi16(x_tmp1, _mm_setzero_si128(), 0xcf);
+    x_tmp0 = _mm_xor_si128(x_tmp1, crc_state);
+
+    __m128i x_res_a = _mm_clmulepi64_si128(x_tmp0, barrett_k, 0x01);
+    __m128i x_res_b = _mm_clmulepi64_si128(x_res_a, barrett_k, 0x10);
+
+    return ~(uint32_t)_mm_extract_epi32(x_res_b, 2);
+}
+
+Z_INTERNAL void crc32_multi_pclmulqdq(uint32_t *crc, const uint8_t * const *buf, const size_t *len, size_t count) {
+    __m128i crc_state[MULTI_LANES];
+    const uint8_t *p[MULTI_LANES];
+    size_t left[MULTI_LANES], idx[MULTI_LANES];
+    size_t next = 0;
+    int lanes, j;
+
+    for (j = 0; j < MULTI_LANES; j++)
+        idx[j] = count;
+
+    for (lanes = 0; lanes < MULTI_LANES; lanes++) {
+        idx[lanes] = multi_next(crc, buf, len, count, &next, CRC_MULTI_BLOCK, crc32_pclmulqdq);
+        if (idx[lanes] == count)
+            break;
+        crc_state[lanes] = crc32_multi_start(crc[idx[lanes]], buf[idx[lanes]]);
+        p[lanes] = buf[idx[lanes]] + CRC_MULTI_BLOCK;
+        left[lanes] = len[idx[lanes]] - CRC_MULTI_BLOCK;
+    }
+
+    while (lanes == MULTI_LANES) {
+        size_t n = MIN(MIN(left[0], left[1]), MIN(left[2], left[3]));
+        n = ALIGN_DOWN(n, CRC_MULTI_BLOCK);
+
+        __m128i x0 = crc_state[0], x1 = crc_state[1], x2 = crc_state[2], x3 = crc_state[3];
+        for (size_t i = 0; i < n; i += CRC_MULTI_BLOCK) {
+            x0 = crc32_multi_fold(x0, p[0] + i);
+            x1 = crc32_multi_fold(x1, p[1] + i);
+            x2 = crc32_multi_fold(x2, p[2] + i);
+            x3 = crc32_multi_fold(x3, p[3] + i);
+        }
+        crc_state[0] = x0, crc_state[1] = x1, crc_state[2] = x2, crc_state[3] = x3;
+
+        for (j = 0; j < MULTI_LANES; j++) {
+            p[j] += n;
+            left[j] -= n;
+            if (left[j] >= CRC_MULTI_BLOCK)
+                continue;
+            crc[idx[j]] = crc32_multi_finish(crc_state[j], p[j], left[j]);
+            idx[j] = multi_next(crc, buf, len, count, &next, CRC_MULTI_BLOCK, crc32_pclmulqdq);
+            if (idx[j] == count) {
+                lanes--;
+                continue;
+            }
+            crc_state[j] = crc32_multi_start(crc[idx[j]], buf[idx[j]]);
+            p[j] = buf[idx[j]] + CRC_MULTI_BLOCK;
+            left[j] = len[idx[j]] - CRC_MULTI_BLOCK;
+        }
+    }
+
+    /* Not enough buffers left to fill the lanes */
+    for (j = 0; j < MULTI_LANES; j++) {
+        if (idx[j] < count)
+            crc[idx[j]] = crc32_multi_finish(crc_state[j], p[j], left[j]);
+    }
+}
+
+#endif
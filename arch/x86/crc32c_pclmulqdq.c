@@ -0,0 +1,34 @@
+/* crc32c_pclmulqdq.c -- CRC-32C folding with PCLMULQDQ
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_PCLMULQDQ_CRC
+
+#include "zbuild.h"
+#include "crc32c_p.h"
+
+#define CRC_T uint32_t
+#define CRC_SLICE8 crc32c_slice8
+#define CRC_FOLD_16_LO 0x3743f7bd00000000ULL
+#define CRC_FOLD_16_HI 0x3171d43000000000ULL
+#define CRC_FOLD_64_LO 0x1c19243b00000000ULL
+#define CRC_FOLD_64_HI 0x75bba45b00000000ULL
+#define CRC_FOLD_IMPL crc32c_fold_pclmulqdq
+#include "crc_fold_pclmulqdq_tpl.h"
+#undef CRC_T
+#undef CRC_SLICE8
+#undef CRC_FOLD_16_LO
+#undef CRC_FOLD_16_HI
+#undef CRC_FOLD_64_LO
+#undef CRC_FOLD_64_HI
+#undef CRC_FOLD_IMPL
+
+Z_INTERNAL uint32_t crc32c_pclmulqdq(uint32_t crc, const uint8_t *buf, size_t len) {
+    return crc32c_fold_pclmulqdq(crc, NULL, buf, len, 0);
+}
+
+Z_INTERNAL uint32_t crc32c_copy_pclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len) {
+    return crc32c_fold_pclmulqdq(crc, dst, src, len, 1);
+}
+
+#endif
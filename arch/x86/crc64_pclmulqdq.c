@@ -0,0 +1,34 @@
+/* crc64_pclmulqdq.c -- CRC-64/XZ folding with PCLMULQDQ
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_PCLMULQDQ_CRC
+
+#include "zbuild.h"
+#include "crc64_p.h"
+
+#define CRC_T uint64_t
+#define CRC_SLICE8 crc64_slice8
+#define CRC_FOLD_16_LO 0xe05dd497ca393ae4ULL
+#define CRC_FOLD_16_HI 0xdabe95afc7875f40ULL
+#define CRC_FOLD_64_LO 0x6ae3efbb9dd441f3ULL
+#define CRC_FOLD_64_HI 0x081f6054a7842df4ULL
+#define CRC_FOLD_IMPL crc64_fold_pclmulqdq
+#include "crc_fold_pclmulqdq_tpl.h"
+#undef CRC_T
+#undef CRC_SLICE8
+#undef CRC_FOLD_16_LO
+#undef CRC_FOLD_16_HI
+#undef CRC_FOLD_64_LO
+#undef CRC_FOLD_64_HI
+#undef CRC_FOLD_IMPL
+
+Z_INTERNAL uint64_t crc64_pclmulqdq(uint64_t crc, const uint8_t *buf, size_t len) {
+    return crc64_fold_pclmulqdq(crc, NULL, buf, len, 0);
+}
+
+Z_INTERNAL uint64_t crc64_copy_pclmulqdq(uint64_t crc, uint8_t *dst, const uint8_t *src, size_t len) {
+    return crc64_fold_pclmulqdq(crc, dst, src, len, 1);
+}
+
+#endif
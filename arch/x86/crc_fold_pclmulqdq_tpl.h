@@ -0,0 +1,100 @@
+/* crc_fold_pclmulqdq_tpl.h -- Folding engine for reflected CRCs of up to 64 bits with PCLMULQDQ
+ *
+ * The same folding as crc32_pclmulqdq_tpl.h, with the polynomial reduced to four fold constants. A 128-bit state
+ * L * x^64 + H is carried D bytes forward as clmul(L, x^(8D+63) mod p) ^ clmul(H, x^(8D-1) mod p), both constants
+ * reflected into 64 bits, the extra x^-1 making up for the product of two reflected values landing one bit short.
+ * The folded state is then reduced by running it through the table CRC from a zero register.
+ *
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+
+#include <immintrin.h>
+#include <wmmintrin.h>
+
+#ifndef CRC_FOLD_PCLMULQDQ_TPL_H_
+#define CRC_FOLD_PCLMULQDQ_TPL_H_
+
+Z_FORCEINLINE static __m128i crc_fold_step(__m128i state, __m128i k, __m128i next) {
+    __m128i x_low  = _mm_clmulepi64_si128(state, k, 0x00);
+    __m128i x_high = _mm_clmulepi64_si128(state, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(x_low, x_high), next);
+}
+
+Z_FORCEINLINE static __m128i crc_fold_load(uint8_t **dst, const uint8_t *src, const int COPY) {
+    __m128i x = _mm_loadu_si128((const __m128i *)src);
+    if (COPY) {
+        _mm_storeu_si128((__m128i *)*dst, x);
+        *dst += 16;
+    }
+    return x;
+}
+
+#endif
+
+/* Define CRC_T as the register type, CRC_SLICE8 as the table update for the polynomial, CRC_FOLD_16_LO/HI and
+ * CRC_FOLD_64_LO/HI as the constants for carrying the state 16 and 64 bytes forward, and CRC_FOLD_IMPL as the name
+ * of the function.
+ */
+Z_FORCEINLINE static CRC_T CRC_FOLD_IMPL(CRC_T crc, uint8_t *dst, const uint8_t *src, size_t len, const int COPY) {
+    const __m128i fold16 = _mm_set_epi64x((int64_t)CRC_FOLD_16_HI, (int64_t)CRC_FOLD_16_LO);
+    const __m128i fold64 = _mm_set_epi64x((int64_t)CRC_FOLD_64_HI, (int64_t)CRC_FOLD_64_LO);
+    ALIGNED_(16) uint8_t state[16];
+    __m128i x0, x1, x2, x3;
+    CRC_T c = ~crc;
+
+    if (len < 16)
+        return ~CRC_SLICE8(c, dst, src, len, COPY);
+
+    /* The register goes in over the first bytes, as the table CRC would combine them */
+    x0 = _mm_xor_si128(crc_fold_load(&dst, src, COPY), _mm_set_epi64x(0, (int64_t)c));
+    src += 16;
+    len -= 16;
+
+    if (len >= 48) {
+        x1 = crc_fold_load(&dst, src, COPY);
+        x2 = crc_fold_load(&dst, src + 16, COPY);
+        x3 = crc_fold_load(&dst, src + 32, COPY);
+        src += 48;
+        len -= 48;
+
+        while (len >= 64) {
+            x0 = crc_fold_step(x0, fold64, crc_fold_load(&dst, src, COPY));
+            x1 = crc_fold_step(x1, fold64, crc_fold_load(&dst, src + 16, COPY));
+            x2 = crc_fold_step(x2, fold64, crc_fold_load(&dst, src + 32, COPY));
+            x3 = crc_fold_step(x3, fold64, crc_fold_load(&dst, src + 48, COPY));
+            src += 64;
+            len -= 64;
+        }
+
+        x1 = crc_fold_step(x0, fold16, x1);
+        x2 = crc_fold_step(x1, fold16, x2);
+        x0 = crc_fold_step(x2, fold16, x3);
+    }
+
+    while (len >= 16) {
+        x0 = crc_fold_step(x0, fold16, crc_fold_load(&dst, src, COPY));
+        src += 16;
+        len -= 16;
+    }
+
+    if (len) {
+        const __m128i xmm_seq = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        __m128i xmm_shl = _mm_add_epi8(xmm_seq, _mm_set1_epi8((char)len - 16));
+        __m128i xmm_shr = _mm_xor_si128(xmm_shl, _mm_set1_epi8((char)0x80));
+        __m128i xmm_part = _mm_setzero_si128();
+
+        memcpy(&xmm_part, src, len);
+        if (COPY)
+            memcpy(dst, src, len);
+
+        /* Move the state down to make room for the tail at the top, the bytes pushed out are carried over it */
+        x1 = _mm_shuffle_epi8(x0, xmm_shl);
+        x0 = _mm_or_si128(_mm_shuffle_epi8(x0, xmm_shr), _mm_shuffle_epi8(xmm_part, xmm_shl));
+        x0 = crc_fold_step(x1, fold16, x0);
+    }
+
+    _mm_store_si128((__m128i *)state, x0);
+    return ~CRC_SLICE8(0, NULL, state, 16, 0);
+}
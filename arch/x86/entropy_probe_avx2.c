@@ -0,0 +1,62 @@
+/* entropy_probe_avx2.c -- AVX2 version of entropy_probe
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_AVX2
+
+#include "zbuild.h"
+#include "arch/generic/entropy_probe_p.h"
+
+#include <immintrin.h>
+
+/* Samples gathered before counting, keeps the 8-bit lane counters from overflowing */
+#define PROBE_BATCH_AVX2 32
+
+static inline uint32_t hsum_epu8_avx2(__m256i v) {
+    __m256i sad = _mm256_sad_epu8(v, _mm256_setzero_si256());
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sad), _mm256_extracti128_si256(sad, 1));
+    return (uint32_t)(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum)));
+}
+
+static inline void probe_count_avx2(uint32_t *hist, const __m256i *nib, size_t count) {
+    for (int b = 0; b < 16; b++) {
+        const __m256i bin = _mm256_set1_epi8((char)b);
+        __m256i acc = _mm256_setzero_si256();
+        /* cmpeq yields -1 for each matching lane */
+        for (size_t i = 0; i < count; i++)
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(nib[i], bin));
+        hist[b] += hsum_epu8_avx2(acc);
+    }
+}
+
+Z_INTERNAL uint32_t entropy_probe_avx2(const uint8_t *buf, size_t len) {
+    __m256i nib[3][PROBE_BATCH_AVX2];
+    uint32_t hist[3][16] = {{0}};
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+    uint32_t total = 0;
+    size_t off = 0;
+
+    Assert(PROBE_SAMPLE_LEN == 32, "entropy_probe_avx2 loads one sample per vector");
+
+    while (off + PROBE_SAMPLE_LEN <= len) {
+        size_t count = 0;
+
+        for (; count < PROBE_BATCH_AVX2 && off + PROBE_SAMPLE_LEN <= len; count++, off += PROBE_SAMPLE_STRIDE) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(buf + off));
+            __m256i lo = _mm256_and_si256(v, nibble_mask);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble_mask);
+            nib[PROBE_LO][count] = lo;
+            nib[PROBE_HI][count] = hi;
+            nib[PROBE_XOR][count] = _mm256_xor_si256(lo, hi);
+        }
+
+        probe_count_avx2(hist[PROBE_LO], nib[PROBE_LO], count);
+        probe_count_avx2(hist[PROBE_HI], nib[PROBE_HI], count);
+        probe_count_avx2(hist[PROBE_XOR], nib[PROBE_XOR], count);
+        total += (uint32_t)(count * 32);
+    }
+
+    return entropy_probe_finish(hist, total);
+}
+
+#endif
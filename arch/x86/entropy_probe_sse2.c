@@ -0,0 +1,61 @@
+/* entropy_probe_sse2.c -- SSE2 version of entropy_probe
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_SSE2
+
+#include "zbuild.h"
+#include "arch/generic/entropy_probe_p.h"
+
+#include <emmintrin.h>
+
+/* Samples gathered before counting, keeps the 8-bit lane counters from overflowing */
+#define PROBE_BATCH_SSE2 32
+
+static inline uint32_t hsum_epu8_sse2(__m128i v) {
+    __m128i sad = _mm_sad_epu8(v, _mm_setzero_si128());
+    return (uint32_t)(_mm_cvtsi128_si32(sad) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sad, sad)));
+}
+
+static inline void probe_count_sse2(uint32_t *hist, const __m128i *nib, size_t count) {
+    for (int b = 0; b < 16; b++) {
+        const __m128i bin = _mm_set1_epi8((char)b);
+        __m128i acc = _mm_setzero_si128();
+        /* cmpeq yields -1 for each matching lane */
+        for (size_t i = 0; i < count; i++)
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(nib[i], bin));
+        hist[b] += hsum_epu8_sse2(acc);
+    }
+}
+
+Z_INTERNAL uint32_t entropy_probe_sse2(const uint8_t *buf, size_t len) {
+    __m128i nib[3][PROBE_BATCH_SSE2 * 2];
+    uint32_t hist[3][16] = {{0}};
+    const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+    uint32_t total = 0;
+    size_t off = 0;
+
+    while (off + PROBE_SAMPLE_LEN <= len) {
+        size_t count = 0;
+
+        for (int n = 0; n < PROBE_BATCH_SSE2 && off + PROBE_SAMPLE_LEN <= len; n++, off += PROBE_SAMPLE_STRIDE) {
+            for (int j = 0; j < PROBE_SAMPLE_LEN; j += 16, count++) {
+                __m128i v = _mm_loadu_si128((const __m128i *)(buf + off + j));
+                __m128i lo = _mm_and_si128(v, nibble_mask);
+                __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble_mask);
+                nib[PROBE_LO][count] = lo;
+                nib[PROBE_HI][count] = hi;
+                nib[PROBE_XOR][count] = _mm_xor_si128(lo, hi);
+            }
+        }
+
+        probe_count_sse2(hist[PROBE_LO], nib[PROBE_LO], count);
+        probe_count_sse2(hist[PROBE_HI], nib[PROBE_HI], count);
+        probe_count_sse2(hist[PROBE_XOR], nib[PROBE_XOR], count);
+        total += (uint32_t)(count * 16);
+    }
+
+    return entropy_probe_finish(hist, total);
+}
+
+#endif
@@ -0,0 +1,191 @@
+/* inftrees_avx2.c -- AVX2 version of inflate_table
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifdef X86_AVX2
+
+#include "zbuild.h"
+#include "zmemory.h"
+#include "inftrees_p.h"
+#include "fallback_builtins.h"
+
+#include <immintrin.h>
+
+/* Byte k is the position of the k-th set bit of the index, the symbols of one length among eight */
+static const uint64_t inflate_table_pick_avx2[256] = {
+    0x0000000000000000, 0x0000000000000000, 0x0000000000000001, 0x0000000000000100,
+    0x0000000000000002, 0x0000000000000200, 0x0000000000000201, 0x0000000000020100,
+    0x0000000000000003, 0x0000000000000300, 0x0000000000000301, 0x0000000000030100,
+    0x0000000000000302, 0x0000000000030200, 0x0000000000030201, 0x0000000003020100,
+    0x0000000000000004, 0x0000000000000400, 0x0000000000000401, 0x0000000000040100,
+    0x0000000000000402, 0x0000000000040200, 0x0000000000040201, 0x0000000004020100,
+    0x0000000000000403, 0x0000000000040300, 0x0000000000040301, 0x0000000004030100,
+    0x0000000000040302, 0x0000000004030200, 0x0000000004030201, 0x0000000403020100,
+    0x0000000000000005, 0x0000000000000500, 0x0000000000000501, 0x0000000000050100,
+    0x0000000000000502, 0x0000000000050200, 0x0000000000050201, 0x0000000005020100,
+    0x0000000000000503, 0x0000000000050300, 0x0000000000050301, 0x0000000005030100,
+    0x0000000000050302, 0x0000000005030200, 0x0000000005030201, 0x0000000503020100,
+    0x0000000000000504, 0x0000000000050400, 0x0000000000050401, 0x0000000005040100,
+    0x0000000000050402, 0x0000000005040200, 0x0000000005040201, 0x0000000504020100,
+    0x0000000000050403, 0x0000000005040300, 0x0000000005040301, 0x0000000504030100,
+    0x0000000005040302, 0x0000000504030200, 0x0000000504030201, 0x0000050403020100,
+    0x0000000000000006, 0x0000000000000600, 0x0000000000000601, 0x0000000000060100,
+    0x0000000000000602, 0x0000000000060200, 0x0000000000060201, 0x0000000006020100,
+    0x0000000000000603, 0x0000000000060300, 0x0000000000060301, 0x0000000006030100,
+    0x0000000000060302, 0x0000000006030200, 0x0000000006030201, 0x0000000603020100,
+    0x0000000000000604, 0x0000000000060400, 0x0000000000060401, 0x0000000006040100,
+    0x0000000000060402, 0x0000000006040200, 0x0000000006040201, 0x0000000604020100,
+    0x0000000000060403, 0x0000000006040300, 0x0000000006040301, 0x0000000604030100,
+    0x0000000006040302, 0x0000000604030200, 0x0000000604030201, 0x0000060403020100,
+    0x0000000000000605, 0x0000000000060500, 0x0000000000060501, 0x0000000006050100,
+    0x0000000000060502, 0x0000000006050200, 0x0000000006050201, 0x0000000605020100,
+    0x0000000000060503, 0x0000000006050300, 0x0000000006050301, 0x0000000605030100,
+    0x0000000006050302, 0x0000000605030200, 0x0000000605030201, 0x0000060503020100,
+    0x0000000000060504, 0x0000000006050400, 0x0000000006050401, 0x0000000605040100,
+    0x0000000006050402, 0x0000000605040200, 0x0000000605040201, 0x0000060504020100,
+    0x0000000006050403, 0x0000000605040300, 0x0000000605040301, 0x0000060504030100,
+    0x0000000605040302, 0x0000060504030200, 0x0000060504030201, 0x0006050403020100,
+    0x0000000000000007, 0x0000000000000700, 0x0000000000000701, 0x0000000000070100,
+    0x0000000000000702, 0x0000000000070200, 0x0000000000070201, 0x0000000007020100,
+    0x0000000000000703, 0x0000000000070300, 0x0000000000070301, 0x0000000007030100,
+    0x0000000000070302, 0x0000000007030200, 0x0000000007030201, 0x0000000703020100,
+    0x0000000000000704, 0x0000000000070400, 0x0000000000070401, 0x0000000007040100,
+    0x0000000000070402, 0x0000000007040200, 0x0000000007040201, 0x0000000704020100,
+    0x0000000000070403, 0x0000000007040300, 0x0000000007040301, 0x0000000704030100,
+    0x0000000007040302, 0x0000000704030200, 0x0000000704030201, 0x0000070403020100,
+    0x0000000000000705, 0x0000000000070500, 0x0000000000070501, 0x0000000007050100,
+    0x0000000000070502, 0x0000000007050200, 0x0000000007050201, 0x0000000705020100,
+    0x0000000000070503, 0x0000000007050300, 0x0000000007050301, 0x0000000705030100,
+    0x0000000007050302, 0x0000000705030200, 0x0000000705030201, 0x0000070503020100,
+    0x0000000000070504, 0x0000000007050400, 0x0000000007050401, 0x0000000705040100,
+    0x0000000007050402, 0x0000000705040200, 0x0000000705040201, 0x0000070504020100,
+    0x0000000007050403, 0x0000000705040300, 0x0000000705040301, 0x0000070504030100,
+    0x0000000705040302, 0x0000070504030200, 0x0000070504030201, 0x0007050403020100,
+    0x0000000000000706, 0x0000000000070600, 0x0000000000070601, 0x0000000007060100,
+    0x0000000000070602, 0x0000000007060200, 0x0000000007060201, 0x0000000706020100,
+    0x0000000000070603, 0x0000000007060300, 0x0000000007060301, 0x0000000706030100,
+    0x0000000007060302, 0x0000000706030200, 0x0000000706030201, 0x0000070603020100,
+    0x0000000000070604, 0x0000000007060400, 0x0000000007060401, 0x0000000706040100,
+    0x0000000007060402, 0x0000000706040200, 0x0000000706040201, 0x0000070604020100,
+    0x0000000007060403, 0x0000000706040300, 0x0000000706040301, 0x0000070604030100,
+    0x0000000706040302, 0x0000070604030200, 0x0000070604030201, 0x0007060403020100,
+    0x0000000000070605, 0x0000000007060500, 0x0000000007060501, 0x0000000706050100,
+    0x0000000007060502, 0x0000000706050200, 0x0000000706050201, 0x0000070605020100,
+    0x0000000007060503, 0x0000000706050300, 0x0000000706050301, 0x0000070605030100,
+    0x0000000706050302, 0x0000070605030200, 0x0000070605030201, 0x0007060503020100,
+    0x0000000007060504, 0x0000000706050400, 0x0000000706050401, 0x0000070605040100,
+    0x0000000706050402, 0x0000070605040200, 0x0000070605040201, 0x0007060504020100,
+    0x0000000706050403, 0x0000070605040300, 0x0000070605040301, 0x0007060504030100,
+    0x0000070605040302, 0x0007060504030200, 0x0007060504030201, 0x0706050403020100
+};
+
+/* Writes the symbols sym..sym+7 picked by mask to work[pos..], returns the position after them. All eight slots are
+ * stored, the ones past the picked symbols are taken by later symbols of the same length or by the next length,
+ * which is sorted after this one. Only near the end of the sorted symbols do they go in one by one.
+ */
+static inline unsigned inflate_table_pick_store_avx2(uint16_t *work, unsigned pos, unsigned end, unsigned mask,
+                                                     unsigned sym) {
+    uint64_t pick = inflate_table_pick_avx2[mask];
+    unsigned n = (unsigned)__builtin_popcount(mask);
+
+    if (LIKELY(pos + 8 <= end)) {
+        __m128i idx = _mm_cvtepu8_epi16(_mm_cvtsi64_si128((int64_t)pick));
+        _mm_storeu_si128((__m128i *)(work + pos), _mm_add_epi16(idx, _mm_set1_epi16((short)sym)));
+    } else {
+        for (unsigned k = 0; k < n; k++)
+            work[pos + k] = (uint16_t)(sym + ((pick >> (8 * k)) & 0xff));
+    }
+    return pos + n;
+}
+
+/* Sorts the symbols by length, one length at a time picking its symbols out of sixteen lengths with a compare */
+static void inflate_table_sort_avx2(const uint16_t *lens, unsigned codes, const uint16_t *count, const uint16_t *offs,
+                                    uint16_t *work) {
+    ALIGNED_(32) uint16_t tail[16] = {0};
+    unsigned whole = codes & ~15U;
+    unsigned end = offs[MAX_BITS] + count[MAX_BITS];
+
+    /* Zero lengths are never picked, so the symbols past codes in the last vector are never sorted */
+    memcpy(tail, lens + whole, (codes - whole) * sizeof(uint16_t));
+
+    for (unsigned len = 1; len <= MAX_BITS; len++) {
+        const __m256i want = _mm256_set1_epi16((short)len);
+        unsigned pos = offs[len];
+
+        if (count[len] == 0)
+            continue;
+        for (unsigned sym = 0; sym < codes; sym += 16) {
+            const uint16_t *src = sym < whole ? lens + sym : tail;
+            __m256i eq = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)src), want);
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_packs_epi16(eq, eq));
+
+            pos = inflate_table_pick_store_avx2(work, pos, end, mask & 0xff, sym);
+            pos = inflate_table_pick_store_avx2(work, pos, end, (mask >> 16) & 0xff, sym + 8);
+        }
+    }
+}
+
+/* Extends the first from entries of table to the first to, repeating them. from and to are powers of two. */
+static inline void inflate_table_replicate_avx2(code *table, unsigned from, unsigned to) {
+    unsigned i;
+
+    if (from >= to)
+        return;
+    if (to < 8) {
+        for (i = from; i < to; i++)
+            table[i] = table[i - from];
+        return;
+    }
+    if (from < 8) {
+        __m256i pattern;
+        if (from == 1)
+            pattern = _mm256_set1_epi32((int)zng_memread_4(table));
+        else if (from == 2)
+            pattern = _mm256_set1_epi64x((int64_t)zng_memread_8(table));
+        else
+            pattern = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+        _mm256_storeu_si256((__m256i *)table, pattern);
+        from = 8;
+    }
+    for (i = from; i < to; i += 8)
+        _mm256_storeu_si256((__m256i *)(table + i), _mm256_loadu_si256((const __m256i *)(table + i - from)));
+}
+
+/* Enters the codes of at most root bits in the root table without replicating each one across it: the codes of one
+ * length go in the first 1 << len entries, which are then repeated up to the next length. Entries not yet taken get
+ * repeated too but are all taken by longer codes or sub-table links later, as in a complete code every index is.
+ */
+static unsigned inflate_table_fill_root_avx2(code *table, const uint16_t *work, uint16_t *count, unsigned min,
+                                             unsigned root, const uint16_t *base, const uint16_t *extra,
+                                             unsigned match, uint16_t *rhuff) {
+    unsigned sym = 0, filled = min;
+    uint16_t rcode = 0;
+
+    for (unsigned len = min; len <= root; len++) {
+        if (count[len] == 0)
+            continue;
+        inflate_table_replicate_avx2(table, 1U << filled, 1U << len);
+        filled = len;
+        for (unsigned n = count[len]; n != 0; n--, sym++) {
+            table[__builtin_bitreverse16(rcode)] = inflate_table_entry(work[sym], len, base, extra, match);
+            rcode += (0x8000u >> (len - 1));
+        }
+        count[len] = 0;
+    }
+    inflate_table_replicate_avx2(table, 1U << filled, 1U << root);
+
+    *rhuff = rcode;
+    return sym;
+}
+
+#define INFLATE_TABLE           inflate_table_avx2
+#define INFLATE_TABLE_SORT      inflate_table_sort_avx2
+#define INFLATE_TABLE_FILL_ROOT inflate_table_fill_root_avx2
+
+#include "inftrees_tpl.h"
+
+#undef INFLATE_TABLE
+#undef INFLATE_TABLE_SORT
+#undef INFLATE_TABLE_FILL_ROOT
+
+#endif
@@ -16,6 +16,7 @@
 
 #ifdef X86_SSE2
 uint8_t* chunkmemset_safe_sse2(uint8_t *out, uint8_t *from, unsigned len, unsigned left);
+uint32_t entropy_probe_sse2(const uint8_t *buf, size_t len);
 
 #  ifdef HAVE_BUILTIN_CTZ
     uint32_t compare256_sse2(const uint8_t *src0, const uint8_t *src1);
@@ -38,9 +39,12 @@ uint8_t* chunkmemset_safe_ssse3(uint8_t *out, uint8_t *from, unsigned len, unsig
 void inflate_fast_ssse3(PREFIX3(stream) *strm, uint32_t start);
 #endif
 
-#if defined(X86_SSE41) && !defined(WITHOUT_CHORBA_SSE)
+#ifdef X86_SSE41
+void adler32_multi_sse41(uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count);
+#  if !defined(WITHOUT_CHORBA_SSE)
     uint32_t crc32_chorba_sse41(uint32_t crc, const uint8_t *buf, size_t len);
     uint32_t crc32_copy_chorba_sse41(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+#  endif
 #endif
 
 #ifdef X86_SSE42
@@ -50,15 +54,21 @@ uint32_t adler32_copy_sse42(uint32_t adler, uint8_t *dst, const uint8_t *src, si
 #ifdef X86_AVX2
 uint32_t adler32_avx2(uint32_t adler, const uint8_t *buf, size_t len);
 uint32_t adler32_copy_avx2(uint32_t adler, uint8_t *dst, const uint8_t *src, size_t len);
+void adler32_multi_avx2(uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count);
 uint8_t* chunkmemset_safe_avx2(uint8_t *out, uint8_t *from, unsigned len, unsigned left);
+uint32_t entropy_probe_avx2(const uint8_t *buf, size_t len);
 
 #  ifdef HAVE_BUILTIN_CTZ
     uint32_t compare256_avx2(const uint8_t *src0, const uint8_t *src1);
     uint32_t longest_match_avx2(deflate_state *const s, uint32_t cur_match);
     uint32_t longest_match_slow_avx2(deflate_state *const s, uint32_t cur_match);
+    block_state deflate_medium_avx2(deflate_state *s, int flush);
+    block_state deflate_quick_avx2(deflate_state *s, int flush);
 #  endif
     void slide_hash_avx2(deflate_state *s);
     void inflate_fast_avx2(PREFIX3(stream)* strm, uint32_t start);
+    int inflate_table_avx2(codetype type, uint16_t *lens, unsigned codes, code **table, unsigned *bits,
+                           uint16_t *work);
 #endif
 #ifdef X86_AVX512
 uint32_t adler32_avx512(uint32_t adler, const uint8_t *buf, size_t len);
@@ -69,6 +79,8 @@ void inflate_fast_avx512(PREFIX3(stream)* strm, uint32_t start);
     uint32_t compare256_avx512(const uint8_t *src0, const uint8_t *src1);
     uint32_t longest_match_avx512(deflate_state *const s, uint32_t cur_match);
     uint32_t longest_match_slow_avx512(deflate_state *const s, uint32_t cur_match);
+    block_state deflate_medium_avx512(deflate_state *s, int flush);
+    block_state deflate_quick_avx512(deflate_state *s, int flush);
 #  endif
 #endif
 #ifdef X86_AVX512VNNI
@@ -79,6 +91,13 @@ uint32_t adler32_copy_avx512_vnni(uint32_t adler, uint8_t *dst, const uint8_t *s
 #ifdef X86_PCLMULQDQ_CRC
 uint32_t crc32_pclmulqdq(uint32_t crc, const uint8_t *buf, size_t len);
 uint32_t crc32_copy_pclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+void crc32_multi_pclmulqdq(uint32_t *crc, const uint8_t * const *buf, const size_t *len, size_t count);
+void crc32_combine_gen_pclmulqdq(uint32_t *op, const z_off64_t *len2, size_t count);
+uint32_t crc32_combine_op_pclmulqdq(uint32_t crc1, uint32_t crc2, const uint32_t op);
+uint32_t crc32c_pclmulqdq(uint32_t crc, const uint8_t *buf, size_t len);
+uint32_t crc32c_copy_pclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+uint64_t crc64_pclmulqdq(uint64_t crc, const uint8_t *buf, size_t len);
+uint64_t crc64_copy_pclmulqdq(uint64_t crc, uint8_t *dst, const uint8_t *src, size_t len);
 #endif
 #ifdef X86_VPCLMULQDQ_CRC
 uint32_t crc32_vpclmulqdq(uint32_t crc, const uint8_t *buf, size_t len);
@@ -90,6 +109,8 @@ uint32_t crc32_copy_vpclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, s
 #  if (defined(X86_SSE2) && defined(__SSE2__)) || (defined(ARCH_X86) && defined(ARCH_64BIT))
 #    undef native_chunkmemset_safe
 #    define native_chunkmemset_safe chunkmemset_safe_sse2
+#    undef native_entropy_probe
+#    define native_entropy_probe entropy_probe_sse2
 #    undef native_inflate_fast
 #    define native_inflate_fast inflate_fast_sse2
 #    undef native_slide_hash
@@ -119,6 +140,10 @@ uint32_t crc32_copy_vpclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, s
 #    define native_inflate_fast inflate_fast_ssse3
 #  endif
 // X86 - SSE4.1
+#  if defined(X86_SSE41) && defined(__SSE4_1__)
+#    undef native_adler32_multi
+#    define native_adler32_multi adler32_multi_sse41
+#  endif
 #  if defined(X86_SSE41) && defined(__SSE4_1__) && !defined(WITHOUT_CHORBA_SSE)
 #   undef native_crc32
 #   define native_crc32 crc32_chorba_sse41
@@ -136,6 +161,20 @@ uint32_t crc32_copy_vpclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, s
 #    define native_crc32 crc32_pclmulqdq
 #    undef native_crc32_copy
 #    define native_crc32_copy crc32_copy_pclmulqdq
+#    undef native_crc32_multi
+#    define native_crc32_multi crc32_multi_pclmulqdq
+#    undef native_crc32_combine_gen
+#    define native_crc32_combine_gen crc32_combine_gen_pclmulqdq
+#    undef native_crc32_combine_op
+#    define native_crc32_combine_op crc32_combine_op_pclmulqdq
+#    undef native_crc32c
+#    define native_crc32c crc32c_pclmulqdq
+#    undef native_crc32c_copy
+#    define native_crc32c_copy crc32c_copy_pclmulqdq
+#    undef native_crc64
+#    define native_crc64 crc64_pclmulqdq
+#    undef native_crc64_copy
+#    define native_crc64_copy crc64_copy_pclmulqdq
 #  endif
 // X86 - AVX2
 #  if defined(X86_AVX2) && defined(__AVX2__)
@@ -143,10 +182,16 @@ uint32_t crc32_copy_vpclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, s
 #    define native_adler32 adler32_avx2
 #    undef native_adler32_copy
 #    define native_adler32_copy adler32_copy_avx2
+#    undef native_adler32_multi
+#    define native_adler32_multi adler32_multi_avx2
 #    undef native_chunkmemset_safe
 #    define native_chunkmemset_safe chunkmemset_safe_avx2
+#    undef native_entropy_probe
+#    define native_entropy_probe entropy_probe_avx2
 #    undef native_inflate_fast
 #    define native_inflate_fast inflate_fast_avx2
+#    undef native_inflate_table
+#    define native_inflate_table inflate_table_avx2
 #    undef native_slide_hash
 #    define native_slide_hash slide_hash_avx2
 #    ifdef HAVE_BUILTIN_CTZ
@@ -156,6 +201,10 @@ uint32_t crc32_copy_vpclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, s
 #      define native_longest_match longest_match_avx2
 #      undef native_longest_match_slow
 #      define native_longest_match_slow longest_match_slow_avx2
+#      undef native_deflate_medium
+#      define native_deflate_medium deflate_medium_avx2
+#      undef native_deflate_quick
+#      define native_deflate_quick deflate_quick_avx2
 #    endif
 #  endif
 // X86 - AVX512 (F,DQ,BW,Vl)
@@ -175,6 +224,10 @@ uint32_t crc32_copy_vpclmulqdq(uint32_t crc, uint8_t *dst, const uint8_t *src, s
 #      define native_longest_match longest_match_avx512
 #      undef native_longest_match_slow
 #      define native_longest_match_slow longest_match_slow_avx512
+#      undef native_deflate_medium
+#      define native_deflate_medium deflate_medium_avx512
+#      undef native_deflate_quick
+#      define native_deflate_quick deflate_quick_avx512
 #    endif
 // X86 - AVX512 (VNNI)
 #    if defined(X86_AVX512VNNI) && defined(__AVX512VNNI__)
@@ -0,0 +1,76 @@
+/* checksum_parallel_p.h -- Slicing shared by adler32_parallel() and crc32_parallel()
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef CHECKSUM_PARALLEL_P_H_
+#define CHECKSUM_PARALLEL_P_H_
+
+#include "zbuild.h"
+#include "zthread.h"
+
+/* Smallest slice worth a thread of its own, the checksum of less takes about as long as starting the thread */
+#define CHECKSUM_PARALLEL_MIN_SLICE (1024 * 1024)
+
+/* Slices per thread, so that one thread being held up does not hold up the whole call */
+#define CHECKSUM_PARALLEL_SPLIT 4
+
+#define CHECKSUM_PARALLEL_MAX_SLICES (ZTHREAD_MAX * CHECKSUM_PARALLEL_SPLIT)
+
+typedef uint32_t (*checksum_parallel_func)(uint32_t sum, const uint8_t *buf, size_t len);
+
+typedef struct checksum_parallel_s {
+    checksum_parallel_func func;
+    const uint8_t *buf;
+    size_t slice_len;       /* length of every slice but the last */
+    size_t last_len;        /* length of the last slice */
+    size_t slices;
+    size_t next;
+    uint32_t sum[CHECKSUM_PARALLEL_MAX_SLICES]; /* initial value of each slice, then its checksum */
+} checksum_parallel;
+
+static void checksum_parallel_worker(void *arg, unsigned id) {
+    checksum_parallel *par = (checksum_parallel *)arg;
+    size_t i;
+
+    Z_UNUSED(id);
+    while ((i = zthread_next(&par->next)) < par->slices) {
+        size_t len = i == par->slices - 1 ? par->last_len : par->slice_len;
+        par->sum[i] = par->func(par->sum[i], par->buf + i * par->slice_len, len);
+    }
+}
+
+/* Cuts buf into slices and checksums them on up to threads threads, the first slice starting from init and the
+ * others from empty. Returns 0 without doing anything if len is too short for more than one thread to pay off.
+ */
+static int checksum_parallel_run(checksum_parallel *par, checksum_parallel_func func, uint32_t init, uint32_t empty,
+                                 const uint8_t *buf, size_t len, int32_t threads) {
+    size_t max_threads = len / CHECKSUM_PARALLEL_MIN_SLICE;
+    size_t nthreads, i;
+
+#ifndef WITH_THREADS
+    /* The slices would only run one after another, adding the cost of combining them */
+    Z_UNUSED(threads);
+    return 0;
+#endif
+    nthreads = MIN(MIN((size_t)MAX(threads, 1), ZTHREAD_MAX), max_threads);
+    if (nthreads < 2)
+        return 0;
+
+    /* Slices are rounded up to whole cache lines, which leaves the last one shorter but never empty as long as
+       every slice is far longer than the rounding */
+    par->slices = MIN(nthreads * CHECKSUM_PARALLEL_SPLIT, max_threads);
+    par->slice_len = ALIGN_UP((len + par->slices - 1) / par->slices, 64);
+    par->slices = (len + par->slice_len - 1) / par->slice_len;
+    par->last_len = len - (par->slices - 1) * par->slice_len;
+    par->func = func;
+    par->buf = buf;
+    par->next = 0;
+    par->sum[0] = init;
+    for (i = 1; i < par->slices; i++)
+        par->sum[i] = empty;
+
+    zthread_run((unsigned)nthreads, checksum_parallel_worker, par);
+    return 1;
+}
+
+#endif
@@ -5,6 +5,8 @@
 
 #include "zbuild.h"
 #include "zutil.h"
+#include "deflate.h"
+#include "zthread.h"
 
 /* ===========================================================================
  *  Architecture-specific hooks.
@@ -17,6 +19,40 @@
 #  define DEFLATE_BOUND_COMPLEN(source_len) 0
 #endif
 
+/* ===========================================================================
+     Compresses source into dest with an initialized deflate stream, for
+   compress2() and compressBatch().
+*/
+static int compress_stream(PREFIX3(stream) *strm, unsigned char *dest, z_uintmax_t *destLen,
+                           const unsigned char *source, z_uintmax_t sourceLen) {
+    int err;
+    const unsigned int max = (unsigned int)-1;
+    z_size_t left;
+
+    left = *destLen;
+    *destLen = 0;
+
+    strm->next_out = dest;
+    strm->avail_out = 0;
+    strm->next_in = (z_const unsigned char *)source;
+    strm->avail_in = 0;
+
+    do {
+        if (strm->avail_out == 0) {
+            strm->avail_out = left > (unsigned long)max ? max : (unsigned int)left;
+            left -= strm->avail_out;
+        }
+        if (strm->avail_in == 0) {
+            strm->avail_in = sourceLen > (unsigned long)max ? max : (unsigned int)sourceLen;
+            sourceLen -= strm->avail_in;
+        }
+        err = PREFIX(deflate)(strm, sourceLen ? Z_NO_FLUSH : Z_FINISH);
+    } while (err == Z_OK);
+
+    *destLen = strm->total_out;
+    return err == Z_STREAM_END ? Z_OK : err;
+}
+
 /* ===========================================================================
      Compresses the source buffer into the destination buffer. The level
    parameter has the same meaning as in deflateInit.  sourceLen is the byte
@@ -32,40 +68,20 @@ z_int32_t Z_EXPORT PREFIX(compress2)(unsigned char *dest, z_uintmax_t *destLen,
                         z_uintmax_t sourceLen, z_int32_t level) {
     PREFIX3(stream) stream;
     int err;
-    const unsigned int max = (unsigned int)-1;
-    z_size_t left;
-
-    left = *destLen;
-    *destLen = 0;
 
     stream.zalloc = NULL;
     stream.zfree = NULL;
     stream.opaque = NULL;
 
     err = PREFIX(deflateInit)(&stream, level);
-    if (err != Z_OK)
+    if (err != Z_OK) {
+        *destLen = 0;
         return err;
+    }
 
-    stream.next_out = dest;
-    stream.avail_out = 0;
-    stream.next_in = (z_const unsigned char *)source;
-    stream.avail_in = 0;
-
-    do {
-        if (stream.avail_out == 0) {
-            stream.avail_out = left > (unsigned long)max ? max : (unsigned int)left;
-            left -= stream.avail_out;
-        }
-        if (stream.avail_in == 0) {
-            stream.avail_in = sourceLen > (unsigned long)max ? max : (unsigned int)sourceLen;
-            sourceLen -= stream.avail_in;
-        }
-        err = PREFIX(deflate)(&stream, sourceLen ? Z_NO_FLUSH : Z_FINISH);
-    } while (err == Z_OK);
-
-    *destLen = stream.total_out;
+    err = compress_stream(&stream, dest, destLen, source, sourceLen);
     PREFIX(deflateEnd)(&stream);
-    return err == Z_STREAM_END ? Z_OK : err;
+    return err;
 }
 
 /* ===========================================================================
@@ -74,6 +90,68 @@ z_int32_t Z_EXPORT PREFIX(compress)(unsigned char *dest, z_uintmax_t *destLen, c
     return PREFIX(compress2)(dest, destLen, source, sourceLen, Z_DEFAULT_COMPRESSION);
 }
 
+/* ===========================================================================
+     Shared by the workers of a compressBatch() call, each takes the next item
+   until none are left.
+*/
+typedef struct compress_batch_s {
+    compress_item *items;
+    z_size_t count;
+    size_t next;
+    int32_t level;
+} compress_batch;
+
+static void compress_batch_worker(void *arg, unsigned id) {
+    compress_batch *batch = (compress_batch *)arg;
+    PREFIX3(stream) stream;
+    int warm = 0;
+    size_t i;
+
+    Z_UNUSED(id);
+    stream.zalloc = NULL;
+    stream.zfree = NULL;
+    stream.opaque = NULL;
+
+    /* items stay at Z_MEM_ERROR if no worker gets a state */
+    if (PREFIX(deflateInit)(&stream, batch->level) != Z_OK)
+        return;
+
+    while ((i = zthread_next(&batch->next)) < batch->count) {
+        compress_item *item = &batch->items[i];
+
+        /* The state is set up once per worker, and between items only the hash heads the last item used are
+           cleared, which for small items is most of the cost of a compress2() call */
+        if (warm)
+            PREFIX(deflate_reset_warm)(&stream);
+        warm = 1;
+        item->status = compress_stream(&stream, item->dest, &item->destLen, item->source, item->sourceLen);
+    }
+    PREFIX(deflateEnd)(&stream);
+}
+
+/* ===========================================================================
+     Compresses each of count items as compress2() would, on up to threads
+   threads with one deflate state each.
+*/
+z_int32_t Z_EXPORT PREFIX(compressBatch)(compress_item *items, z_size_t count, z_int32_t level, z_int32_t threads) {
+    compress_batch batch;
+
+    if ((items == NULL && count != 0) || level < Z_DEFAULT_COMPRESSION || level > 9)
+        return Z_STREAM_ERROR;
+
+    for (z_size_t i = 0; i < count; i++)
+        items[i].status = Z_MEM_ERROR;
+
+    batch.items = items;
+    batch.count = count;
+    batch.next = 0;
+    batch.level = level;
+    if (threads < 1)
+        threads = 1;
+    zthread_run((unsigned)MIN((z_size_t)threads, MAX(count, 1)), compress_batch_worker, &batch);
+    return Z_OK;
+}
+
 /* ===========================================================================
    If the default memLevel or windowBits for deflateInit() is changed, then
    this function needs to be updated.
@@ -44,3 +44,31 @@ uint32_t Z_EXPORT PREFIX(crc32)(uint32_t crc, const unsigned char *buf, uint32_t
     return FUNCTABLE_CALL(crc32)(crc, buf, len);
 }
 #endif
+
+#ifdef ZLIB_COMPAT
+/* Checksums converted from unsigned long per call to the functable */
+#define CRC32_MULTI_CHUNK 256
+
+void Z_EXPORT PREFIX(crc32_multi)(unsigned long *crc, const unsigned char * const *buf, const size_t *len,
+                                  size_t count) {
+    uint32_t sum[CRC32_MULTI_CHUNK];
+
+    while (count) {
+        size_t i, n = MIN(count, CRC32_MULTI_CHUNK);
+        for (i = 0; i < n; i++)
+            sum[i] = (uint32_t)crc[i];
+        FUNCTABLE_CALL(crc32_multi)(sum, buf, len, n);
+        for (i = 0; i < n; i++)
+            crc[i] = sum[i];
+        crc += n;
+        buf += n;
+        len += n;
+        count -= n;
+    }
+}
+#else
+void Z_EXPORT PREFIX(crc32_multi)(uint32_t *crc, const unsigned char * const *buf, const size_t *len,
+                                  size_t count) {
+    FUNCTABLE_CALL(crc32_multi)(crc, buf, len, count);
+}
+#endif
@@ -8,19 +8,21 @@
  */
 
 #include "zutil.h"
-#include "crc32_braid_p.h"
-#include "crc32_braid_tbl.h"
-#include "crc32_braid_comb_p.h"
+#include "functable.h"
+#include "checksum_parallel_p.h"
 
 /* ========================================================================= */
-static uint32_t crc32_combine_(uint32_t crc1, uint32_t crc2, z_off64_t len2) {
-    return multmodp(x2nmodp(len2, 3), crc1) ^ crc2;
-}
 static uint32_t crc32_combine_gen_(z_off64_t len2) {
-     return x2nmodp(len2, 3);
+    uint32_t op;
+
+    FUNCTABLE_CALL(crc32_combine_gen)(&op, &len2, 1);
+    return op;
 }
 static uint32_t crc32_combine_op_(uint32_t crc1, uint32_t crc2, const uint32_t op) {
-    return multmodp(op, crc1) ^ crc2;
+    return FUNCTABLE_CALL(crc32_combine_op)(crc1, crc2, op);
+}
+static uint32_t crc32_combine_(uint32_t crc1, uint32_t crc2, z_off64_t len2) {
+    return crc32_combine_op_(crc1, crc2, crc32_combine_gen_(len2));
 }
 
 /* ========================================================================= */
@@ -54,3 +56,59 @@ uint32_t Z_EXPORT PREFIX(crc32_combine_op)(uint32_t crc1, uint32_t crc2, const u
 #endif
 
 /* ========================================================================= */
+#ifdef ZLIB_COMPAT
+/* Operators converted to unsigned long per call to the functable */
+#define CRC32_COMBINE_GEN_CHUNK 256
+
+void Z_EXPORT PREFIX(crc32_combine_gen_multi)(unsigned long *op, const z_off64_t *len2, size_t count) {
+    uint32_t gen[CRC32_COMBINE_GEN_CHUNK];
+
+    while (count) {
+        size_t i, n = MIN(count, CRC32_COMBINE_GEN_CHUNK);
+        FUNCTABLE_CALL(crc32_combine_gen)(gen, len2, n);
+        for (i = 0; i < n; i++)
+            op[i] = gen[i];
+        op += n;
+        len2 += n;
+        count -= n;
+    }
+}
+#else
+void Z_EXPORT PREFIX(crc32_combine_gen_multi)(uint32_t *op, const z_off64_t *len2, size_t count) {
+    FUNCTABLE_CALL(crc32_combine_gen)(op, len2, count);
+}
+#endif
+
+/* ========================================================================= */
+/* The operators for the two slice lengths are generated once, combining the slices then costs one multiply each */
+static uint32_t crc32_parallel_(uint32_t crc, const uint8_t *buf, size_t len, int32_t threads) {
+    checksum_parallel par;
+    z_off64_t len2[2];
+    uint32_t op[2];
+    size_t i;
+
+    if (!checksum_parallel_run(&par, FUNCTABLE_FPTR(crc32), crc, CRC32_INITIAL_VALUE, buf, len, threads))
+        return FUNCTABLE_CALL(crc32)(crc, buf, len);
+
+    len2[0] = (z_off64_t)par.slice_len;
+    len2[1] = (z_off64_t)par.last_len;
+    FUNCTABLE_CALL(crc32_combine_gen)(op, len2, 2);
+    crc = par.sum[0];
+    for (i = 1; i < par.slices; i++)
+        crc = crc32_combine_op_(crc, par.sum[i], i == par.slices - 1 ? op[1] : op[0]);
+    return crc;
+}
+
+#ifdef ZLIB_COMPAT
+unsigned long Z_EXPORT PREFIX(crc32_parallel)(unsigned long crc, const unsigned char *buf, size_t len, int threads) {
+    if (buf == NULL)
+        return CRC32_INITIAL_VALUE;
+    return (unsigned long)crc32_parallel_((uint32_t)crc, buf, len, threads);
+}
+#else
+uint32_t Z_EXPORT PREFIX(crc32_parallel)(uint32_t crc, const unsigned char *buf, size_t len, int32_t threads) {
+    if (buf == NULL)
+        return CRC32_INITIAL_VALUE;
+    return crc32_parallel_(crc, buf, len, threads);
+}
+#endif
@@ -0,0 +1,73 @@
+/* crc32c.c -- compute the CRC-32C (Castagnoli) of a data stream
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "zutil.h"
+#include "functable.h"
+#include "crc32c_p.h"
+
+/* CRC-32C polynomial, reflected, with x^32 implied */
+#define CRC32C_POLY 0x82f63b78
+
+/* Return a(x) multiplied by b(x) modulo p(x), as multmodp() in crc32_braid_comb_p.h. a must not be zero. */
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b) {
+    uint32_t m, p;
+
+    m = (uint32_t)1 << 31;
+    p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+static uint32_t crc32c_combine_(uint32_t crc1, uint32_t crc2, z_off64_t len2) {
+    uint32_t op = (uint32_t)1 << 31;    /* x^0 == 1 */
+    unsigned k;
+
+    for (k = 0; len2 > 0; len2 >>= 1, k++) {
+        if (len2 & 1)
+            op = crc32c_multmodp(crc32c_x2n_table[k], op);
+    }
+    return crc32c_multmodp(op, crc1) ^ crc2;
+}
+
+/* ========================================================================= */
+
+#ifdef ZLIB_COMPAT
+unsigned long Z_EXPORT PREFIX(crc32c)(unsigned long crc, const unsigned char *buf, size_t len) {
+    if (buf == NULL)
+        return CRC32C_INITIAL_VALUE;
+    return (unsigned long)FUNCTABLE_CALL(crc32c)((uint32_t)crc, buf, len);
+}
+unsigned long Z_EXPORT PREFIX(crc32c_copy)(unsigned long crc, unsigned char *dst, const unsigned char *src,
+                                           size_t len) {
+    if (src == NULL)
+        return CRC32C_INITIAL_VALUE;
+    return (unsigned long)FUNCTABLE_CALL(crc32c_copy)((uint32_t)crc, dst, src, len);
+}
+unsigned long Z_EXPORT PREFIX(crc32c_combine)(unsigned long crc1, unsigned long crc2, z_off64_t len2) {
+    return (unsigned long)crc32c_combine_((uint32_t)crc1, (uint32_t)crc2, len2);
+}
+#else
+uint32_t Z_EXPORT PREFIX(crc32c)(uint32_t crc, const unsigned char *buf, size_t len) {
+    if (buf == NULL)
+        return CRC32C_INITIAL_VALUE;
+    return FUNCTABLE_CALL(crc32c)(crc, buf, len);
+}
+uint32_t Z_EXPORT PREFIX(crc32c_copy)(uint32_t crc, unsigned char *dst, const unsigned char *src, size_t len) {
+    if (src == NULL)
+        return CRC32C_INITIAL_VALUE;
+    return FUNCTABLE_CALL(crc32c_copy)(crc, dst, src, len);
+}
+uint32_t Z_EXPORT PREFIX(crc32c_combine)(uint32_t crc1, uint32_t crc2, z_off64_t len2) {
+    return crc32c_combine_(crc1, crc2, len2);
+}
+#endif
@@ -0,0 +1,23 @@
+/* crc32c_p.h -- Private inline functions and macros shared by the CRC-32C engines
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef CRC32C_P_H_
+#define CRC32C_P_H_
+
+#include "zbuild.h"
+#include "zendian.h"
+#include "zmemory.h"
+#include "crc32c_tbl.h"
+
+#define CRC32C_INITIAL_VALUE 0
+
+#define CRC_T uint32_t
+#define CRC_TABLE crc32c_table
+#define CRC_SLICE8 crc32c_slice8
+#include "crc_slice8_tpl.h"
+#undef CRC_T
+#undef CRC_TABLE
+#undef CRC_SLICE8
+
+#endif
@@ -0,0 +1,58 @@
+/* crc64.c -- compute the CRC-64/XZ (ECMA-182) of a data stream
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "zutil.h"
+#include "functable.h"
+#include "crc64_p.h"
+
+/* CRC-64/XZ polynomial, reflected, with x^64 implied */
+#define CRC64_POLY 0xc96c5795d7870f42ULL
+
+/* Return a(x) multiplied by b(x) modulo p(x), as multmodp() in crc32_braid_comb_p.h. a must not be zero. */
+static uint64_t crc64_multmodp(uint64_t a, uint64_t b) {
+    uint64_t m, p;
+
+    m = (uint64_t)1 << 63;
+    p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ CRC64_POLY : b >> 1;
+    }
+    return p;
+}
+
+static uint64_t crc64_combine_(uint64_t crc1, uint64_t crc2, z_off64_t len2) {
+    uint64_t op = (uint64_t)1 << 63;    /* x^0 == 1 */
+    unsigned k;
+
+    for (k = 0; len2 > 0; len2 >>= 1, k++) {
+        if (len2 & 1)
+            op = crc64_multmodp(crc64_x2n_table[k], op);
+    }
+    return crc64_multmodp(op, crc1) ^ crc2;
+}
+
+/* ========================================================================= */
+
+uint64_t Z_EXPORT PREFIX(crc64)(uint64_t crc, const unsigned char *buf, size_t len) {
+    if (buf == NULL)
+        return CRC64_INITIAL_VALUE;
+    return FUNCTABLE_CALL(crc64)(crc, buf, len);
+}
+
+uint64_t Z_EXPORT PREFIX(crc64_copy)(uint64_t crc, unsigned char *dst, const unsigned char *src, size_t len) {
+    if (src == NULL)
+        return CRC64_INITIAL_VALUE;
+    return FUNCTABLE_CALL(crc64_copy)(crc, dst, src, len);
+}
+
+uint64_t Z_EXPORT PREFIX(crc64_combine)(uint64_t crc1, uint64_t crc2, z_off64_t len2) {
+    return crc64_combine_(crc1, crc2, len2);
+}
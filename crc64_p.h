@@ -0,0 +1,23 @@
+/* crc64_p.h -- Private inline functions and macros shared by the CRC-64/XZ engines
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef CRC64_P_H_
+#define CRC64_P_H_
+
+#include "zbuild.h"
+#include "zendian.h"
+#include "zmemory.h"
+#include "crc64_tbl.h"
+
+#define CRC64_INITIAL_VALUE 0
+
+#define CRC_T uint64_t
+#define CRC_TABLE crc64_table
+#define CRC_SLICE8 crc64_slice8
+#include "crc_slice8_tpl.h"
+#undef CRC_T
+#undef CRC_TABLE
+#undef CRC_SLICE8
+
+#endif
@@ -0,0 +1,31 @@
+/* crc_slice8_tpl.h -- Slicing-by-8 update of a reflected CRC of up to 64 bits
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* Define CRC_T as the register type, CRC_TABLE as the [8][256] slicing table of the polynomial and CRC_SLICE8 as
+ * the name of the function. The register is neither inverted on the way in nor on the way out, so the function
+ * also serves to reduce a folded state, starting from zero.
+ */
+static inline CRC_T CRC_SLICE8(CRC_T c, uint8_t *dst, const uint8_t *buf, size_t len, const int COPY) {
+    while (len >= 8) {
+        uint64_t v = Z_U64_FROM_LE(zng_memread_8(buf)) ^ c;
+
+        if (COPY) {
+            memcpy(dst, buf, 8);
+            dst += 8;
+        }
+        c = (CRC_T)(CRC_TABLE[7][v & 0xff] ^ CRC_TABLE[6][(v >> 8) & 0xff] ^
+                    CRC_TABLE[5][(v >> 16) & 0xff] ^ CRC_TABLE[4][(v >> 24) & 0xff] ^
+                    CRC_TABLE[3][(v >> 32) & 0xff] ^ CRC_TABLE[2][(v >> 40) & 0xff] ^
+                    CRC_TABLE[1][(v >> 48) & 0xff] ^ CRC_TABLE[0][v >> 56]);
+        buf += 8;
+        len -= 8;
+    }
+    while (len) {
+        len--;
+        if (COPY)
+            *dst++ = *buf;
+        c = CRC_TABLE[0][(c ^ *buf++) & 0xff] ^ (c >> 8);
+    }
+    return c;
+}
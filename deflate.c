@@ -82,6 +82,7 @@ Z_INTERNAL block_state deflate_rle   (deflate_state *s, int flush);
 Z_INTERNAL block_state deflate_huff  (deflate_state *s, int flush);
 static void lm_set_level         (deflate_state *s, int level);
 static void lm_init              (deflate_state *s);
+static void lm_reset             (deflate_state *s);
 
 /* ===========================================================================
  * Local data
@@ -159,8 +160,12 @@ static const config configuration_table[10] = {
 /* ===========================================================================
  * Allocate a big buffer and divide it up into the various buffers deflate needs.
  * Handles alignment of allocated buffer and alignment of individual buffers.
+ * If work_size is not NULL, the buffer is work instead, which must be at least
+ * *work_size bytes long, and zalloc is not called. If work is NULL as well, only
+ * the size needed is stored in *work_size.
  */
-Z_INTERNAL deflate_allocs* alloc_deflate(PREFIX3(stream) *strm, int windowBits, int lit_bufsize) {
+Z_INTERNAL deflate_allocs* alloc_deflate(PREFIX3(stream) *strm, int windowBits, int lit_bufsize, void *work,
+                                         size_t *work_size) {
     int curr_size = 0;
 
     /* Define sizes */
@@ -199,18 +204,33 @@ Z_INTERNAL deflate_allocs* alloc_deflate(PREFIX3(stream) *strm, int windowBits,
     /* Add 64-1 or 4096-1 to allow window alignment, and round size of buffer up to multiple of 64 */
     int total_size = PAD_64(curr_size + (WINDOW_PAD_SIZE - 1));
 
-    /* Allocate buffer, align to 64-byte cacheline, and zerofill the resulting buffer */
-    char *original_buf = (char *)strm->zalloc(strm->opaque, 1, total_size);
-    if (original_buf == NULL)
-        return NULL;
+    /* Allocate buffer or take the workspace, align to 64-byte cacheline, and zerofill the resulting buffer */
+    char *original_buf;
+    if (work_size != NULL) {
+        if (work == NULL)
+            *work_size = (size_t)total_size;
+        if (work == NULL || *work_size < (size_t)total_size)
+            return NULL;
+        original_buf = (char *)work;
+    } else {
+        /* Check the budget before allocating */
+        if (zng_mem_take((size_t)total_size))
+            return NULL;
+        original_buf = (char *)strm->zalloc(strm->opaque, 1, total_size);
+        if (original_buf == NULL) {
+            zng_mem_give((size_t)total_size);
+            return NULL;
+        }
+    }
 
     char *buff = (char *)HINT_ALIGNED_WINDOW((char *)PAD_WINDOW(original_buf));
     LOGSZPL("Buffer alloc", total_size, PADSZ((uintptr_t)original_buf,WINDOW_PAD_SIZE), PADSZ(curr_size,WINDOW_PAD_SIZE));
 
-    /* Initialize alloc_bufs */
+    /* Initialize alloc_bufs, a workspace is not freed */
     deflate_allocs *alloc_bufs  = (struct deflate_allocs_s *)(buff + alloc_pos);
     alloc_bufs->buf_start = original_buf;
-    alloc_bufs->zfree = strm->zfree;
+    alloc_bufs->zfree = work_size != NULL ? NULL : strm->zfree;
+    alloc_bufs->size = work_size != NULL ? 0 : (size_t)total_size;
 
     /* Assign buffers */
     alloc_bufs->window = (unsigned char *)HINT_ALIGNED_WINDOW(buff + window_pos);
@@ -232,17 +252,19 @@ static inline void free_deflate(PREFIX3(stream) *strm) {
 
     if (state->alloc_bufs != NULL) {
         deflate_allocs *alloc_bufs = state->alloc_bufs;
-        alloc_bufs->zfree(strm->opaque, alloc_bufs->buf_start);
+        if (alloc_bufs->zfree != NULL) {
+            zng_mem_give(alloc_bufs->size);
+            alloc_bufs->zfree(strm->opaque, alloc_bufs->buf_start);
+        }
         strm->state = NULL;
     }
 }
 
 /* ===========================================================================
- * Initialize deflate state and buffers.
- * This function is hidden in ZLIB_COMPAT builds.
+ * Initialize deflate state and buffers, in work if work_size is not NULL.
  */
-int32_t ZNG_CONDEXPORT PREFIX(deflateInit2)(PREFIX3(stream) *strm, int32_t level, int32_t method, int32_t windowBits,
-                                            int32_t memLevel, int32_t strategy) {
+static int32_t deflate_init(PREFIX3(stream) *strm, int32_t level, int32_t method, int32_t windowBits,
+                            int32_t memLevel, int32_t strategy, void *work, size_t *work_size) {
     /* Todo: ignore strm->next_in if we use it as window */
     deflate_state *s;
     int wrap = 1;
@@ -285,7 +307,7 @@ int32_t ZNG_CONDEXPORT PREFIX(deflateInit2)(PREFIX3(stream) *strm, int32_t level
 
     /* Allocate buffers */
     int lit_bufsize = 1 << (memLevel + 6);
-    deflate_allocs *alloc_bufs = alloc_deflate(strm, windowBits, lit_bufsize);
+    deflate_allocs *alloc_bufs = alloc_deflate(strm, windowBits, lit_bufsize, work, work_size);
     if (alloc_bufs == NULL)
         return Z_MEM_ERROR;
 
@@ -299,6 +321,9 @@ int32_t ZNG_CONDEXPORT PREFIX(deflateInit2)(PREFIX3(stream) *strm, int32_t level
     strm->state = (struct internal_state *)s;
     s->strm = strm;
     s->status = INIT_STATE;     /* to pass state test in deflateReset() */
+#ifdef WITH_PROFILE
+    memset(&s->profile, 0, sizeof(s->profile));
+#endif
 
     s->wrap = wrap;
     s->gzhead = NULL;
@@ -367,9 +392,46 @@ int32_t ZNG_CONDEXPORT PREFIX(deflateInit2)(PREFIX3(stream) *strm, int32_t level
     s->block_open = 0;
     s->reproducible = 0;
 
+    zprobe4(deflate_init, strm, level, windowBits, strategy);
     return PREFIX(deflateReset)(strm);
 }
 
+/* ===========================================================================
+ * Initialize deflate state and buffers.
+ * This function is hidden in ZLIB_COMPAT builds.
+ */
+int32_t ZNG_CONDEXPORT PREFIX(deflateInit2)(PREFIX3(stream) *strm, int32_t level, int32_t method, int32_t windowBits,
+                                            int32_t memLevel, int32_t strategy) {
+    return deflate_init(strm, level, method, windowBits, memLevel, strategy, NULL, NULL);
+}
+
+int32_t Z_EXPORT PREFIX(deflateInitWorkspace)(PREFIX3(stream) *strm, int32_t level, int32_t method, int32_t windowBits,
+                                              int32_t memLevel, int32_t strategy, void *work, size_t size) {
+    if (work == NULL)
+        return Z_STREAM_ERROR;
+    return deflate_init(strm, level, method, windowBits, memLevel, strategy, work, &size);
+}
+
+/* ===========================================================================
+ * Size of the workspace deflateInitWorkspace() needs, zero for invalid parameters.
+ */
+size_t Z_EXPORT PREFIX(deflateWorkspaceSize)(int32_t windowBits, int32_t memLevel) {
+    size_t size = 0;
+
+    if (windowBits < 0)
+        windowBits = -windowBits;
+#ifdef GZIP
+    else if (windowBits > MAX_WBITS)
+        windowBits -= 16;
+#endif
+    if (memLevel < 1 || memLevel > MAX_MEM_LEVEL || windowBits < MIN_WBITS || windowBits > MAX_WBITS)
+        return 0;
+    if (windowBits == 8)
+        windowBits = 9;
+    alloc_deflate(NULL, windowBits, 1 << (memLevel + 6), NULL, &size);
+    return size;
+}
+
 #ifndef ZLIB_COMPAT
 int32_t Z_EXPORT PREFIX(deflateInit)(PREFIX3(stream) *strm, int32_t level) {
     return PREFIX(deflateInit2)(strm, level, Z_DEFLATED, MAX_WBITS, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
@@ -521,6 +583,9 @@ int32_t Z_EXPORT PREFIX(deflateResetKeep)(PREFIX3(stream) *strm) {
     s->last_flush = -2;
 
     zng_tr_init(s);
+#ifdef WITH_DEFLATE_STATS
+    memset(&s->stats, 0, sizeof(s->stats));
+#endif
 
     DEFLATE_RESET_KEEP_HOOK(strm);  /* hook for IBM Z DFLTCC */
 
@@ -535,6 +600,35 @@ int32_t Z_EXPORT PREFIX(deflateReset)(PREFIX3(stream) *strm) {
     return ret;
 }
 
+/* Input size up to which rehashing it is faster than clearing the whole hash table */
+#define WARM_RESET_MAX (HASH_SIZE / 32)
+
+/* ===========================================================================
+ * deflateReset() for a stream that took in little data, at one level and without a dictionary, since it was last
+ * reset. All of that data is still in place in the window, so rehashing it finds every hash head it could have
+ * set. Level 9 uses the rolling hash, which depends on the order of insertion, and gets a full reset.
+ */
+int32_t Z_INTERNAL PREFIX(deflate_reset_warm)(PREFIX3(stream) *strm) {
+    deflate_state *s;
+    uint32_t used;
+    int32_t ret;
+
+    if (deflateStateCheck(strm))
+        return Z_STREAM_ERROR;
+    s = strm->state;
+    if (s->level >= 9 || strm->total_in > WARM_RESET_MAX || strm->total_in >= s->w_size)
+        return PREFIX(deflateReset)(strm);
+
+    used = (uint32_t)strm->total_in;
+    for (uint32_t str = 0; str < used; str++)
+        s->head[update_hash(0, Z_U32_FROM_LE(zng_memread_4(s->window + str)))] = 0;
+
+    ret = PREFIX(deflateResetKeep)(strm);
+    if (ret == Z_OK)
+        lm_reset(s);
+    return ret;
+}
+
 /* ========================================================================= */
 int32_t Z_EXPORT PREFIX(deflateSetHeader)(PREFIX3(stream) *strm, PREFIX(gz_headerp) head) {
     if (deflateStateCheck(strm) || strm->state->wrap != 2)
@@ -554,6 +648,41 @@ int32_t Z_EXPORT PREFIX(deflatePending)(PREFIX3(stream) *strm, uint32_t *pending
     return Z_OK;
 }
 
+/* ========================================================================= */
+int32_t Z_EXPORT PREFIX(deflateGetStats)(PREFIX3(stream) *strm, deflate_stats *stats) {
+#ifdef WITH_DEFLATE_STATS
+    if (deflateStateCheck(strm) || stats == NULL)
+        return Z_STREAM_ERROR;
+    memcpy(stats, &strm->state->stats, sizeof(deflate_stats));
+    return Z_OK;
+#else
+    Z_UNUSED(strm);
+    Z_UNUSED(stats);
+    return Z_VERSION_ERROR;
+#endif
+}
+
+/* ========================================================================= */
+int32_t Z_EXPORT PREFIX(deflateGetProfile)(PREFIX3(stream) *strm, z_profile *profile) {
+#ifdef WITH_PROFILE
+    if (deflateStateCheck(strm) || profile == NULL)
+        return Z_STREAM_ERROR;
+    memcpy(profile, &strm->state->profile.total, sizeof(z_profile));
+    return Z_OK;
+#else
+    Z_UNUSED(strm);
+    Z_UNUSED(profile);
+    return Z_VERSION_ERROR;
+#endif
+}
+
+int32_t Z_EXPORT PREFIX(deflateGetMemory)(PREFIX3(stream) *strm, size_t *size) {
+    if (deflateStateCheck(strm) || size == NULL)
+        return Z_STREAM_ERROR;
+    *size = strm->state->alloc_bufs->size;
+    return Z_OK;
+}
+
 /* ========================================================================= */
 int32_t Z_EXPORT PREFIX(deflatePrime)(PREFIX3(stream) *strm, int32_t bits, int32_t value) {
     deflate_state *s;
@@ -620,7 +749,9 @@ int32_t Z_EXPORT PREFIX(deflateParams)(PREFIX3(stream) *strm, int32_t level, int
     if (s->level != level) {
         if (s->level == 0 && s->matches != 0) {
             if (s->matches == 1) {
+                profile_start(s, Z_PROFILE_SLIDE_HASH);
                 FUNCTABLE_CALL(slide_hash)(s);
+                profile_stop(s, Z_PROFILE_SLIDE_HASH);
             } else {
                 CLEAR_HASH(s);
             }
@@ -648,36 +779,11 @@ int32_t Z_EXPORT PREFIX(deflateTune)(PREFIX3(stream) *strm, int32_t good_length,
 }
 
 /* =========================================================================
- * For the default windowBits of 15 and memLevel of 8, this function returns
- * a close to exact, as well as small, upper bound on the compressed size.
- * They are coded as constants here for a reason--if the #define's are
- * changed, then this function needs to be changed as well.  The return
- * value for 15 and 8 only works for those exact settings.
- *
- * For any setting other than those defaults for windowBits and memLevel,
- * the value returned is a conservative worst case for the maximum expansion
- * resulting from using fixed blocks instead of stored blocks, which deflate
- * can emit on compressed data for some combinations of the parameters.
- *
- * This function could be more sophisticated to provide closer upper bounds for
- * every combination of windowBits and memLevel.  But even the conservative
- * upper bound of about 14% expansion does not seem onerous for output buffer
- * allocation.
+ * Length of the zlib or gzip wrapper around the deflate data
  */
-unsigned long Z_EXPORT PREFIX(deflateBound)(PREFIX3(stream) *strm, unsigned long sourceLen) {
-    deflate_state *s;
-    unsigned long complen, wraplen;
-
-    /* conservative upper bound for compressed data */
-    complen = sourceLen + ((sourceLen + 7) >> 3) + ((sourceLen + 63) >> 6) + 5;
-    DEFLATE_BOUND_ADJUST_COMPLEN(strm, complen, sourceLen);  /* hook for IBM Z DFLTCC */
+static unsigned long deflate_wraplen(deflate_state *s) {
+    unsigned long wraplen;
 
-    /* if can't get parameters, return conservative bound plus zlib wrapper */
-    if (deflateStateCheck(strm))
-        return complen + 6;
-
-    /* compute wrapper length */
-    s = strm->state;
     switch (s->wrap) {
     case 0:                                 /* raw deflate */
         wraplen = 0;
@@ -714,6 +820,41 @@ unsigned long Z_EXPORT PREFIX(deflateBound)(PREFIX3(stream) *strm, unsigned long
         Z_UNREACHABLE();
         wraplen = ZLIB_WRAPLEN;
     }
+    return wraplen;
+}
+
+/* =========================================================================
+ * For the default windowBits of 15 and memLevel of 8, this function returns
+ * a close to exact, as well as small, upper bound on the compressed size.
+ * They are coded as constants here for a reason--if the #define's are
+ * changed, then this function needs to be changed as well.  The return
+ * value for 15 and 8 only works for those exact settings.
+ *
+ * For any setting other than those defaults for windowBits and memLevel,
+ * the value returned is a conservative worst case for the maximum expansion
+ * resulting from using fixed blocks instead of stored blocks, which deflate
+ * can emit on compressed data for some combinations of the parameters.
+ *
+ * This function could be more sophisticated to provide closer upper bounds for
+ * every combination of windowBits and memLevel.  But even the conservative
+ * upper bound of about 14% expansion does not seem onerous for output buffer
+ * allocation.
+ */
+unsigned long Z_EXPORT PREFIX(deflateBound)(PREFIX3(stream) *strm, unsigned long sourceLen) {
+    deflate_state *s;
+    unsigned long complen, wraplen;
+
+    /* conservative upper bound for compressed data */
+    complen = sourceLen + ((sourceLen + 7) >> 3) + ((sourceLen + 63) >> 6) + 5;
+    DEFLATE_BOUND_ADJUST_COMPLEN(strm, complen, sourceLen);  /* hook for IBM Z DFLTCC */
+
+    /* if can't get parameters, return conservative bound plus zlib wrapper */
+    if (deflateStateCheck(strm))
+        return complen + 6;
+
+    /* compute wrapper length */
+    s = strm->state;
+    wraplen = deflate_wraplen(s);
 
     /* if not default parameters, return conservative bound */
     if (DEFLATE_NEED_CONSERVATIVE_BOUND(strm) ||  /* hook for IBM Z DFLTCC */
@@ -739,6 +880,189 @@ unsigned long Z_EXPORT PREFIX(deflateBound)(PREFIX3(stream) *strm, unsigned long
 #endif
 }
 
+#ifndef DEFLATE_ESTIMATE_SAMPLE
+#  define DEFLATE_ESTIMATE_SAMPLE 16384
+#endif
+/* Bytes in each sample taken by deflateEstimate(). Large inputs are sampled
+ * at a rate of at most 1 in DEFLATE_ESTIMATE_RATIO, up to a window full.
+ */
+#define DEFLATE_ESTIMATE_RATIO 16
+
+typedef struct deflate_estimate_s {
+    uint64_t data_bits;     /* bits of block data over all sampled blocks */
+    uint64_t overhead;      /* per block overhead bits, weighted by block symbols */
+    uint64_t syms;          /* symbols tallied over all sampled blocks */
+    uint32_t block_bytes;   /* input bytes in the current sampled block */
+} deflate_estimate;
+
+/* ===========================================================================
+ * Size the sampled block with the cheapest of dynamic, static and stored
+ * encoding, like zng_tr_flush_block() would. Sampled blocks are much shorter
+ * than real ones, so overhead paid once per block is accounted in proportion
+ * to the number of symbols in the sampled block.
+ */
+static void estimate_block(deflate_state *s, deflate_estimate *est) {
+    uint32_t dyn_bits, tree_bits, static_bits, syms = s->sym_next;
+    uint64_t data, overhead, cost, best_data, best_overhead, best;
+    int quick;
+
+    if (syms == 0)
+        return;
+
+    /* deflate_quick() only writes static blocks, the huffman and rle strategies run their own functions instead */
+    quick = configuration_table[s->level].func == deflate_quick && s->strategy != Z_HUFFMAN_ONLY &&
+            s->strategy != Z_RLE;
+
+    zng_tr_estimate_block(s, &dyn_bits, &tree_bits, &static_bits);
+
+    /* static trees, costs are scaled by sym_end to apply the weighting */
+    best_data = static_bits;
+    best_overhead = 0;
+    best = best_data * s->sym_end;
+
+    /* dynamic trees */
+    if (!quick && s->strategy != Z_FIXED) {
+        data = dyn_bits;
+        overhead = (uint64_t)tree_bits * syms;
+        cost = data * s->sym_end + overhead;
+        if (cost < best) {
+            best_data = data;
+            best_overhead = overhead;
+            best = cost;
+        }
+    }
+    /* stored */
+    if (!quick) {
+        data = (uint64_t)est->block_bytes << 3;
+        overhead = (uint64_t)40 * syms;
+        cost = data * s->sym_end + overhead;
+        if (cost < best) {
+            best_data = data;
+            best_overhead = overhead;
+        }
+    }
+
+    est->data_bits += best_data;
+    est->overhead += best_overhead;
+    est->syms += syms;
+    est->block_bytes = 0;
+}
+
+/* ===========================================================================
+ * Greedily parse window[strstart .. end) with the hash chains and match finder
+ * of the current level, tallying into the block trees.
+ */
+static void estimate_parse(deflate_state *s, deflate_estimate *est, unsigned int end) {
+    unsigned char *window = s->window;
+    int matching = s->strategy != Z_HUFFMAN_ONLY && s->strategy != Z_RLE;
+    int bflush;
+
+    while (s->strstart < end) {
+        uint32_t match_len = 0;
+
+        s->lookahead = end - s->strstart;
+        if (matching && s->lookahead >= WANT_MIN_MATCH) {
+            uint32_t hash_head = quick_insert_string(s, s->strstart);
+            int64_t dist = (int64_t)s->strstart - hash_head;
+
+            if (dist <= MAX_DIST(s) && dist > 0 && hash_head != 0)
+                match_len = FUNCTABLE_CALL(longest_match)(s, hash_head);
+        } else if (s->strategy == Z_RLE && s->strstart > 0) {
+            /* Match against the previous byte only, like deflate_rle() */
+            uint32_t max_len = MIN(s->lookahead, STD_MAX_MATCH);
+            const unsigned char prev = window[s->strstart - 1];
+
+            while (match_len < max_len && window[s->strstart + match_len] == prev)
+                match_len++;
+            s->match_start = s->strstart - 1;
+            if (match_len < STD_MIN_MATCH)
+                match_len = 0;
+        }
+
+        if (match_len >= STD_MIN_MATCH && (match_len >= WANT_MIN_MATCH || !matching)) {
+            bflush = zng_tr_tally_dist(s, s->strstart - s->match_start, match_len - STD_MIN_MATCH);
+            if (matching && match_len <= s->max_insert_length && s->lookahead - match_len >= WANT_MIN_MATCH)
+                insert_string_static(s, s->strstart + 1, match_len - 1);
+            s->strstart += match_len;
+            est->block_bytes += match_len;
+        } else {
+            bflush = zng_tr_tally_lit(s, window[s->strstart]);
+            s->strstart++;
+            est->block_bytes++;
+        }
+        if (UNLIKELY(bflush))
+            estimate_block(s, est);
+    }
+}
+
+/* =========================================================================
+ * Sample the input into the window of the unused stream, parse the samples
+ * and size their blocks with the trees of trees.c, then scale the result up
+ * to the whole input, then reset the stream that was used as work space.
+ */
+unsigned long Z_EXPORT PREFIX(deflateEstimate)(PREFIX3(stream) *strm, const unsigned char *source, unsigned long sourceLen) {
+    deflate_state *s;
+    deflate_estimate est;
+    unsigned long wraplen, samples, sample_len, sampled, bits, k;
+    unsigned int pos = 0, limit;
+
+    if (deflateStateCheck(strm) || source == NULL)
+        return PREFIX(deflateBound)(strm, sourceLen);
+    s = strm->state;
+    /* After Z_FINISH the wrapper is no longer known, size it as for an inconsistent stream */
+    if (s->wrap < 0)
+        return PREFIX(deflateBound)(NULL, sourceLen);
+    if (strm->total_in || s->strstart || s->lookahead || s->pending)
+        return PREFIX(deflateBound)(strm, sourceLen);
+
+    wraplen = deflate_wraplen(s);
+    if (s->level == 0)
+        return sourceLen + 5 * (sourceLen / MAX_STORED + 1) + wraplen;
+    if (sourceLen == 0)
+        return 2 + wraplen;
+
+    /* Choose evenly spaced samples that fit the window together */
+    limit = s->window_size - MIN_LOOKAHEAD;
+    sample_len = MIN(DEFLATE_ESTIMATE_SAMPLE, limit);
+    if (sourceLen <= sample_len) {
+        sample_len = sourceLen;
+        samples = 1;
+    } else {
+        samples = sourceLen / ((unsigned long)sample_len * DEFLATE_ESTIMATE_RATIO);
+        samples = MAX(1, MIN(samples, limit / sample_len));
+    }
+    sampled = samples * sample_len;
+
+    /* Initialize the bytes after the samples for the match finder, see fill_window() */
+    memset(s->window + sampled, 0, MIN(WIN_INIT, s->window_size - sampled));
+
+    memset(&est, 0, sizeof(est));
+    s->prev_length = 0;
+    for (k = 0; k < samples; k++) {
+        /* Centered in each of the samples equal sized slices of the input */
+        unsigned long offset = (sourceLen - sample_len) * (2 * k + 1) / (2 * samples);
+
+        memcpy(s->window + pos, source + offset, sample_len);
+        s->strstart = pos;
+        pos += (unsigned int)sample_len;
+        estimate_parse(s, &est, pos);
+    }
+    estimate_block(s, &est);
+
+    /* If the whole input fits in one block the overhead is paid exactly once,
+     * otherwise scale it with the data to the number of blocks for the input.
+     */
+    bits = (unsigned long)(est.data_bits * sourceLen / sampled);
+    if (est.syms * sourceLen < (uint64_t)s->sym_end * sampled)
+        bits += (unsigned long)(est.overhead / est.syms);
+    else
+        bits += (unsigned long)(est.overhead * sourceLen / ((uint64_t)s->sym_end * sampled));
+
+    PREFIX(deflateReset)(strm);
+
+    return (bits + 7) / 8 + wraplen;
+}
+
 /* =========================================================================
  * Flush as much pending output as possible. See flush_pending_inline()
  */
@@ -755,6 +1079,31 @@ Z_INTERNAL void PREFIX(flush_pending)(PREFIX3(stream) *strm) {
             strm->adler = PREFIX(crc32)(strm->adler, s->pending_buf + (beg), s->pending - (beg)); \
     } while (0)
 
+#ifdef WITH_DEFLATE_STATS
+/* ===========================================================================
+ * Index in deflate_stats of the compression function deflate() calls next.
+ */
+static int deflate_stats_func(deflate_state *s) {
+    compress_func func = configuration_table[s->level].func;
+
+    if (s->level == 0)
+        return Z_STATS_STORED;
+    if (s->strategy == Z_HUFFMAN_ONLY)
+        return Z_STATS_HUFF;
+    if (s->strategy == Z_RLE)
+        return Z_STATS_RLE;
+#ifndef NO_QUICK_STRATEGY
+    if (func == deflate_quick)
+        return Z_STATS_QUICK;
+#endif
+#ifndef NO_MEDIUM_STRATEGY
+    if (func == deflate_medium)
+        return Z_STATS_MEDIUM;
+#endif
+    return func == deflate_fast ? Z_STATS_FAST : Z_STATS_SLOW;
+}
+#endif
+
 /* ========================================================================= */
 int32_t Z_EXPORT PREFIX(deflate)(PREFIX3(stream) *strm, int32_t flush) {
     int32_t old_flush; /* value of flush param for previous deflate call */
@@ -975,12 +1324,22 @@ int32_t Z_EXPORT PREFIX(deflate)(PREFIX3(stream) *strm, int32_t flush) {
      */
     if (strm->avail_in != 0 || s->lookahead != 0 || (flush != Z_NO_FLUSH && s->status != FINISH_STATE)) {
         block_state bstate;
+#ifdef WITH_DEFLATE_STATS
+        int stats_func = deflate_stats_func(s);
+        unsigned long stats_in = strm->total_in;
+        uint64_t stats_out = strm->total_out + s->pending;
+#endif
 
+        profile_start(s, Z_PROFILE_DEFLATE);
         bstate = DEFLATE_HOOK(strm, flush, &bstate) ? bstate :  /* hook for IBM Z DFLTCC */
                  s->level == 0 ? deflate_stored(s, flush) :
                  s->strategy == Z_HUFFMAN_ONLY ? deflate_huff(s, flush) :
                  s->strategy == Z_RLE ? deflate_rle(s, flush) :
-                 (*(configuration_table[s->level].func))(s, flush);
+                 s->deflate_func(s, flush);
+        profile_stop(s, Z_PROFILE_DEFLATE);
+
+        stats_add(s, func_in[stats_func], strm->total_in - stats_in);
+        stats_add(s, func_out[stats_func], strm->total_out + s->pending - stats_out);
 
         if (bstate == finish_started || bstate == finish_done) {
             s->status = FINISH_STATE;
@@ -1057,6 +1416,11 @@ int32_t Z_EXPORT PREFIX(deflateEnd)(PREFIX3(stream) *strm) {
 
     int32_t status = strm->state->status;
 
+    zprobe3(deflate_end, strm, strm->total_in, strm->total_out);
+#ifdef WITH_PROFILE
+    zprofile_add(&strm->state->profile.total);
+#endif
+
     /* Free allocated buffers */
     free_deflate(strm);
 
@@ -1077,7 +1441,7 @@ int32_t Z_EXPORT PREFIX(deflateCopy)(PREFIX3(stream) *dest, PREFIX3(stream) *sou
 
     memcpy((void *)dest, (void *)source, sizeof(PREFIX3(stream)));
 
-    deflate_allocs *alloc_bufs = alloc_deflate(dest, W_BITS(ss), ss->lit_bufsize);
+    deflate_allocs *alloc_bufs = alloc_deflate(dest, W_BITS(ss), ss->lit_bufsize, NULL, NULL);
     if (alloc_bufs == NULL)
         return Z_MEM_ERROR;
 
@@ -1086,6 +1450,9 @@ int32_t Z_EXPORT PREFIX(deflateCopy)(PREFIX3(stream) *dest, PREFIX3(stream) *sou
     dest->state = (struct internal_state *) ds;
     memcpy(ds, ss, sizeof(deflate_state));
     ds->strm = dest;
+#ifdef WITH_PROFILE
+    memset(&ds->profile, 0, sizeof(ds->profile));
+#endif
 
     ds->alloc_bufs = alloc_bufs;
     ds->window = alloc_bufs->window;
@@ -1127,15 +1494,33 @@ static void lm_set_level(deflate_state *s, int level) {
     s->nice_match       = configuration_table[level].nice_length;
     s->max_chain_length = configuration_table[level].max_chain;
     s->level = level;
+
+    /* Take the variant of the strategy built for the cpu once here, rather than on every deflate() call */
+    s->deflate_func = configuration_table[level].func;
+#ifndef NO_QUICK_STRATEGY
+    if (s->deflate_func == deflate_quick)
+        s->deflate_func = FUNCTABLE_FPTR(deflate_quick);
+#endif
+#ifndef NO_MEDIUM_STRATEGY
+    if (s->deflate_func == deflate_medium)
+        s->deflate_func = FUNCTABLE_FPTR(deflate_medium);
+#endif
 }
 
 /* ===========================================================================
  * Initialize the "longest match" routines for a new zlib stream
  */
 static void lm_init(deflate_state *s) {
-    s->window_size = 2 * s->w_size;
-
     CLEAR_HASH(s);
+    lm_reset(s);
+}
+
+/* ===========================================================================
+ * Initialize the "longest match" routines for a new zlib stream, except for
+ * the hash table
+ */
+static void lm_reset(deflate_state *s) {
+    s->window_size = 2 * s->w_size;
 
     /* Set the default configuration parameters:
      */
@@ -1149,6 +1534,7 @@ static void lm_init(deflate_state *s) {
     s->match_available = 0;
     s->match_start = 0;
     s->ins_h = 0;
+    s->probe_next = 0;
 }
 
 /* ===========================================================================
@@ -1172,6 +1558,7 @@ void Z_INTERNAL PREFIX(fill_window)(deflate_state *s) {
     int level = s->level;
 
     Assert(s->lookahead < MIN_LOOKAHEAD, "already enough lookahead");
+    profile_start(s, Z_PROFILE_FILL_WINDOW);
 
     if (level >= 9)
         insert_string_func = insert_string_roll;
@@ -1196,7 +1583,12 @@ void Z_INTERNAL PREFIX(fill_window)(deflate_state *s) {
             s->block_start -= (int)wsize;
             if (s->insert > s->strstart)
                 s->insert = s->strstart;
+            s->probe_next = s->probe_next > wsize ? s->probe_next - wsize : 0;
+            profile_start(s, Z_PROFILE_SLIDE_HASH);
             FUNCTABLE_CALL(slide_hash)(s);
+            profile_stop(s, Z_PROFILE_SLIDE_HASH);
+            stats_add(s, window_slides, 1);
+            zprobe2(deflate_slide, strm, strm->total_in);
             more += wsize;
         }
         if (strm->avail_in == 0)
@@ -1275,6 +1667,7 @@ void Z_INTERNAL PREFIX(fill_window)(deflate_state *s) {
 
     Assert((unsigned long)s->strstart <= s->window_size - MIN_LOOKAHEAD,
            "not enough room for search");
+    profile_stop(s, Z_PROFILE_FILL_WINDOW);
 }
 
 #ifndef ZLIB_COMPAT
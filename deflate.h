@@ -14,6 +14,8 @@
 #include "zendian.h"
 #include "zmemory.h"
 #include "crc32.h"
+#include "zprofile.h"
+#include "zprobe.h"
 
 #ifdef S390_DFLTCC_DEFLATE
 #  include "arch/s390/dfltcc_common.h"
@@ -62,6 +64,23 @@
 #define END_BLOCK 256
 /* end of block literal code */
 
+#define SPLIT_LIT_TYPES 8
+#define SPLIT_OBS_TYPES (SPLIT_LIT_TYPES + 2)
+/* symbol classes observed for block splitting: 8 literal classes, short and long matches */
+
+#define SPLIT_CHECK_INTERVAL 512
+/* number of symbols between block split checks */
+
+#define SPLIT_MIN_BLOCK 10000
+/* minimum input bytes in a block before it may be split */
+
+#define TREE_CACHE_SIZE 576
+/* bytes for the encoded tree representation of a dynamic block, at most 4495 bits plus room for 32-bit reads */
+
+#define TREE_REUSE_SLACK 128
+/* reuse the previous block's trees if they cost at most 1/TREE_REUSE_SLACK of the entropy more than they did
+ * on their own block */
+
 #define INIT_STATE      1    /* zlib header -> BUSY_STATE */
 #ifdef GZIP
 #  define GZIP_STATE    4    /* gzip header -> BUSY_STATE | EXTRA_STATE */
@@ -127,6 +146,7 @@ void     insert_string_roll      (deflate_state *const s, uint32_t str, uint32_t
 typedef struct deflate_allocs_s {
     char            *buf_start;
     free_func        zfree;
+    size_t           size;      /* bytes taken from zalloc, counted in zlibGetMemory(), 0 for a workspace */
     deflate_state   *state;
     unsigned char   *window;
     unsigned char   *pending_buf;
@@ -134,6 +154,13 @@ typedef struct deflate_allocs_s {
     Pos             *head;
 } deflate_allocs;
 
+typedef enum {
+    need_more,      /* block not completed, need more input or more output */
+    block_done,     /* block flush performed */
+    finish_started, /* finish started, need only more output at next deflate */
+    finish_done     /* finish done, accept no more input or output */
+} block_state;
+
 struct ALIGNED_(64) internal_state {
                 /* Cacheline 0 */
     PREFIX3(stream)      *strm;            /* pointer back to this zlib stream */
@@ -299,6 +326,17 @@ struct ALIGNED_(64) internal_state {
     unsigned int opt_len;         /* bit length of current block with optimal trees */
     unsigned int static_len;      /* bit length of current block with static trees */
 
+    uint32_t split_obs[SPLIT_OBS_TYPES];     /* symbol observations in the current block */
+    uint32_t split_new_obs[SPLIT_OBS_TYPES]; /* symbol observations since the last split check */
+    uint32_t split_num_obs;                  /* total of split_obs */
+    uint32_t split_num_new;                  /* total of split_new_obs */
+
+    struct ct_data_s tree_cache_ltree[L_CODES];     /* literal and length codes of the last dynamic block */
+    struct ct_data_s tree_cache_dtree[D_CODES];     /* distance codes of the last dynamic block */
+    unsigned char tree_cache_bits[TREE_CACHE_SIZE]; /* encoded tree representation of the last dynamic block */
+    unsigned int tree_cache_len;                    /* bits in tree_cache_bits, zero if no trees are cached */
+    unsigned int tree_cache_ratio;                  /* cost over entropy of the cached trees on their block, Q16 */
+
     deflate_allocs *alloc_bufs;
 
 #ifdef HAVE_ARCH_DEFLATE_STATE
@@ -311,17 +349,20 @@ struct ALIGNED_(64) internal_state {
     unsigned long bits_sent;      /* bit length of compressed data sent mod 2^32 */
 #endif
 
+    unsigned int probe_next;      /* window position of the next entropy probe */
+    block_state (*deflate_func)(deflate_state *s, int flush); /* strategy of the level for the cpu, see lm_set_level() */
+
+#ifdef WITH_DEFLATE_STATS
+    deflate_stats stats;          /* counters returned by deflateGetStats() */
+#endif
+#ifdef WITH_PROFILE
+    zprofile profile;             /* phase times returned by deflateGetProfile() */
+#endif
+
     /* Reserved for future use and alignment purposes */
-    int32_t reserved[19];
+    int32_t reserved[18];
 };
 
-typedef enum {
-    need_more,      /* block not completed, need more input or more output */
-    block_done,     /* block flush performed */
-    finish_started, /* finish started, need only more output at next deflate */
-    finish_done     /* finish done, accept no more input or output */
-} block_state;
-
 /* Output a byte on the stream.
  * IN assertion: there is enough room in pending_buf.
  */
@@ -384,6 +425,20 @@ static inline void put_uint64(deflate_state *s, uint64_t lld) {
  * See deflate.c for comments about the STD_MIN_MATCH+1.
  */
 
+#ifndef DEFLATE_PROBE_SIZE
+#  define DEFLATE_PROBE_SIZE 4096
+#endif
+/* Amount of lookahead classified by each entropy probe. Incompressible input is
+ * emitted as stored blocks in multiples of this size, see deflate_stored_probe().
+ */
+
+#ifndef DEFLATE_PROBE_THRESHOLD
+#  define DEFLATE_PROBE_THRESHOLD ((8 << 8) - 24)
+#endif
+/* Estimated bits per byte, with 8 fractional bits, at or above which probed input
+ * is treated as incompressible (7.9 by default). Define NO_DEFLATE_PROBE to disable.
+ */
+
 #define MAX_DIST(s)  ((s)->w_size - MIN_LOOKAHEAD)
 /* In order to simplify the code, particularly on 16 bit machines, match
  * distances are limited to MAX_DIST instead of WSIZE.
@@ -421,6 +476,7 @@ static inline unsigned int compute_w_bits(unsigned int w_size) {
 
 
 void Z_INTERNAL PREFIX(fill_window)(deflate_state *s);
+int32_t Z_INTERNAL PREFIX(deflate_reset_warm)(PREFIX3(stream) *strm);
 void Z_INTERNAL slide_hash_c(deflate_state *s);
 
         /* in trees.c */
@@ -429,6 +485,8 @@ void Z_INTERNAL zng_tr_flush_block(deflate_state *s, char *buf, uint32_t stored_
 void Z_INTERNAL zng_tr_flush_bits(deflate_state *s);
 void Z_INTERNAL zng_tr_align(deflate_state *s);
 void Z_INTERNAL zng_tr_stored_block(deflate_state *s, char *buf, uint32_t stored_len, int last);
+int  Z_INTERNAL zng_tr_split_check(deflate_state *s);
+void Z_INTERNAL zng_tr_estimate_block(deflate_state *s, uint32_t *dyn_bits, uint32_t *tree_bits, uint32_t *static_bits);
 void Z_INTERNAL PREFIX(flush_pending)(PREFIX3(streamp) strm);
 #define d_code(dist) ((dist) < 256 ? zng_dist_code[dist] : zng_dist_code[256+((dist)>>7)])
 /* Mapping from a distance to a distance code. dist is the distance - 1 and
@@ -449,6 +507,13 @@ void Z_INTERNAL PREFIX(flush_pending)(PREFIX3(streamp) strm);
 #  define sent_bits_align(s)
 #endif
 
+/* Counters for deflateGetStats(), only kept if WITH_DEFLATE_STATS is defined */
+#ifdef WITH_DEFLATE_STATS
+#  define stats_add(s, field, n)    s->stats.field += (n)
+#else
+#  define stats_add(s, field, n)
+#endif
+
 /* ===========================================================================
  *  Architecture-specific hooks.
  */
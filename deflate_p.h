@@ -60,6 +60,21 @@ Z_INTERNAL void PREFIX(flush_pending)(PREFIX3(stream) *strm);
 extern const unsigned char Z_INTERNAL zng_length_code[];
 extern const unsigned char Z_INTERNAL zng_dist_code[];
 
+/* Record one symbol observation for block splitting and return true if a block
+ * split check found that the statistics of the current block have shifted.
+ */
+Z_FORCEINLINE static int zng_tr_observe(deflate_state *s, unsigned int type) {
+#ifndef NO_BLOCK_SPLIT
+    s->split_new_obs[type]++;
+    if (UNLIKELY(++s->split_num_new == SPLIT_CHECK_INTERVAL))
+        return zng_tr_split_check(s);
+#else
+    Z_UNUSED(s);
+    Z_UNUSED(type);
+#endif
+    return 0;
+}
+
 static inline int zng_tr_tally_lit(deflate_state *s, unsigned char c) {
     /* c is the unmatched char */
 #ifdef LIT_MEM
@@ -73,7 +88,7 @@ static inline int zng_tr_tally_lit(deflate_state *s, unsigned char c) {
     s->dyn_ltree[c].Freq++;
     Tracevv((stderr, "%c", c));
     Assert(c <= (STD_MAX_MATCH-STD_MIN_MATCH), "zng_tr_tally: bad literal");
-    return (s->sym_next == s->sym_end);
+    return zng_tr_observe(s, ((c >> 5) & 6) | (c & 1)) | (s->sym_next == s->sym_end);
 }
 
 static inline int zng_tr_tally_dist(deflate_state* s, uint32_t dist, uint32_t len) {
@@ -96,7 +111,7 @@ static inline int zng_tr_tally_dist(deflate_state* s, uint32_t dist, uint32_t le
 
     s->dyn_ltree[zng_length_code[len] + LITERALS + 1].Freq++;
     s->dyn_dtree[d_code(dist)].Freq++;
-    return (s->sym_next == s->sym_end);
+    return zng_tr_observe(s, SPLIT_LIT_TYPES + (len >= 9 - STD_MIN_MATCH)) | (s->sym_next == s->sym_end);
 }
 
 /* =========================================================================
@@ -109,10 +124,13 @@ Z_FORCEINLINE static void flush_pending_inline(PREFIX3(stream) *strm) {
     uint32_t len;
     deflate_state *s = strm->state;
 
+    profile_start(s, Z_PROFILE_FLUSH_PENDING);
     zng_tr_flush_bits(s);
     len = MIN(s->pending, strm->avail_out);
-    if (len == 0)
+    if (len == 0) {
+        profile_stop(s, Z_PROFILE_FLUSH_PENDING);
         return;
+    }
 
     Tracev((stderr, "[FLUSH]"));
     memcpy(strm->next_out, s->pending_out, len);
@@ -123,6 +141,7 @@ Z_FORCEINLINE static void flush_pending_inline(PREFIX3(stream) *strm) {
     s->pending      -= len;
     if (s->pending == 0)
         s->pending_out = s->pending_buf;
+    profile_stop(s, Z_PROFILE_FLUSH_PENDING);
 }
 
 /* ===========================================================================
@@ -148,6 +167,7 @@ Z_FORCEINLINE static unsigned read_buf(PREFIX3(stream) *strm, unsigned char *buf
     if (len == 0)
         return 0;
 
+    profile_start(s, Z_PROFILE_READ_BUF);
     if (!DEFLATE_NEED_CHECKSUM(strm)) {
         memcpy(buf, strm->next_in, len);
 #ifdef GZIP
@@ -159,6 +179,7 @@ Z_FORCEINLINE static unsigned read_buf(PREFIX3(stream) *strm, unsigned char *buf
     } else {
         memcpy(buf, strm->next_in, len);
     }
+    profile_stop(s, Z_PROFILE_READ_BUF);
 
     strm->avail_in -= len;
     strm->next_in  += len;
@@ -189,6 +210,15 @@ Z_FORCEINLINE static unsigned read_buf(PREFIX3(stream) *strm, unsigned char *buf
 /* Maximum stored block length in deflate format (not including header). */
 #define MAX_STORED 65535
 
+/* Probe for incompressible input once per DEFLATE_PROBE_SIZE bytes of lookahead. */
+#ifndef NO_DEFLATE_PROBE
+#  define DEFLATE_PROBE_DUE(s) ((s)->strstart >= (s)->probe_next && (s)->lookahead >= DEFLATE_PROBE_SIZE)
+#else
+#  define DEFLATE_PROBE_DUE(s) 0
+#endif
+
+Z_INTERNAL int deflate_stored_probe(deflate_state *s);
+
 /* Compression function. Returns the block state after the call. */
 typedef block_state (*compress_func) (deflate_state *s, int flush);
 /* Match function. Returns the longest match. */
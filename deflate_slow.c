@@ -46,6 +46,15 @@ Z_INTERNAL block_state deflate_slow(deflate_state *s, int flush) {
                 break; /* flush the current block */
         }
 
+        /* Store incompressible input without searching for matches, unless a
+         * match from the previous step is still waiting to be evaluated.
+         */
+        if (UNLIKELY(DEFLATE_PROBE_DUE(s)) && s->prev_length < STD_MIN_MATCH && deflate_stored_probe(s)) {
+            if (s->strm->avail_out == 0)
+                return need_more;
+            continue;
+        }
+
         /* Insert the string window[strstart .. strstart+2] in the
          * dictionary, and set hash_head to the head of the hash chain:
          */
@@ -68,7 +77,9 @@ Z_INTERNAL block_state deflate_slow(deflate_state *s, int flush) {
              * of window index 0 (in particular we have to avoid a match
              * of the string with itself at the start of the input file).
              */
+            profile_start(s, Z_PROFILE_LONGEST_MATCH);
             match_len = longest_match(s, hash_head);
+            profile_stop(s, Z_PROFILE_LONGEST_MATCH);
             /* longest_match() sets match_start */
 
             if (match_len <= 5 && (s->strategy == Z_FILTERED)) {
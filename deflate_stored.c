@@ -8,6 +8,7 @@
 #include "deflate.h"
 #include "deflate_p.h"
 #include "functable.h"
+#include "insert_string_p.h"
 
 /* ===========================================================================
  * Copy without compression as much as possible from the input stream, return
@@ -123,6 +124,8 @@ Z_INTERNAL block_state deflate_stored(deflate_state *s, int flush) {
                 /* Slide the window down. */
                 s->strstart -= w_size;
                 memcpy(s->window, s->window + w_size, s->strstart);
+                stats_add(s, window_slides, 1);
+                zprobe2(deflate_slide, s->strm, s->strm->total_in);
                 if (s->matches < 2)
                     s->matches++;   /* add a pending slide_hash() */
                 s->insert = MIN(s->insert, s->strstart);
@@ -150,6 +153,8 @@ Z_INTERNAL block_state deflate_stored(deflate_state *s, int flush) {
         s->block_start -= (int)w_size;
         s->strstart -= w_size;
         memcpy(s->window, s->window + w_size, s->strstart);
+        stats_add(s, window_slides, 1);
+        zprobe2(deflate_slide, s->strm, s->strm->total_in);
         if (s->matches < 2)
             s->matches++;           /* add a pending slide_hash() */
         have += w_size;          /* more space now */
@@ -185,3 +190,129 @@ Z_INTERNAL block_state deflate_stored(deflate_state *s, int flush) {
     /* We've done all we can with the available input and output. */
     return last ? finish_started : need_more;
 }
+
+/* Samples spread over a probed chunk looked up in the hash table, and bytes that have to be equal to take one as a
+ * repeat. The first STD_MAX_MATCH positions of the chunk are all looked up, as the strategies that skip inserting
+ * the inside of long matches still insert one position in every STD_MAX_MATCH.
+ */
+#define PROBE_SAMPLES   16
+#define PROBE_MATCH_LEN 32
+
+/* True if the string at p repeats input within match distance, found through
+ * the head of its hash chain and, if deep, the next entry.
+ */
+static inline int probe_repeat_at(deflate_state *s, uint32_t p, int deep) {
+    unsigned char *window = s->window;
+    uint32_t h, cand;
+
+    if (s->level >= 9)
+        h = update_hash_roll(update_hash_roll(window[p], window[p+1]), window[p+2]);
+    else
+        h = update_hash(0, Z_U32_FROM_LE(zng_memread_4(window + p)));
+    cand = s->head[h];
+    for (int i = 0; i <= deep && cand > 0 && cand < p && p - cand <= MAX_DIST(s); i++) {
+        if (memcmp(window + p, window + cand, PROBE_MATCH_LEN) == 0)
+            return 1;
+        cand = s->prev[cand & W_MASK(s)];
+    }
+    return 0;
+}
+
+/* ===========================================================================
+ * True if the DEFLATE_PROBE_SIZE bytes at str repeat input within match
+ * distance, as far as the hash chains tell. They cover the input before
+ * strstart and the run stored so far.
+ */
+static int probe_repeats(deflate_state *s, uint32_t str) {
+    for (uint32_t p = str; p < str + MIN(STD_MAX_MATCH, DEFLATE_PROBE_SIZE - PROBE_MATCH_LEN); p++) {
+        if (probe_repeat_at(s, p, 0))
+            return 1;
+    }
+    for (uint32_t p = str + DEFLATE_PROBE_SIZE / PROBE_SAMPLES; p < str + DEFLATE_PROBE_SIZE;
+         p += DEFLATE_PROBE_SIZE / PROBE_SAMPLES) {
+        if (probe_repeat_at(s, p, 1))
+            return 1;
+    }
+    return 0;
+}
+
+/* ===========================================================================
+ * Insert the count positions at str of a stored run into the hash chains, so
+ * that later input can still match it.
+ */
+static void probe_insert(deflate_state *s, uint32_t str, uint32_t count) {
+    count = MIN(count, s->strstart + s->lookahead - (STD_MIN_MATCH - 1) - str);
+    if (s->level >= 9) {
+        s->ins_h = update_hash_roll(s->window[str], s->window[str+1]);
+        insert_string_roll(s, str, count);
+    } else {
+        insert_string(s, str, count);
+    }
+}
+
+/* ===========================================================================
+ * Classify the lookahead at strstart with the entropy probe and copy a run of
+ * incompressible input straight into stored blocks, skipping the match search
+ * for data that would not compress anyway. Input that has high entropy but
+ * repeats earlier input within the window is left to the match search. Used by
+ * the fast, medium and slow strategies once DEFLATE_PROBE_DUE() holds.
+ *
+ * Returns 1 if the current block was ended, in which case the caller must drop
+ * any match lookahead of its own and return need_more if avail_out is 0.
+ */
+Z_INTERNAL int deflate_stored_probe(deflate_state *s) {
+    unsigned char *window = s->window;
+    unsigned run, limit;
+    int compressible = 0;
+
+    if (FUNCTABLE_CALL(entropy_probe)(window + s->strstart, DEFLATE_PROBE_SIZE) < DEFLATE_PROBE_THRESHOLD ||
+        probe_repeats(s, s->strstart)) {
+        s->probe_next = s->strstart + DEFLATE_PROBE_SIZE;
+        return 0;
+    }
+
+    /* A pending lazy match candidate can only be a literal here, the caller
+     * does not probe while a previous match is still being evaluated.
+     */
+    if (s->match_available) {
+        Z_UNUSED(zng_tr_tally_lit(s, window[s->strstart-1]));
+        s->match_available = 0;
+    }
+    s->prev_length = 0;
+    if (s->sym_next)
+        FLUSH_BLOCK_ONLY(s, 0);
+    if (s->strm->avail_out == 0)
+        return 1;
+    Assert(s->block_start == (int)s->strstart, "block not flushed before stored run");
+
+    /* pending is empty since avail_out is not, the whole run has to fit in it
+     * with the block header, as its positions are inserted while it grows.
+     */
+    limit = MIN(MIN(s->lookahead, MAX_STORED), s->pending_buf_size - ((s->bi_valid + 42) >> 3));
+    run = MIN(DEFLATE_PROBE_SIZE, limit);
+    probe_insert(s, s->strstart, run);
+    while (run + DEFLATE_PROBE_SIZE <= limit) {
+        if (FUNCTABLE_CALL(entropy_probe)(window + s->strstart + run, DEFLATE_PROBE_SIZE) < DEFLATE_PROBE_THRESHOLD ||
+            probe_repeats(s, s->strstart + run)) {
+            compressible = 1;
+            break;
+        }
+        probe_insert(s, s->strstart + run, DEFLATE_PROBE_SIZE);
+        run += DEFLATE_PROBE_SIZE;
+    }
+
+    zng_tr_stored_block(s, (char *)window + s->strstart, run, 0);
+    s->strstart += run;
+    s->lookahead -= run;
+    s->block_start = (int)s->strstart;
+    PREFIX(flush_pending)(s->strm);
+
+    if (s->level >= 9)
+        s->ins_h = update_hash_roll(window[s->strstart], window[s->strstart+1]);
+
+    /* Resume probing right after the run, or after the chunk that ended it */
+    s->probe_next = s->strstart;
+    if (compressible)
+        s->probe_next += DEFLATE_PROBE_SIZE;
+    return 1;
+}
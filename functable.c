@@ -64,51 +64,212 @@ static int force_init_empty(void) {
     return 0;
 }
 
+/* Number and names of the functable entries, in the order of struct functable_s */
+#define FUNCTABLE_ENTRIES (sizeof(struct functable_s) / sizeof(functable.force_init))
+#define FUNCTABLE_INDEX(name) (offsetof(struct functable_s, name) / sizeof(functable.force_init))
+
+static const char * const functable_entries[FUNCTABLE_ENTRIES] = {
+    "force_init", "adler32", "adler32_copy", "adler32_multi", "chunkmemset_safe", "compare256", "crc32",
+    "crc32_combine_gen", "crc32_combine_op", "crc32_copy", "crc32_multi", "crc32c", "crc32c_copy", "crc64",
+    "crc64_copy", "deflate_medium", "deflate_quick", "entropy_probe", "inflate_fast", "inflate_table",
+    "longest_match", "longest_match_slow", "slide_hash"
+};
+
+/* Instruction set levels selection can be capped at, each with the features of the levels before it */
+#ifdef X86_FEATURES
+static const char * const dispatch_isa_levels[] = {
+    "sse2", "ssse3", "sse41", "sse42", "pclmulqdq", "avx2", "avx512", "avx512vnni", "vpclmulqdq"
+};
+#else
+static const char * const dispatch_isa_levels[] = { "" };
+#endif
+#define DISPATCH_ISA_LEVELS ((int)(sizeof(dispatch_isa_levels) / sizeof(dispatch_isa_levels[0])))
+
+/* Overrides of the selection, from zlibSetDispatch() or else the ZLIB_NG_DISPATCH environment variable */
+typedef struct dispatch_spec_s {
+    int isa;                                /* highest level of dispatch_isa_levels to use */
+    char pin[FUNCTABLE_ENTRIES][40];        /* variant each entry is pinned to, or empty */
+} dispatch_spec;
+
+static dispatch_spec dispatch_override;
+static int dispatch_overridden;
+
+/* Selected implementation of each entry, for zlibGetDispatch() */
+static const char *functable_names[FUNCTABLE_ENTRIES];
+static int dispatch_isa = DISPATCH_ISA_LEVELS - 1;
+
+/* Parses a comma or space separated list of isa=<level> and <entry>=<variant>, returns 1 if it is not valid */
+static int dispatch_parse(dispatch_spec *spec, const char *text) {
+    memset(spec, 0, sizeof(*spec));
+    spec->isa = DISPATCH_ISA_LEVELS - 1;
+    while (text != NULL && *text) {
+        size_t key_len, value_len, i;
+        const char *value;
+
+        if (*text == ',' || *text == ' ') {
+            text++;
+            continue;
+        }
+        key_len = strcspn(text, "=, ");
+        if (text[key_len] != '=')
+            return 1;
+        value = text + key_len + 1;
+        value_len = strcspn(value, ", ");
+        if (value_len == 0)
+            return 1;
+
+        if (key_len == 3 && !strncmp(text, "isa", 3)) {
+            for (i = 0; i < DISPATCH_ISA_LEVELS; i++) {
+                if (strlen(dispatch_isa_levels[i]) == value_len && !strncmp(value, dispatch_isa_levels[i], value_len))
+                    break;
+            }
+            if (i == DISPATCH_ISA_LEVELS)
+                return 1;
+            spec->isa = (int)i;
+        } else {
+            for (i = 1; i < FUNCTABLE_ENTRIES; i++) {
+                if (strlen(functable_entries[i]) == key_len && !strncmp(text, functable_entries[i], key_len))
+                    break;
+            }
+            if (i == FUNCTABLE_ENTRIES || value_len >= sizeof(spec->pin[i]))
+                return 1;
+            memcpy(spec->pin[i], value, value_len);
+            spec->pin[i][value_len] = 0;
+        }
+        text = value + value_len;
+    }
+    return 0;
+}
+
+/* Clears the features above the isa level, so selection never reaches the variants that need them */
+static void dispatch_cap(struct cpu_features *cf, int isa) {
+#ifdef X86_FEATURES
+    struct x86_cpu_features *x86 = &cf->x86;
+
+    if (isa < 1)
+        x86->has_ssse3 = 0;
+    if (isa < 2)
+        x86->has_sse41 = 0;
+    if (isa < 3)
+        x86->has_sse42 = 0;
+    if (isa < 4)
+        x86->has_pclmulqdq = 0;
+    if (isa < 5)
+        x86->has_avx2 = 0;
+    if (isa < 6)
+        x86->has_avx512f = x86->has_avx512dq = x86->has_avx512bw = x86->has_avx512vl = x86->has_avx512_common = 0;
+    if (isa < 7)
+        x86->has_avx512vnni = 0;
+    if (isa < 8)
+        x86->has_vpclmulqdq = 0;
+#else
+    Z_UNUSED(cf);
+    Z_UNUSED(isa);
+#endif
+}
+
+/* Decides whether func, the next candidate for entry in order of preference, replaces the one before it. Once the
+ * variant an entry is pinned to was picked, no later candidate replaces it. A pin matches the function name with
+ * or without the entry name and an underscore in front.
+ */
+static int dispatch_pick(const dispatch_spec *spec, const char **names, int *pinned, size_t idx, const char *entry,
+                         const char *func) {
+    const char *pin = spec->pin[idx];
+    size_t len = strlen(entry);
+
+    if (pinned[idx])
+        return 0;
+    if (*pin && (!strcmp(func, pin) || (!strncmp(func, entry, len) && func[len] == '_' && !strcmp(func + len + 1, pin))))
+        pinned[idx] = 1;
+    names[idx] = func;
+    return 1;
+}
+
+#define FUNCTABLE_SET(entry, func) \
+    do { \
+        if (dispatch_pick(&spec, names, pinned, FUNCTABLE_INDEX(entry), #entry, #func)) \
+            ft.entry = &func; \
+    } while (0)
+
 /* Functable initialization.
  * Selects the best available optimized functions appropriate for the runtime cpu.
  */
 static int init_functable(void) {
     struct functable_s ft;
     struct cpu_features cf;
+    const char *names[FUNCTABLE_ENTRIES] = { 0 };
+    int pinned[FUNCTABLE_ENTRIES] = { 0 };
+    dispatch_spec spec;
 
     memset(&ft, 0, sizeof(struct functable_s));
     cpu_check_features(&cf);
     ft.force_init = &force_init_empty;
 
+    /* An invalid ZLIB_NG_DISPATCH is ignored, as if it was not set */
+    if (dispatch_overridden)
+        spec = dispatch_override;
+    else if (dispatch_parse(&spec, getenv("ZLIB_NG_DISPATCH")))
+        dispatch_parse(&spec, NULL);
+    dispatch_cap(&cf, spec.isa);
+
     // Set up generic C code fallbacks
 #ifndef WITH_ALL_FALLBACKS
 #  if defined(ARCH_X86) && defined(ARCH_64BIT) && defined(X86_SSE2)
     // x86_64 always has SSE2, so we can use SSE2 functions as fallbacks where available.
-    ft.adler32 = &adler32_c;
-    ft.adler32_copy = &adler32_copy_c;
-    ft.crc32 = &crc32_braid;
-    ft.crc32_copy = &crc32_copy_braid;
+    FUNCTABLE_SET(adler32, adler32_c);
+    FUNCTABLE_SET(adler32_copy, adler32_copy_c);
+    FUNCTABLE_SET(adler32_multi, adler32_multi_c);
+    FUNCTABLE_SET(crc32, crc32_braid);
+    FUNCTABLE_SET(crc32_combine_gen, crc32_combine_gen_c);
+    FUNCTABLE_SET(crc32_combine_op, crc32_combine_op_c);
+    FUNCTABLE_SET(crc32_copy, crc32_copy_braid);
+    FUNCTABLE_SET(crc32_multi, crc32_multi_c);
+    FUNCTABLE_SET(crc32c, crc32c_c);
+    FUNCTABLE_SET(crc32c_copy, crc32c_copy_c);
+    FUNCTABLE_SET(crc64, crc64_c);
+    FUNCTABLE_SET(crc64_copy, crc64_copy_c);
+    FUNCTABLE_SET(inflate_table, inflate_table_c);
 #    ifndef HAVE_BUILTIN_CTZ
-    ft.longest_match = &longest_match_c;
-    ft.longest_match_slow = &longest_match_slow_c;
-    ft.compare256 = &compare256_c;
+    FUNCTABLE_SET(longest_match, longest_match_c);
+    FUNCTABLE_SET(longest_match_slow, longest_match_slow_c);
+    FUNCTABLE_SET(compare256, compare256_c);
 #    endif
 #  endif
 #else // WITH_ALL_FALLBACKS
-    ft.adler32 = &adler32_c;
-    ft.adler32_copy = &adler32_copy_c;
-    ft.chunkmemset_safe = &chunkmemset_safe_c;
-    ft.crc32 = &crc32_braid;
-    ft.crc32_copy = &crc32_copy_braid;
-    ft.inflate_fast = &inflate_fast_c;
-    ft.slide_hash = &slide_hash_c;
-    ft.longest_match = &longest_match_c;
-    ft.longest_match_slow = &longest_match_slow_c;
-    ft.compare256 = &compare256_c;
+    FUNCTABLE_SET(adler32, adler32_c);
+    FUNCTABLE_SET(adler32_copy, adler32_copy_c);
+    FUNCTABLE_SET(adler32_multi, adler32_multi_c);
+    FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_c);
+    FUNCTABLE_SET(crc32, crc32_braid);
+    FUNCTABLE_SET(crc32_combine_gen, crc32_combine_gen_c);
+    FUNCTABLE_SET(crc32_combine_op, crc32_combine_op_c);
+    FUNCTABLE_SET(crc32_copy, crc32_copy_braid);
+    FUNCTABLE_SET(crc32_multi, crc32_multi_c);
+    FUNCTABLE_SET(crc32c, crc32c_c);
+    FUNCTABLE_SET(crc32c_copy, crc32c_copy_c);
+    FUNCTABLE_SET(crc64, crc64_c);
+    FUNCTABLE_SET(crc64_copy, crc64_copy_c);
+    FUNCTABLE_SET(entropy_probe, entropy_probe_c);
+    FUNCTABLE_SET(inflate_fast, inflate_fast_c);
+    FUNCTABLE_SET(inflate_table, inflate_table_c);
+    FUNCTABLE_SET(slide_hash, slide_hash_c);
+    FUNCTABLE_SET(longest_match, longest_match_c);
+    FUNCTABLE_SET(longest_match_slow, longest_match_slow_c);
+    FUNCTABLE_SET(compare256, compare256_c);
 #endif
+    // Deflate strategies have no arch variant on most platforms, start from the generic ones everywhere
+#ifndef NO_MEDIUM_STRATEGY
+    FUNCTABLE_SET(deflate_medium, deflate_medium);
+#endif
+    FUNCTABLE_SET(deflate_quick, deflate_quick);
 
     // Select arch-optimized functions
 #ifdef WITH_OPTIM
 
     // Chorba generic C fallback
 #ifndef WITHOUT_CHORBA
-    ft.crc32 = &crc32_chorba;
-    ft.crc32_copy = &crc32_copy_chorba;
+    FUNCTABLE_SET(crc32, crc32_chorba);
+    FUNCTABLE_SET(crc32_copy, crc32_copy_chorba);
 #endif
 
     // X86 - SSE2
@@ -117,49 +278,60 @@ static int init_functable(void) {
     if (cf.x86.has_sse2)
 #  endif
     {
-        ft.chunkmemset_safe = &chunkmemset_safe_sse2;
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_sse2);
 #  if !defined(WITHOUT_CHORBA_SSE)
-        ft.crc32 = &crc32_chorba_sse2;
-        ft.crc32_copy = &crc32_copy_chorba_sse2;
+        FUNCTABLE_SET(crc32, crc32_chorba_sse2);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_chorba_sse2);
 #  endif
-        ft.inflate_fast = &inflate_fast_sse2;
-        ft.slide_hash = &slide_hash_sse2;
+        FUNCTABLE_SET(entropy_probe, entropy_probe_sse2);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_sse2);
+        FUNCTABLE_SET(slide_hash, slide_hash_sse2);
 #  ifdef HAVE_BUILTIN_CTZ
-        ft.compare256 = &compare256_sse2;
-        ft.longest_match = &longest_match_sse2;
-        ft.longest_match_slow = &longest_match_slow_sse2;
+        FUNCTABLE_SET(compare256, compare256_sse2);
+        FUNCTABLE_SET(longest_match, longest_match_sse2);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_sse2);
 #  endif
     }
 #endif
     // X86 - SSSE3
 #ifdef X86_SSSE3
     if (cf.x86.has_ssse3) {
-        ft.adler32 = &adler32_ssse3;
-        ft.adler32_copy = &adler32_copy_ssse3;
-        ft.chunkmemset_safe = &chunkmemset_safe_ssse3;
-        ft.inflate_fast = &inflate_fast_ssse3;
+        FUNCTABLE_SET(adler32, adler32_ssse3);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_ssse3);
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_ssse3);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_ssse3);
     }
 #endif
 
     // X86 - SSE4.1
-#if defined(X86_SSE41) && !defined(WITHOUT_CHORBA_SSE)
+#ifdef X86_SSE41
     if (cf.x86.has_sse41) {
-        ft.crc32 = &crc32_chorba_sse41;
-        ft.crc32_copy = &crc32_copy_chorba_sse41;
+        FUNCTABLE_SET(adler32_multi, adler32_multi_sse41);
+#  if !defined(WITHOUT_CHORBA_SSE)
+        FUNCTABLE_SET(crc32, crc32_chorba_sse41);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_chorba_sse41);
+#  endif
     }
 #endif
 
     // X86 - SSE4.2
 #ifdef X86_SSE42
     if (cf.x86.has_sse42) {
-        ft.adler32_copy = &adler32_copy_sse42;
+        FUNCTABLE_SET(adler32_copy, adler32_copy_sse42);
     }
 #endif
     // X86 - PCLMUL
 #ifdef X86_PCLMULQDQ_CRC
     if (cf.x86.has_pclmulqdq) {
-        ft.crc32 = &crc32_pclmulqdq;
-        ft.crc32_copy = &crc32_copy_pclmulqdq;
+        FUNCTABLE_SET(crc32, crc32_pclmulqdq);
+        FUNCTABLE_SET(crc32_combine_gen, crc32_combine_gen_pclmulqdq);
+        FUNCTABLE_SET(crc32_combine_op, crc32_combine_op_pclmulqdq);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_pclmulqdq);
+        FUNCTABLE_SET(crc32_multi, crc32_multi_pclmulqdq);
+        FUNCTABLE_SET(crc32c, crc32c_pclmulqdq);
+        FUNCTABLE_SET(crc32c_copy, crc32c_copy_pclmulqdq);
+        FUNCTABLE_SET(crc64, crc64_pclmulqdq);
+        FUNCTABLE_SET(crc64_copy, crc64_copy_pclmulqdq);
     }
 #endif
     // X86 - AVX
@@ -169,43 +341,54 @@ static int init_functable(void) {
      * for the shift results as an operand, eliminating several register-register moves when the original value needs
      * to remain intact. They also allow for a count operand that isn't the CL register, avoiding contention there */
     if (cf.x86.has_avx2 && cf.x86.has_bmi2) {
-        ft.adler32 = &adler32_avx2;
-        ft.adler32_copy = &adler32_copy_avx2;
-        ft.chunkmemset_safe = &chunkmemset_safe_avx2;
-        ft.inflate_fast = &inflate_fast_avx2;
-        ft.slide_hash = &slide_hash_avx2;
+        FUNCTABLE_SET(adler32, adler32_avx2);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_avx2);
+        FUNCTABLE_SET(adler32_multi, adler32_multi_avx2);
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_avx2);
+        FUNCTABLE_SET(entropy_probe, entropy_probe_avx2);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_avx2);
+        FUNCTABLE_SET(inflate_table, inflate_table_avx2);
+        FUNCTABLE_SET(slide_hash, slide_hash_avx2);
 #  ifdef HAVE_BUILTIN_CTZ
-        ft.compare256 = &compare256_avx2;
-        ft.longest_match = &longest_match_avx2;
-        ft.longest_match_slow = &longest_match_slow_avx2;
+        FUNCTABLE_SET(compare256, compare256_avx2);
+        FUNCTABLE_SET(longest_match, longest_match_avx2);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_avx2);
+#    ifndef NO_MEDIUM_STRATEGY
+        FUNCTABLE_SET(deflate_medium, deflate_medium_avx2);
+#    endif
+        FUNCTABLE_SET(deflate_quick, deflate_quick_avx2);
 #  endif
     }
 #endif
     // X86 - AVX512 (F,DQ,BW,Vl)
 #ifdef X86_AVX512
     if (cf.x86.has_avx512_common) {
-        ft.adler32 = &adler32_avx512;
-        ft.adler32_copy = &adler32_copy_avx512;
-        ft.chunkmemset_safe = &chunkmemset_safe_avx512;
-        ft.inflate_fast = &inflate_fast_avx512;
+        FUNCTABLE_SET(adler32, adler32_avx512);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_avx512);
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_avx512);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_avx512);
 #  ifdef HAVE_BUILTIN_CTZLL
-        ft.compare256 = &compare256_avx512;
-        ft.longest_match = &longest_match_avx512;
-        ft.longest_match_slow = &longest_match_slow_avx512;
+        FUNCTABLE_SET(compare256, compare256_avx512);
+        FUNCTABLE_SET(longest_match, longest_match_avx512);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_avx512);
+#    ifndef NO_MEDIUM_STRATEGY
+        FUNCTABLE_SET(deflate_medium, deflate_medium_avx512);
+#    endif
+        FUNCTABLE_SET(deflate_quick, deflate_quick_avx512);
 #  endif
     }
 #endif
 #ifdef X86_AVX512VNNI
     if (cf.x86.has_avx512vnni) {
-        ft.adler32 = &adler32_avx512_vnni;
-        ft.adler32_copy = &adler32_copy_avx512_vnni;
+        FUNCTABLE_SET(adler32, adler32_avx512_vnni);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_avx512_vnni);
     }
 #endif
     // X86 - VPCLMULQDQ
 #ifdef X86_VPCLMULQDQ_CRC
     if (cf.x86.has_pclmulqdq && cf.x86.has_avx512_common && cf.x86.has_vpclmulqdq) {
-        ft.crc32 = &crc32_vpclmulqdq;
-        ft.crc32_copy = &crc32_copy_vpclmulqdq;
+        FUNCTABLE_SET(crc32, crc32_vpclmulqdq);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_vpclmulqdq);
     }
 #endif
 
@@ -216,7 +399,7 @@ static int init_functable(void) {
     if (cf.arm.has_simd)
 #  endif
     {
-        ft.slide_hash = &slide_hash_armv6;
+        FUNCTABLE_SET(slide_hash, slide_hash_armv6);
     }
 #endif
     // ARM - NEON
@@ -225,63 +408,63 @@ static int init_functable(void) {
     if (cf.arm.has_neon)
 #  endif
     {
-        ft.adler32 = &adler32_neon;
-        ft.adler32_copy = &adler32_copy_neon;
-        ft.chunkmemset_safe = &chunkmemset_safe_neon;
-        ft.inflate_fast = &inflate_fast_neon;
-        ft.slide_hash = &slide_hash_neon;
+        FUNCTABLE_SET(adler32, adler32_neon);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_neon);
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_neon);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_neon);
+        FUNCTABLE_SET(slide_hash, slide_hash_neon);
 #  ifdef HAVE_BUILTIN_CTZLL
-        ft.compare256 = &compare256_neon;
-        ft.longest_match = &longest_match_neon;
-        ft.longest_match_slow = &longest_match_slow_neon;
+        FUNCTABLE_SET(compare256, compare256_neon);
+        FUNCTABLE_SET(longest_match, longest_match_neon);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_neon);
 #  endif
     }
 #endif
     // ARM - CRC32
 #ifdef ARM_CRC32
     if (cf.arm.has_crc32) {
-        ft.crc32 = &crc32_armv8;
-        ft.crc32_copy = &crc32_copy_armv8;
+        FUNCTABLE_SET(crc32, crc32_armv8);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_armv8);
     }
 #endif
     // ARM - PMULL EOR3
 #ifdef ARM_PMULL_EOR3
     if (cf.arm.has_crc32 && cf.arm.has_pmull && cf.arm.has_eor3 && cf.arm.has_fast_pmull) {
-        ft.crc32 = &crc32_armv8_pmull_eor3;
-        ft.crc32_copy = &crc32_copy_armv8_pmull_eor3;
+        FUNCTABLE_SET(crc32, crc32_armv8_pmull_eor3);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_armv8_pmull_eor3);
     }
 #endif
 
     // Power - VMX
 #ifdef PPC_VMX
     if (cf.power.has_altivec) {
-        ft.adler32 = &adler32_vmx;
-        ft.adler32_copy = &adler32_copy_vmx;
-        ft.slide_hash = &slide_hash_vmx;
+        FUNCTABLE_SET(adler32, adler32_vmx);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_vmx);
+        FUNCTABLE_SET(slide_hash, slide_hash_vmx);
     }
 #endif
     // Power8 - VSX
 #ifdef POWER8_VSX
     if (cf.power.has_arch_2_07) {
-        ft.adler32 = &adler32_power8;
-        ft.adler32_copy = &adler32_copy_power8;
-        ft.chunkmemset_safe = &chunkmemset_safe_power8;
-        ft.inflate_fast = &inflate_fast_power8;
-        ft.slide_hash = &slide_hash_power8;
+        FUNCTABLE_SET(adler32, adler32_power8);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_power8);
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_power8);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_power8);
+        FUNCTABLE_SET(slide_hash, slide_hash_power8);
     }
 #endif
 #ifdef POWER8_VSX_CRC32
     if (cf.power.has_arch_2_07) {
-        ft.crc32 = &crc32_power8;
-        ft.crc32_copy = &crc32_copy_power8;
+        FUNCTABLE_SET(crc32, crc32_power8);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_power8);
     }
 #endif
     // Power9
 #ifdef POWER9
     if (cf.power.has_arch_3_00) {
-        ft.compare256 = &compare256_power9;
-        ft.longest_match = &longest_match_power9;
-        ft.longest_match_slow = &longest_match_slow_power9;
+        FUNCTABLE_SET(compare256, compare256_power9);
+        FUNCTABLE_SET(longest_match, longest_match_power9);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_power9);
     }
 #endif
 
@@ -289,66 +472,66 @@ static int init_functable(void) {
     // RISCV - RVV
 #ifdef RISCV_RVV
     if (cf.riscv.has_rvv) {
-        ft.adler32 = &adler32_rvv;
-        ft.adler32_copy = &adler32_copy_rvv;
-        ft.chunkmemset_safe = &chunkmemset_safe_rvv;
-        ft.compare256 = &compare256_rvv;
-        ft.inflate_fast = &inflate_fast_rvv;
-        ft.longest_match = &longest_match_rvv;
-        ft.longest_match_slow = &longest_match_slow_rvv;
-        ft.slide_hash = &slide_hash_rvv;
+        FUNCTABLE_SET(adler32, adler32_rvv);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_rvv);
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_rvv);
+        FUNCTABLE_SET(compare256, compare256_rvv);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_rvv);
+        FUNCTABLE_SET(longest_match, longest_match_rvv);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_rvv);
+        FUNCTABLE_SET(slide_hash, slide_hash_rvv);
     }
 #endif
 
     // RISCV - ZBC
 #ifdef RISCV_CRC32_ZBC
     if (cf.riscv.has_zbc) {
-        ft.crc32 = &crc32_riscv64_zbc;
-        ft.crc32_copy = &crc32_copy_riscv64_zbc;
+        FUNCTABLE_SET(crc32, crc32_riscv64_zbc);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_riscv64_zbc);
     }
 #endif
 
     // S390
 #ifdef S390_CRC32_VX
     if (cf.s390.has_vx) {
-        ft.crc32 = crc32_s390_vx;
-        ft.crc32_copy = crc32_copy_s390_vx;
+        FUNCTABLE_SET(crc32, crc32_s390_vx);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_s390_vx);
     }
 #endif
 
     // LOONGARCH
 #ifdef LOONGARCH_CRC
     if (cf.loongarch.has_crc) {
-        ft.crc32 = crc32_loongarch64;
-        ft.crc32_copy = crc32_copy_loongarch64;
+        FUNCTABLE_SET(crc32, crc32_loongarch64);
+        FUNCTABLE_SET(crc32_copy, crc32_copy_loongarch64);
     }
 #endif
 #ifdef LOONGARCH_LSX
     if (cf.loongarch.has_lsx) {
-        ft.adler32 = &adler32_lsx;
-        ft.adler32_copy = &adler32_copy_lsx;
-        ft.slide_hash = slide_hash_lsx;
+        FUNCTABLE_SET(adler32, adler32_lsx);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_lsx);
+        FUNCTABLE_SET(slide_hash, slide_hash_lsx);
 #  ifdef HAVE_BUILTIN_CTZ
-        ft.compare256 = &compare256_lsx;
-        ft.longest_match = &longest_match_lsx;
-        ft.longest_match_slow = &longest_match_slow_lsx;
+        FUNCTABLE_SET(compare256, compare256_lsx);
+        FUNCTABLE_SET(longest_match, longest_match_lsx);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_lsx);
 #  endif
-        ft.chunkmemset_safe = &chunkmemset_safe_lsx;
-        ft.inflate_fast = &inflate_fast_lsx;
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_lsx);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_lsx);
     }
 #endif
 #ifdef LOONGARCH_LASX
     if (cf.loongarch.has_lasx) {
-        ft.adler32 = &adler32_lasx;
-        ft.adler32_copy = &adler32_copy_lasx;
-        ft.slide_hash = slide_hash_lasx;
+        FUNCTABLE_SET(adler32, adler32_lasx);
+        FUNCTABLE_SET(adler32_copy, adler32_copy_lasx);
+        FUNCTABLE_SET(slide_hash, slide_hash_lasx);
 #  ifdef HAVE_BUILTIN_CTZ
-        ft.compare256 = &compare256_lasx;
-        ft.longest_match = &longest_match_lasx;
-        ft.longest_match_slow = &longest_match_slow_lasx;
+        FUNCTABLE_SET(compare256, compare256_lasx);
+        FUNCTABLE_SET(longest_match, longest_match_lasx);
+        FUNCTABLE_SET(longest_match_slow, longest_match_slow_lasx);
 #  endif
-        ft.chunkmemset_safe = &chunkmemset_safe_lasx;
-        ft.inflate_fast = &inflate_fast_lasx;
+        FUNCTABLE_SET(chunkmemset_safe, chunkmemset_safe_lasx);
+        FUNCTABLE_SET(inflate_fast, inflate_fast_lasx);
     }
 #endif
 
@@ -358,11 +541,25 @@ static int init_functable(void) {
     FUNCTABLE_ASSIGN(ft, force_init);
     FUNCTABLE_VERIFY_ASSIGN(ft, adler32);
     FUNCTABLE_VERIFY_ASSIGN(ft, adler32_copy);
+    FUNCTABLE_VERIFY_ASSIGN(ft, adler32_multi);
     FUNCTABLE_VERIFY_ASSIGN(ft, chunkmemset_safe);
     FUNCTABLE_VERIFY_ASSIGN(ft, compare256);
     FUNCTABLE_VERIFY_ASSIGN(ft, crc32);
+    FUNCTABLE_VERIFY_ASSIGN(ft, crc32_combine_gen);
+    FUNCTABLE_VERIFY_ASSIGN(ft, crc32_combine_op);
     FUNCTABLE_VERIFY_ASSIGN(ft, crc32_copy);
+    FUNCTABLE_VERIFY_ASSIGN(ft, crc32_multi);
+    FUNCTABLE_VERIFY_ASSIGN(ft, crc32c);
+    FUNCTABLE_VERIFY_ASSIGN(ft, crc32c_copy);
+    FUNCTABLE_VERIFY_ASSIGN(ft, crc64);
+    FUNCTABLE_VERIFY_ASSIGN(ft, crc64_copy);
+#ifndef NO_MEDIUM_STRATEGY
+    FUNCTABLE_VERIFY_ASSIGN(ft, deflate_medium);
+#endif
+    FUNCTABLE_VERIFY_ASSIGN(ft, deflate_quick);
+    FUNCTABLE_VERIFY_ASSIGN(ft, entropy_probe);
     FUNCTABLE_VERIFY_ASSIGN(ft, inflate_fast);
+    FUNCTABLE_VERIFY_ASSIGN(ft, inflate_table);
     FUNCTABLE_VERIFY_ASSIGN(ft, longest_match);
     FUNCTABLE_VERIFY_ASSIGN(ft, longest_match_slow);
     FUNCTABLE_VERIFY_ASSIGN(ft, slide_hash);
@@ -370,6 +567,8 @@ static int init_functable(void) {
     // Memory barrier for weak memory order CPUs
     FUNCTABLE_BARRIER();
 
+    memcpy(functable_names, names, sizeof(names));
+    dispatch_isa = spec.isa;
     return Z_OK;
 }
 
@@ -388,6 +587,11 @@ static uint32_t adler32_copy_stub(uint32_t adler, uint8_t* dst, const uint8_t* s
     return functable.adler32_copy(adler, dst, src, len);
 }
 
+static void adler32_multi_stub(uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count) {
+    FUNCTABLE_INIT_ABORT;
+    functable.adler32_multi(adler, buf, len, count);
+}
+
 static uint8_t* chunkmemset_safe_stub(uint8_t* out, uint8_t *from, unsigned len, unsigned left) {
     FUNCTABLE_INIT_ABORT;
     return functable.chunkmemset_safe(out, from, len, left);
@@ -403,16 +607,72 @@ static uint32_t crc32_stub(uint32_t crc, const uint8_t* buf, size_t len) {
     return functable.crc32(crc, buf, len);
 }
 
+static void crc32_combine_gen_stub(uint32_t *op, const z_off64_t *len2, size_t count) {
+    FUNCTABLE_INIT_ABORT;
+    functable.crc32_combine_gen(op, len2, count);
+}
+
+static uint32_t crc32_combine_op_stub(uint32_t crc1, uint32_t crc2, const uint32_t op) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.crc32_combine_op(crc1, crc2, op);
+}
+
 static uint32_t crc32_copy_stub(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len) {
     FUNCTABLE_INIT_ABORT;
     return functable.crc32_copy(crc, dst, src, len);
 }
 
+static void crc32_multi_stub(uint32_t *crc, const uint8_t * const *buf, const size_t *len, size_t count) {
+    FUNCTABLE_INIT_ABORT;
+    functable.crc32_multi(crc, buf, len, count);
+}
+
+static uint32_t crc32c_stub(uint32_t crc, const uint8_t *buf, size_t len) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.crc32c(crc, buf, len);
+}
+
+static uint32_t crc32c_copy_stub(uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.crc32c_copy(crc, dst, src, len);
+}
+
+static uint64_t crc64_stub(uint64_t crc, const uint8_t *buf, size_t len) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.crc64(crc, buf, len);
+}
+
+static uint64_t crc64_copy_stub(uint64_t crc, uint8_t *dst, const uint8_t *src, size_t len) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.crc64_copy(crc, dst, src, len);
+}
+
+static block_state deflate_medium_stub(deflate_state *s, int flush) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.deflate_medium(s, flush);
+}
+
+static block_state deflate_quick_stub(deflate_state *s, int flush) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.deflate_quick(s, flush);
+}
+
+static uint32_t entropy_probe_stub(const uint8_t *buf, size_t len) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.entropy_probe(buf, len);
+}
+
 static void inflate_fast_stub(PREFIX3(stream) *strm, uint32_t start) {
     FUNCTABLE_INIT_ABORT;
     functable.inflate_fast(strm, start);
 }
 
+static int inflate_table_stub(codetype type, uint16_t *lens, unsigned codes, code **table, unsigned *bits,
+                              uint16_t *work) {
+    FUNCTABLE_INIT_ABORT;
+    return functable.inflate_table(type, lens, codes, table, bits, work);
+}
+
 static uint32_t longest_match_stub(deflate_state* const s, uint32_t cur_match) {
     FUNCTABLE_INIT_ABORT;
     return functable.longest_match(s, cur_match);
@@ -433,14 +693,94 @@ Z_INTERNAL struct functable_s functable = {
     force_init_stub,
     adler32_stub,
     adler32_copy_stub,
+    adler32_multi_stub,
     chunkmemset_safe_stub,
     compare256_stub,
     crc32_stub,
+    crc32_combine_gen_stub,
+    crc32_combine_op_stub,
     crc32_copy_stub,
+    crc32_multi_stub,
+    crc32c_stub,
+    crc32c_copy_stub,
+    crc64_stub,
+    crc64_copy_stub,
+    deflate_medium_stub,
+    deflate_quick_stub,
+    entropy_probe_stub,
     inflate_fast_stub,
+    inflate_table_stub,
     longest_match_stub,
     longest_match_slow_stub,
     slide_hash_stub,
 };
 
+/* Appends to buf as far as it goes, counting the whole length */
+#define DISPATCH_PRINT(...) \
+    do { \
+        int n = snprintf(len < size ? buf + len : NULL, len < size ? size - len : 0, __VA_ARGS__); \
+        if (n > 0) \
+            len += (size_t)n; \
+    } while (0)
+
+int32_t Z_EXPORT PREFIX(zlibSetDispatch)(const char *spec) {
+    dispatch_spec parsed;
+
+    if (dispatch_parse(&parsed, spec))
+        return Z_STREAM_ERROR;
+    dispatch_override = parsed;
+    dispatch_overridden = spec != NULL;
+    return init_functable() ? Z_VERSION_ERROR : Z_OK;
+}
+
+int32_t Z_EXPORT PREFIX(zlibGetDispatch)(char *buf, size_t size) {
+    struct cpu_features cf;
+    size_t len = 0;
+
+    if (functable.force_init())
+        return -1;
+    if (size)
+        buf[0] = 0;
+
+    cpu_check_features(&cf);
+    DISPATCH_PRINT("features:");
+#ifdef X86_FEATURES
+    {
+        const struct x86_cpu_features *x86 = &cf.x86;
+        const char * const names[] = { "sse2", "ssse3", "sse41", "sse42", "pclmulqdq", "avx2", "bmi2", "avx512",
+                                       "avx512vnni", "vpclmulqdq" };
+        const int has[] = { x86->has_sse2, x86->has_ssse3, x86->has_sse41, x86->has_sse42, x86->has_pclmulqdq,
+                            x86->has_avx2, x86->has_bmi2, x86->has_avx512_common, x86->has_avx512vnni,
+                            x86->has_vpclmulqdq };
+
+        for (size_t i = 0; i < sizeof(has) / sizeof(has[0]); i++) {
+            if (has[i])
+                DISPATCH_PRINT(" %s", names[i]);
+        }
+    }
+#else
+    Z_UNUSED(cf);
+#endif
+    DISPATCH_PRINT("\n");
+    if (dispatch_isa != DISPATCH_ISA_LEVELS - 1)
+        DISPATCH_PRINT("isa: %s\n", dispatch_isa_levels[dispatch_isa]);
+    for (size_t i = 1; i < FUNCTABLE_ENTRIES; i++)
+        DISPATCH_PRINT("%s: %s\n", functable_entries[i], functable_names[i] ? functable_names[i] : "");
+    return (int32_t)len;
+}
+
+#else
+
+#include "zbuild.h"
+#include "zutil.h"
+
+int32_t Z_EXPORT PREFIX(zlibSetDispatch)(const char *spec) {
+    Z_UNUSED(spec);
+    return Z_VERSION_ERROR;
+}
+
+int32_t Z_EXPORT PREFIX(zlibGetDispatch)(char *buf, size_t size) {
+    return snprintf(buf, size, "features: native\n");
+}
+
 #endif
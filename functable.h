@@ -8,6 +8,7 @@
 
 #include "deflate.h"
 #include "crc32.h"
+#include "inftrees.h"
 
 #ifdef DISABLE_RUNTIME_CPU_DETECTION
 
@@ -27,11 +28,24 @@ struct functable_s {
     int      (* force_init)         (void);
     uint32_t (* adler32)            (uint32_t adler, const uint8_t *buf, size_t len);
     uint32_t (* adler32_copy)       (uint32_t adler, uint8_t *dst, const uint8_t *src, size_t len);
+    void     (* adler32_multi)      (uint32_t *adler, const uint8_t * const *buf, const size_t *len, size_t count);
     uint8_t* (* chunkmemset_safe)   (uint8_t *out, uint8_t *from, unsigned len, unsigned left);
     uint32_t (* compare256)         (const uint8_t *src0, const uint8_t *src1);
     uint32_t (* crc32)              (uint32_t crc, const uint8_t *buf, size_t len);
+    void     (* crc32_combine_gen)  (uint32_t *op, const z_off64_t *len2, size_t count);
+    uint32_t (* crc32_combine_op)   (uint32_t crc1, uint32_t crc2, const uint32_t op);
     uint32_t (* crc32_copy)         (uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+    void     (* crc32_multi)        (uint32_t *crc, const uint8_t * const *buf, const size_t *len, size_t count);
+    uint32_t (* crc32c)             (uint32_t crc, const uint8_t *buf, size_t len);
+    uint32_t (* crc32c_copy)        (uint32_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+    uint64_t (* crc64)              (uint64_t crc, const uint8_t *buf, size_t len);
+    uint64_t (* crc64_copy)         (uint64_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+    block_state (* deflate_medium)  (deflate_state *s, int flush);
+    block_state (* deflate_quick)   (deflate_state *s, int flush);
+    uint32_t (* entropy_probe)      (const uint8_t *buf, size_t len);
     void     (* inflate_fast)       (PREFIX3(stream) *strm, uint32_t start);
+    int      (* inflate_table)      (codetype type, uint16_t *lens, unsigned codes, code **table, unsigned *bits,
+                                     uint16_t *work);
     uint32_t (* longest_match)      (deflate_state *const s, uint32_t cur_match);
     uint32_t (* longest_match_slow) (deflate_state *const s, uint32_t cur_match);
     void     (* slide_hash)         (deflate_state *s);
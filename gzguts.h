@@ -32,6 +32,7 @@
 #else
 #  include "zlib-ng.h"
 #endif
+#include "zprobe.h"
 
 #ifdef _WIN32
 #  include <stddef.h>
@@ -113,6 +114,7 @@ typedef struct {
     unsigned char *in;      /* input buffer (double-sized when writing) */
     unsigned char *out;     /* output buffer (double-sized when reading) */
     unsigned char *buffers; /* Pointer to the real input/output buffer allocation */
+    size_t taken;           /* bytes of buffers counted in zlibGetMemory() */
     int direct;             /* 0 if processing gzip, 1 if transparent */
         /* just for reading */
     int how;                /* 0: get header, 1: copy, 2: decompress */
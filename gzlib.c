@@ -80,7 +80,14 @@ int Z_INTERNAL gz_buffer_alloc(gz_state *state) {
         out_size = want * 2;  // double output buffer for decompression
     }
 
-    state->buffers = (unsigned char *)zng_alloc_aligned((in_size + out_size), 64);
+    /* Check the budget before allocating, counting what zng_alloc_aligned() adds for alignment */
+    state->taken = sizeof(void *) + (size_t)(in_size + out_size) + 64;
+    if (zng_mem_take(state->taken) == 0) {
+        state->buffers = (unsigned char *)zng_alloc_aligned((in_size + out_size), 64);
+    } else {
+        state->taken = 0;
+        state->buffers = NULL;
+    }
     state->in = state->buffers;
     if (out_size) {
         state->out = state->buffers + (in_size); // Outbuffer goes after inbuffer
@@ -98,8 +105,10 @@ int Z_INTERNAL gz_buffer_alloc(gz_state *state) {
 }
 
 void Z_INTERNAL gz_buffer_free(gz_state *state) {
+    zng_mem_give(state->taken);
     zng_free_aligned(state->buffers);
     state->buffers = NULL;
+    state->taken = 0;
     state->out = NULL;
     state->in = NULL;
     state->size = 0;
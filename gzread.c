@@ -90,6 +90,7 @@ static int gz_avail(gz_state *state) {
             return -1;
         strm->avail_in += got;
         strm->next_in = state->in;
+        zprobe3(gz_refill, state->fd, got, strm->avail_in);
     }
     return 0;
 }
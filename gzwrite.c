@@ -96,6 +96,7 @@ static int gz_comp(gz_state *state, int flush) {
                 PREFIX(gz_error)(state, Z_ERRNO, zstrerror());
                 return -1;
             }
+            zprobe3(gz_flush, state->fd, have, flush);
             if (strm->avail_out == 0) {
                 strm->avail_out = state->size;
                 strm->next_out = state->out;
@@ -44,7 +44,7 @@ int32_t ZNG_CONDEXPORT PREFIX(inflateBackInit)(PREFIX3(stream) *strm, int32_t wi
     if (strm->zfree == NULL)
         strm->zfree = PREFIX(zcfree);
 
-    inflate_allocs *alloc_bufs = alloc_inflate(strm);
+    inflate_allocs *alloc_bufs = alloc_inflate(strm, 1, NULL, NULL); /* the caller supplies the window */
     if (alloc_bufs == NULL)
         return Z_MEM_ERROR;
 
@@ -59,6 +59,9 @@ int32_t ZNG_CONDEXPORT PREFIX(inflateBackInit)(PREFIX3(stream) *strm, int32_t wi
     state->window = window;
     state->wnext = 0;
     state->whave = 0;
+    state->windowless = 0;
+    state->ohave = 0;
+    state->verify = 0;
 #ifdef INFLATE_STRICT
     state->dmax = 32768U;
 #endif
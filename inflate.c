@@ -5,11 +5,14 @@
 
 #include "zbuild.h"
 #include "zutil.h"
+#include "zutil_p.h"
+#include "zatomic.h"
 #include "inftrees.h"
 #include "inflate.h"
 #include "inflate_p.h"
 #include "inffixed_tbl.h"
 #include "functable.h"
+#include "zclock.h"
 
 /* Avoid conflicts with zlib.h macros */
 #ifdef ZLIB_COMPAT
@@ -26,6 +29,7 @@ static inline void inf_chksum_cpy(PREFIX3(stream) *strm, uint8_t *dst,
                            const uint8_t *src, uint32_t copy) {
     if (!copy) return;
     struct inflate_state *state = (struct inflate_state*)strm->state;
+    profile_start(state, Z_PROFILE_INFLATE_CHECK);
 #ifdef GUNZIP
     if (state->flags) {
         strm->adler = state->check = FUNCTABLE_CALL(crc32_copy)(state->check, dst, src, copy);
@@ -34,10 +38,12 @@ static inline void inf_chksum_cpy(PREFIX3(stream) *strm, uint8_t *dst,
     {
         strm->adler = state->check = FUNCTABLE_CALL(adler32_copy)(state->check, dst, src, copy);
     }
+    profile_stop(state, Z_PROFILE_INFLATE_CHECK);
 }
 
 static inline void inf_chksum(PREFIX3(stream) *strm, const uint8_t *src, uint32_t len) {
     struct inflate_state *state = (struct inflate_state*)strm->state;
+    profile_start(state, Z_PROFILE_INFLATE_CHECK);
 #ifdef GUNZIP
     if (state->flags) {
         strm->adler = state->check = FUNCTABLE_CALL(crc32)(state->check, src, len);
@@ -46,6 +52,7 @@ static inline void inf_chksum(PREFIX3(stream) *strm, const uint8_t *src, uint32_
     {
         strm->adler = state->check = FUNCTABLE_CALL(adler32)(state->check, src, len);
     }
+    profile_stop(state, Z_PROFILE_INFLATE_CHECK);
 }
 
 static int inflateStateCheck(PREFIX3(stream) *strm) {
@@ -65,6 +72,7 @@ int32_t Z_EXPORT PREFIX(inflateResetKeep)(PREFIX3(stream) *strm) {
         return Z_STREAM_ERROR;
     state = (struct inflate_state *)strm->state;
     strm->total_in = strm->total_out = state->total = 0;
+    state->total_in64 = state->total_out64 = 0;
     strm->msg = NULL;
     if (state->wrap)        /* to support ill-conceived Java test suite */
         strm->adler = state->wrap & 1;
@@ -78,6 +86,7 @@ int32_t Z_EXPORT PREFIX(inflateResetKeep)(PREFIX3(stream) *strm) {
     state->bits = 0;
     state->lencode = state->distcode = state->next = state->codes;
     state->back = -1;
+    state->ohave = 0;
 #ifdef INFLATE_STRICT
     state->dmax = 32768U;
 #endif
@@ -148,12 +157,15 @@ int32_t Z_EXPORT PREFIX(inflateReset2)(PREFIX3(stream) *strm, int32_t windowBits
 /* ===========================================================================
  * Allocate a big buffer and divide it up into the various buffers inflate needs.
  * Handles alignment of allocated buffer and alignment of individual buffers.
+ * If work_size is not NULL, the buffer is work instead, which must be at least
+ * *work_size bytes long, and zalloc is not called. If work is NULL as well, only
+ * the size needed is stored in *work_size.
  */
-Z_INTERNAL inflate_allocs* alloc_inflate(PREFIX3(stream) *strm) {
+Z_INTERNAL inflate_allocs* alloc_inflate(PREFIX3(stream) *strm, int windowless, void *work, size_t *work_size) {
     int curr_size = 0;
 
     /* Define sizes */
-    int window_size = INFLATE_ADJUST_WINDOW_SIZE((1 << MAX_WBITS) + 64); /* 64B padding for chunksize */
+    int window_size = windowless ? 0 : INFLATE_ADJUST_WINDOW_SIZE((1 << MAX_WBITS) + 64); /* 64B padding for chunksize */
     int state_size = sizeof(inflate_state);
     int alloc_size = sizeof(inflate_allocs);
 
@@ -173,27 +185,43 @@ Z_INTERNAL inflate_allocs* alloc_inflate(PREFIX3(stream) *strm) {
     /* Add 64-1 or 4096-1 to allow window alignment, and round size of buffer up to multiple of 64 */
     int total_size = PAD_64(curr_size + (WINDOW_PAD_SIZE - 1));
 
-    /* Allocate buffer, align to 64-byte cacheline, and zerofill the resulting buffer */
-    char *original_buf = (char *)strm->zalloc(strm->opaque, 1, total_size);
-    if (original_buf == NULL)
-        return NULL;
+    /* Allocate buffer or take the workspace, align to 64-byte cacheline, and zerofill the resulting buffer */
+    char *original_buf;
+    if (work_size != NULL) {
+        if (work == NULL)
+            *work_size = (size_t)total_size;
+        if (work == NULL || *work_size < (size_t)total_size)
+            return NULL;
+        original_buf = (char *)work;
+    } else {
+        /* Check the budget before allocating */
+        if (zng_mem_take((size_t)total_size))
+            return NULL;
+        original_buf = (char *)strm->zalloc(strm->opaque, 1, total_size);
+        if (original_buf == NULL) {
+            zng_mem_give((size_t)total_size);
+            return NULL;
+        }
+    }
 
     char *buff = (char *)HINT_ALIGNED_WINDOW((char *)PAD_WINDOW(original_buf));
     LOGSZPL("Buffer alloc", total_size, PADSZ((uintptr_t)original_buf,WINDOW_PAD_SIZE), PADSZ(curr_size,WINDOW_PAD_SIZE));
 
-    /* Initialize alloc_bufs */
+    /* Initialize alloc_bufs, a workspace is not freed */
     inflate_allocs *alloc_bufs  = (struct inflate_allocs_s *)(buff + alloc_pos);
     alloc_bufs->buf_start = original_buf;
-    alloc_bufs->zfree = strm->zfree;
+    alloc_bufs->zfree = work_size != NULL ? NULL : strm->zfree;
+    alloc_bufs->size = work_size != NULL ? 0 : (size_t)total_size;
 
-    alloc_bufs->window =  (unsigned char *)HINT_ALIGNED_WINDOW((buff + window_pos));
+    alloc_bufs->window = windowless ? NULL : (unsigned char *)HINT_ALIGNED_WINDOW((buff + window_pos));
     alloc_bufs->state = (inflate_state *)HINT_ALIGNED_64((buff + state_pos));
 
 #ifdef Z_MEMORY_SANITIZER
     /* This is _not_ to subvert the memory sanitizer but to instead unposion some
        data we willingly and purposefully load uninitialized into vector registers
        in order to safely read the last < chunksize bytes of the window. */
-    __msan_unpoison(alloc_bufs->window + window_size, 64);
+    if (!windowless)
+        __msan_unpoison(alloc_bufs->window + window_size, 64);
 #endif
 
     return alloc_bufs;
@@ -207,16 +235,18 @@ Z_INTERNAL void free_inflate(PREFIX3(stream) *strm) {
 
     if (state->alloc_bufs != NULL) {
         inflate_allocs *alloc_bufs = state->alloc_bufs;
-        alloc_bufs->zfree(strm->opaque, alloc_bufs->buf_start);
+        if (alloc_bufs->zfree != NULL) {
+            zng_mem_give(alloc_bufs->size);
+            alloc_bufs->zfree(strm->opaque, alloc_bufs->buf_start);
+        }
         strm->state = NULL;
     }
 }
 
 /* ===========================================================================
- * Initialize inflate state and buffers.
- * This function is hidden in ZLIB_COMPAT builds.
+ * Initialize inflate state and buffers, without a sliding window if windowless, in work if work_size is not NULL.
  */
-int32_t ZNG_CONDEXPORT PREFIX(inflateInit2)(PREFIX3(stream) *strm, int32_t windowBits) {
+static int32_t inflate_init(PREFIX3(stream) *strm, int32_t windowBits, int windowless, void *work, size_t *work_size) {
     struct inflate_state *state;
     int32_t ret;
 
@@ -233,14 +263,23 @@ int32_t ZNG_CONDEXPORT PREFIX(inflateInit2)(PREFIX3(stream) *strm, int32_t windo
     if (strm->zfree == NULL)
         strm->zfree = PREFIX(zcfree);
 
-    inflate_allocs *alloc_bufs = alloc_inflate(strm);
+    inflate_allocs *alloc_bufs = alloc_inflate(strm, windowless, work, work_size);
     if (alloc_bufs == NULL)
         return Z_MEM_ERROR;
 
     state = alloc_bufs->state;
     state->window = alloc_bufs->window;
     state->alloc_bufs = alloc_bufs;
-    state->wbufsize = INFLATE_ADJUST_WINDOW_SIZE((1 << MAX_WBITS) + 64);
+    state->cache = NULL;
+    state->block_func = NULL;
+    state->block_opaque = NULL;
+#ifdef WITH_PROFILE
+    memset(&state->profile, 0, sizeof(state->profile));
+#endif
+    state->windowless = windowless;
+    state->verify = 0;
+    state->scan = 0;
+    state->wbufsize = windowless ? 0 : INFLATE_ADJUST_WINDOW_SIZE((1 << MAX_WBITS) + 64);
     Tracev((stderr, "inflate: allocated\n"));
 
     strm->state = (struct internal_state *)state;
@@ -249,10 +288,42 @@ int32_t ZNG_CONDEXPORT PREFIX(inflateInit2)(PREFIX3(stream) *strm, int32_t windo
     ret = PREFIX(inflateReset2)(strm, windowBits);
     if (ret != Z_OK) {
         free_inflate(strm);
+        return ret;
     }
+    zprobe3(inflate_init, strm, windowBits, windowless);
     return ret;
 }
 
+/* ===========================================================================
+ * Initialize inflate state and buffers.
+ * This function is hidden in ZLIB_COMPAT builds.
+ */
+int32_t ZNG_CONDEXPORT PREFIX(inflateInit2)(PREFIX3(stream) *strm, int32_t windowBits) {
+    return inflate_init(strm, windowBits, 0, NULL, NULL);
+}
+
+int32_t Z_EXPORT PREFIX(inflateInitOneShot)(PREFIX3(stream) *strm, int32_t windowBits) {
+    return inflate_init(strm, windowBits, 1, NULL, NULL);
+}
+
+int32_t Z_EXPORT PREFIX(inflateInitWorkspace)(PREFIX3(stream) *strm, int32_t windowBits, void *work, size_t size) {
+    if (work == NULL)
+        return Z_STREAM_ERROR;
+    return inflate_init(strm, windowBits, 0, work, &size);
+}
+
+/* ===========================================================================
+ * Size of the workspace inflateInitWorkspace() needs. The window is allocated
+ * for the largest windowBits, so that a zlib or gzip header can ask for it.
+ */
+size_t Z_EXPORT PREFIX(inflateWorkspaceSize)(int32_t windowBits) {
+    size_t size = 0;
+
+    Z_UNUSED(windowBits);
+    alloc_inflate(NULL, 0, NULL, &size);
+    return size;
+}
+
 #ifndef ZLIB_COMPAT
 int32_t Z_EXPORT PREFIX(inflateInit)(PREFIX3(stream) *strm) {
     return PREFIX(inflateInit2)(strm, DEF_WBITS);
@@ -307,6 +378,54 @@ void Z_INTERNAL PREFIX(fixedtables)(struct inflate_state *state) {
     state->distbits = 5;
 }
 
+/* Entry state changes of the dynamic table cache, which may be shared between threads */
+#define CACHE_IS_READY(entry) (zng_atomic_load_32(&(entry)->ready) == INFLATE_CACHE_READY)
+#define CACHE_CLAIM(entry) zng_atomic_cas_32(&(entry)->ready, INFLATE_CACHE_EMPTY, INFLATE_CACHE_BUSY)
+#define CACHE_PUBLISH(entry) zng_atomic_store_32(&(entry)->ready, INFLATE_CACHE_READY)
+
+/*
+   Look up the code lengths in state->lens in the dynamic table cache, and if
+   tables were built for them before, point the state at those. Returns true
+   on a hit. *hash is set to the hash of the code lengths for cache_store().
+ */
+static int cache_lookup(struct inflate_state *state, uint32_t *hash) {
+    const inflate_cache_entry *entry;
+    uint32_t count = state->nlen + state->ndist;
+
+    *hash = FUNCTABLE_CALL(crc32)(state->nlen, (const uint8_t *)state->lens, count * sizeof(uint16_t));
+    entry = &state->cache->entries[*hash & state->cache->mask];
+    if (!CACHE_IS_READY(entry) || entry->hash != *hash || entry->nlen != state->nlen ||
+        entry->ndist != state->ndist || memcmp(entry->lens, state->lens, count * sizeof(uint16_t)) != 0)
+        return 0;
+
+    state->lencode = entry->codes;
+    state->lenbits = entry->lenbits;
+    state->distcode = entry->codes + entry->dist;
+    state->distbits = entry->distbits;
+    return 1;
+}
+
+/*
+   Publish the tables just built in state->codes from the code lengths in
+   state->lens, if the cache entry for their hash is still free.
+ */
+static void cache_store(struct inflate_state *state, uint32_t hash) {
+    inflate_cache_entry *entry = &state->cache->entries[hash & state->cache->mask];
+    uint32_t count = state->nlen + state->ndist;
+
+    if (!CACHE_CLAIM(entry))
+        return;
+    entry->hash = hash;
+    entry->nlen = (uint16_t)state->nlen;
+    entry->ndist = (uint16_t)state->ndist;
+    entry->lenbits = (uint16_t)state->lenbits;
+    entry->distbits = (uint16_t)state->distbits;
+    entry->dist = (uint16_t)(state->distcode - state->codes);
+    memcpy(entry->lens, state->lens, count * sizeof(uint16_t));
+    memcpy(entry->codes, state->codes, (state->next - state->codes) * sizeof(code));
+    CACHE_PUBLISH(entry);
+}
+
 /*
    Update the window with the last wsize (normally 32K) bytes written before
    returning.  If window does not exist yet, create it.  This is only called
@@ -486,6 +605,8 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
     code last;                  /* parent table entry */
     unsigned len;               /* length to copy for repeats, bits to drop */
     int32_t ret;                /* return code */
+    uint32_t hash = 0;          /* hash of code lengths for the table cache */
+    uint64_t clock_start = 0;   /* start of a table build timed for block_func */
     static const uint16_t order[19] = /* permutation of code lengths */
         {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
 
@@ -494,6 +615,7 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
         return Z_STREAM_ERROR;
 
     state = (struct inflate_state *)strm->state;
+    profile_start(state, Z_PROFILE_INFLATE);
     if (state->mode == TYPE)      /* skip check */
         state->mode = TYPEDO;
     LOAD();
@@ -708,6 +830,7 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
         case DICT:
             if (state->havedict == 0) {
                 RESTORE();
+                profile_stop(state, Z_PROFILE_INFLATE);
                 return Z_NEED_DICT;
             }
             strm->adler = state->check = ADLER32_INITIAL_VALUE;
@@ -728,6 +851,15 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
                 break;
             }
             NEEDBITS(3);
+            zprobe4(inflate_block, strm, BITS(3) >> 1, (strm->total_in + (in - have)) * 8 - bits,
+                    strm->total_out + (out - left));
+            if (state->block_func != NULL) {
+                memset(&state->block, 0, sizeof(state->block));
+                state->block.type = (int)(BITS(3) >> 1);
+                state->block.last = (int)BITS(1);
+                state->block.in = (z_off64_t)((state->total_in64 + (in - have)) * 8 - bits);
+                state->block.out = (z_off64_t)(state->total_out64 + (out - left));
+            }
             state->last = BITS(1);
             DROPBITS(1);
             switch (BITS(2)) {
@@ -738,6 +870,8 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
             case 1:                             /* fixed block */
                 PREFIX(fixedtables)(state);
                 Tracev((stderr, "inflate:     fixed codes block%s\n", state->last ? " (last)" : ""));
+                if (state->block_func != NULL)
+                    state->block_func(state->block_opaque, &state->block);
                 state->mode = LEN_;             /* decode codes */
                 if (flush == Z_TREES) {
                     DROPBITS(2);
@@ -765,6 +899,10 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
             state->length = (uint16_t)hold;
             Tracev((stderr, "inflate:       stored length %u\n", state->length));
             INITBITS();
+            if (state->block_func != NULL) {
+                state->block.length = state->length;
+                state->block_func(state->block_opaque, &state->block);
+            }
             state->mode = COPY_;
             if (flush == Z_TREES)
                 goto inf_leave;
@@ -810,6 +948,11 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
             }
 #endif
             Tracev((stderr, "inflate:       table sizes ok\n"));
+            if (state->block_func != NULL) {
+                state->block.nlen = state->nlen;
+                state->block.ndist = state->ndist;
+                state->block.ncode = state->ncode;
+            }
             state->have = 0;
             state->mode = LENLENS;
             Z_FALLTHROUGH;
@@ -826,7 +969,13 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
             state->next = state->codes;
             state->lencode = (const code *)(state->next);
             state->lenbits = 7;
+            if (state->block_func != NULL)
+                clock_start = zclock_ns();
+            profile_start(state, Z_PROFILE_INFLATE_TABLE);
             ret = zng_inflate_table(CODES, state->lens, 19, &(state->next), &(state->lenbits), state->work);
+            profile_stop(state, Z_PROFILE_INFLATE_TABLE);
+            if (state->block_func != NULL)
+                state->block.table_ns += zclock_ns() - clock_start;
             if (ret) {
                 SET_BAD("invalid code lengths set");
                 break;
@@ -892,26 +1041,42 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
                 break;
             }
 
-            /* build code tables -- note: do not change the lenbits or distbits
-               values here (10 and 9) without reading the comments in inftrees.h
-               concerning the ENOUGH constants, which depend on those values */
-            state->next = state->codes;
-            state->lencode = (const code *)(state->next);
-            state->lenbits = 10;
-            ret = zng_inflate_table(LENS, state->lens, state->nlen, &(state->next), &(state->lenbits), state->work);
-            if (ret) {
-                SET_BAD("invalid literal/lengths set");
-                break;
-            }
-            state->distcode = (const code *)(state->next);
-            state->distbits = 9;
-            ret = zng_inflate_table(DISTS, state->lens + state->nlen, state->ndist,
-                            &(state->next), &(state->distbits), state->work);
-            if (ret) {
-                SET_BAD("invalid distances set");
-                break;
+            /* reuse the tables if another block with the same code lengths built them */
+            if (state->block_func != NULL)
+                clock_start = zclock_ns();
+            profile_start(state, Z_PROFILE_INFLATE_TABLE);
+            if (state->cache != NULL && cache_lookup(state, &hash)) {
+                Tracev((stderr, "inflate:       cached codes\n"));
+            } else {
+                /* build code tables -- note: do not change the lenbits or distbits
+                   values here (10 and 9) without reading the comments in inftrees.h
+                   concerning the ENOUGH constants, which depend on those values */
+                state->next = state->codes;
+                state->lencode = (const code *)(state->next);
+                state->lenbits = 10;
+                ret = zng_inflate_table(LENS, state->lens, state->nlen, &(state->next), &(state->lenbits), state->work);
+                if (ret) {
+                    SET_BAD("invalid literal/lengths set");
+                    break;
+                }
+                state->distcode = (const code *)(state->next);
+                state->distbits = 9;
+                ret = zng_inflate_table(DISTS, state->lens + state->nlen, state->ndist,
+                                &(state->next), &(state->distbits), state->work);
+                if (ret) {
+                    SET_BAD("invalid distances set");
+                    break;
+                }
+                if (state->cache != NULL)
+                    cache_store(state, hash);
             }
             Tracev((stderr, "inflate:       codes ok\n"));
+            profile_stop(state, Z_PROFILE_INFLATE_TABLE);
+            zprobe4(inflate_table, strm, state->nlen, state->ndist, state->ncode);
+            if (state->block_func != NULL) {
+                state->block.table_ns += zclock_ns() - clock_start;
+                state->block_func(state->block_opaque, &state->block);
+            }
             state->mode = LEN_;
             if (flush == Z_TREES)
                 goto inf_leave;
@@ -925,7 +1090,9 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
             /* use inflate_fast() if we have enough input and output */
             if (have >= INFLATE_FAST_MIN_HAVE && left >= INFLATE_FAST_MIN_LEFT) {
                 RESTORE();
+                profile_start(state, Z_PROFILE_INFLATE_FAST);
                 FUNCTABLE_CALL(inflate_fast)(strm, out);
+                profile_stop(state, Z_PROFILE_INFLATE_FAST);
                 LOAD();
                 if (state->mode == TYPE)
                     state->back = -1;
@@ -1046,7 +1213,7 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
             /* copy match from window to output */
             if (left == 0)
                 goto inf_leave;
-            copy = out - left;
+            copy = out - left + state->ohave;
             if (state->offset > copy) {         /* copy from window */
                 copy = state->offset - copy;
                 if (copy > state->whave) {
@@ -1114,7 +1281,7 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
                     }
                 }
                 out = left;
-                if ((state->wrap & 4) && (
+                if ((state->wrap & 4) && !state->scan && (
 #ifdef GUNZIP
                      state->flags ? hold :
 #endif
@@ -1166,7 +1333,12 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
   inf_leave:
     RESTORE();
     uint32_t check_bytes = out - strm->avail_out;
-    if (INFLATE_NEED_UPDATEWINDOW(strm) &&
+    if (state->windowless || state->verify) {
+        /* the output stays in place as history for the next call, only the check value needs updating */
+        if (INFLATE_NEED_CHECKSUM(strm) && (state->wrap & 4))
+            inf_chksum(strm, strm->next_out - check_bytes, check_bytes);
+        check_bytes = 0;
+    } else if (INFLATE_NEED_UPDATEWINDOW(strm) &&
             (state->wsize || (out != strm->avail_out && state->mode < BAD &&
                  (state->mode < CHECK || flush != Z_FINISH)))) {
         /* update sliding window with respective checksum if not in "raw" mode */
@@ -1176,7 +1348,11 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
     out -= strm->avail_out;
     strm->total_in += in;
     strm->total_out += out;
+    state->total_in64 += in;
+    state->total_out64 += out;
     state->total += out;
+    if (state->windowless)
+        state->ohave = MIN(state->ohave + out, 1U << MAX_WBITS);
 
     strm->data_type = (int)state->bits + (state->last ? 64 : 0) +
                       (state->mode == TYPE ? 128 : 0) + (state->mode == LEN_ || state->mode == COPY_ ? 256 : 0);
@@ -1187,6 +1363,560 @@ int32_t Z_EXPORT PREFIX(inflate)(PREFIX3(stream) *strm, int32_t flush) {
         }
         ret = Z_BUF_ERROR;
     }
+    profile_stop(state, Z_PROFILE_INFLATE);
+    return ret;
+}
+
+int32_t Z_EXPORT PREFIX(inflateVerify)(PREFIX3(stream) *strm, int32_t flush) {
+    struct inflate_state *state;
+    unsigned char *next_out;
+    uint32_t avail_out;
+    unsigned long total_in, total_out;
+    int32_t ret;
+
+    if (inflateStateCheck(strm) || (flush != Z_NO_FLUSH && flush != Z_SYNC_FLUSH && flush != Z_FINISH))
+        return Z_STREAM_ERROR;
+    state = (struct inflate_state *)strm->state;
+    if (state->window == NULL)
+        return Z_STREAM_ERROR;
+    if (state->wsize == 0)
+        state->wsize = 1U << MAX_WBITS;
+
+    next_out = strm->next_out;
+    avail_out = strm->avail_out;
+    total_in = strm->total_in;
+    total_out = strm->total_out;
+
+    /* Decode into the free part of the window ring, which then holds the history inflate_fast() and the MATCH
+       state look back into, so nothing is copied and no output buffer is needed. Writing output into the window
+       is what inflate_fast()'s extra_safe mode guards against overwriting history that is still needed. */
+    state->verify = 1;
+    do {
+        uint32_t have;
+
+        strm->next_out = state->window + state->wnext;
+        strm->avail_out = state->wsize - state->wnext;
+        /* Z_FINISH would make inflate() give up once the ring is full */
+        ret = PREFIX(inflate)(strm, Z_NO_FLUSH);
+
+        have = (uint32_t)(strm->next_out - (state->window + state->wnext));
+        state->wnext += have;
+        if (state->wnext == state->wsize)
+            state->wnext = 0;
+        state->whave = MIN(state->whave + have, state->wsize);
+    } while (ret == Z_OK && strm->avail_out == 0);
+    state->verify = 0;
+
+    strm->next_out = next_out;
+    strm->avail_out = avail_out;
+
+    /* a full ring followed by a call without progress is still progress for the caller */
+    if (ret == Z_BUF_ERROR && (strm->total_in != total_in || strm->total_out != total_out))
+        ret = Z_OK;
+    if (ret == Z_OK && flush == Z_FINISH)
+        ret = Z_BUF_ERROR;
+    return ret;
+}
+
+/* Take one more byte into hold for inflate_scan_codes(), or leave for more input */
+#define SCAN_PULLBYTE() \
+    do { \
+        if (have == 0) \
+            goto more; \
+        hold |= (uint64_t)(*next++) << bits; \
+        have--; \
+        bits += 8; \
+    } while (0)
+
+#define SCAN_REFILL() \
+    do { \
+        hold |= load_64_bits(next, bits); \
+        next += (63 ^ bits) >> 3; \
+        have -= (63 ^ bits) >> 3; \
+        bits |= 56; \
+    } while (0)
+
+#define SCAN_DROPBITS(n) \
+    do { \
+        hold >>= (n); \
+        bits -= (unsigned)(n); \
+    } while (0)
+
+#define SCAN_NEEDBITS(n) \
+    do { \
+        while (bits < (unsigned)(n)) \
+            SCAN_PULLBYTE(); \
+    } while (0)
+
+/* Entries of the table of runs inflate_scan_codes() builds for a block, indexed like the root of lencode. Each
+   holds the bits and the output of the literals, possibly ended by a length, whose codes and extra bits all fit in
+   the index. An entry of zero starts with a code that does not fit, or one that is not a literal or length. */
+#define SCAN_RUN_BITS(e)  ((e) & 0xff)
+#define SCAN_RUN_MATCH    0x100         /* the run ends in a length, a distance code follows */
+#define SCAN_RUN_LITS(e)  (((e) >> 9) & 0x7f)
+#define SCAN_RUN_OUT(e)   ((e) >> 16)
+
+/* Smallest input worth building the table of runs for, which has up to 1K entries to fill */
+#define SCAN_RUN_MIN_HAVE 4096
+
+static void inflate_scan_runs(const code *lcode, unsigned lenbits, uint32_t *run) {
+    unsigned i;
+
+    for (i = 0; i < (1U << lenbits); i++) {
+        unsigned idx = i, left = lenbits, lits = 0, out = 0;
+        uint32_t match = 0;
+
+        for (;;) {
+            code here = lcode[idx];
+            unsigned op = here.op & MAX_BITS;
+
+            if (here.bits > left)
+                break;
+            if (here.op == 0) {
+                lits++;
+                out++;
+            } else if ((here.op & 16) && here.bits + op <= left) {
+                out += here.val + ((idx >> here.bits) & ((1U << op) - 1));
+                idx >>= op;
+                left -= op;
+                match = SCAN_RUN_MATCH;
+            } else {
+                break;
+            }
+            idx >>= here.bits;
+            left -= here.bits;
+            if (match)
+                break;
+        }
+        run[i] = (uint32_t)(out << 16) | (lits << 9) | match | (lenbits - left);
+    }
+}
+
+/* Decodes the codes of the current block as inflate() would, but only adds up the lengths of the literals and
+   matches instead of writing them. Returns 1 at the end of the block, 0 if the input ran out, or -1 on invalid
+   data. A code cut off by the end of the input is decoded again on the next call, its first bits are kept in hold
+   so that all of the input is taken as inflate() takes it. Whole bytes read ahead into hold are put back, so a
+   stored block that follows starts at the right byte. */
+static int inflate_scan_codes(PREFIX3(stream) *strm, struct inflate_state *state) {
+    const code *lcode = state->lencode;
+    const code *dcode = state->distcode;
+    const uint64_t lmask = (1U << state->lenbits) - 1;
+    const uint64_t dmask = (1U << state->distbits) - 1;
+    const unsigned char *start = strm->next_in;
+    const unsigned char *next = start;
+    uint32_t have = strm->avail_in;
+    uint64_t hold = state->hold;
+    unsigned bits = state->bits;
+    /* matches may reach back over the whole member and into a dictionary */
+    uint64_t history = (uint64_t)state->total + state->whave;
+    uint64_t out = 0;
+    uint32_t taken;
+    unsigned back;
+    uint32_t runs[1 << 10];     /* lenbits is never more than 10 */
+    const uint32_t *run = NULL;
+    int ret = 0;
+
+    /* Runs of short codes are taken a table lookup at a time, which is where the scan gains most on inflate() */
+    if (have >= SCAN_RUN_MIN_HAVE) {
+        inflate_scan_runs(lcode, state->lenbits, runs);
+        run = runs;
+    }
+
+    /* With 16 bytes at hand no code can run past the input, two refills of at most 7 bytes each cover a literal or
+       match, so the codes are decoded with no checks on the input. The refills come after the lookups they would
+       otherwise hold up, since at least 28 bits are left after each step the next root lookup never needs them. */
+    if (have >= 16)
+        SCAN_REFILL();
+    while (have >= 16) {
+        unsigned op, len, dist;
+        code here;
+
+        if (run != NULL) {
+            uint32_t e = run[hold & lmask];
+            SCAN_REFILL();
+            if (e != 0) {
+                SCAN_DROPBITS(SCAN_RUN_BITS(e));
+                if (!(e & SCAN_RUN_MATCH)) {
+                    out += SCAN_RUN_OUT(e);
+                    e = run[hold & lmask];
+                    if (e == 0)
+                        continue;
+                    SCAN_DROPBITS(SCAN_RUN_BITS(e));
+                    if (!(e & SCAN_RUN_MATCH)) {
+                        out += SCAN_RUN_OUT(e);
+                        continue;
+                    }
+                }
+                out += SCAN_RUN_LITS(e);
+                len = SCAN_RUN_OUT(e) - SCAN_RUN_LITS(e);
+                goto dodist;
+            }
+        } else {
+            SCAN_REFILL();
+        }
+
+        here = lcode[hold & lmask];
+        if ((here.op & 0xf0) == 0 && here.op != 0) {
+            /* second level table */
+            SCAN_DROPBITS(here.bits);
+            here = lcode[here.val + (hold & ((1U << here.op) - 1))];
+        }
+        SCAN_DROPBITS(here.bits);
+        op = here.op;
+        if (op == 0) {
+            out++;
+            continue;
+        }
+        if (op & 32) {
+            ret = 1;
+            break;
+        }
+        if (op & 64) {
+            SET_BAD("invalid literal/length code");
+            ret = -1;
+            break;
+        }
+        op &= MAX_BITS;
+        len = here.val + (unsigned)(hold & ((1U << op) - 1));
+        SCAN_DROPBITS(op);
+
+      dodist:
+        here = dcode[hold & dmask];
+        SCAN_REFILL();
+        if ((here.op & 0xf0) == 0) {
+            SCAN_DROPBITS(here.bits);
+            here = dcode[here.val + (hold & ((1U << here.op) - 1))];
+        }
+        if (here.op & 64) {
+            SET_BAD("invalid distance code");
+            ret = -1;
+            break;
+        }
+        /* the code and its extra bits go in one shift, which is all the next code waits for */
+        op = here.op & MAX_BITS;
+        dist = here.val + (unsigned)((hold >> here.bits) & ((1U << op) - 1));
+        SCAN_DROPBITS(here.bits + op);
+#ifdef INFLATE_STRICT
+        if (dist > state->dmax) {
+            SET_BAD("invalid distance too far back");
+            ret = -1;
+            break;
+        }
+#endif
+#ifdef INFLATE_ALLOW_INVALID_DISTANCE_TOOFAR_ARRR
+        if (state->sane && dist > history + out) {
+#else
+        if (dist > history + out) {
+#endif
+            SET_BAD("invalid distance too far back");
+            ret = -1;
+            break;
+        }
+        out += len;
+    }
+
+    /* the rest of the input a byte at a time, a code may be cut off at its end */
+    while (ret == 0) {
+        const unsigned char *code_next;
+        uint32_t code_have;
+        uint64_t code_hold;
+        unsigned code_bits;
+        unsigned op, len, dist;
+        code here, last;
+
+        if (have >= 8) {
+            unsigned n = (63 ^ bits) >> 3;
+            hold |= load_64_bits(next, bits);
+            next += n;
+            have -= n;
+            bits |= 56;
+        }
+        code_next = next;
+        code_have = have;
+        code_hold = hold;
+        code_bits = bits;
+
+        /* literal, length or end-of-block code */
+        for (;;) {
+            here = lcode[hold & lmask];
+            if (here.bits <= bits)
+                break;
+            SCAN_PULLBYTE();
+        }
+        if (here.op && (here.op & 0xf0) == 0) {
+            last = here;
+            for (;;) {
+                here = lcode[last.val + ((hold & ((1U << (last.bits + last.op)) - 1)) >> last.bits)];
+                if ((unsigned)last.bits + (unsigned)here.bits <= bits)
+                    break;
+                SCAN_PULLBYTE();
+            }
+            hold >>= last.bits;
+            bits -= last.bits;
+        }
+        hold >>= here.bits;
+        bits -= here.bits;
+        op = here.op;
+        if (op == 0) {
+            out++;
+            continue;
+        }
+        if (op & 32) {
+            ret = 1;
+            break;
+        }
+        if (op & 64) {
+            SET_BAD("invalid literal/length code");
+            ret = -1;
+            break;
+        }
+        op &= MAX_BITS;
+        SCAN_NEEDBITS(op);
+        len = here.val + (unsigned)(hold & ((1U << op) - 1));
+        hold >>= op;
+        bits -= op;
+
+        /* distance code */
+        for (;;) {
+            here = dcode[hold & dmask];
+            if (here.bits <= bits)
+                break;
+            SCAN_PULLBYTE();
+        }
+        if ((here.op & 0xf0) == 0) {
+            last = here;
+            for (;;) {
+                here = dcode[last.val + ((hold & ((1U << (last.bits + last.op)) - 1)) >> last.bits)];
+                if ((unsigned)last.bits + (unsigned)here.bits <= bits)
+                    break;
+                SCAN_PULLBYTE();
+            }
+            hold >>= last.bits;
+            bits -= last.bits;
+        }
+        hold >>= here.bits;
+        bits -= here.bits;
+        if (here.op & 64) {
+            SET_BAD("invalid distance code");
+            ret = -1;
+            break;
+        }
+        op = here.op & MAX_BITS;
+        SCAN_NEEDBITS(op);
+        dist = here.val + (unsigned)(hold & ((1U << op) - 1));
+        hold >>= op;
+        bits -= op;
+#ifdef INFLATE_STRICT
+        if (dist > state->dmax) {
+            SET_BAD("invalid distance too far back");
+            ret = -1;
+            break;
+        }
+#endif
+#ifdef INFLATE_ALLOW_INVALID_DISTANCE_TOOFAR_ARRR
+        if (state->sane && dist > history + out) {
+#else
+        if (dist > history + out) {
+#endif
+            SET_BAD("invalid distance too far back");
+            ret = -1;
+            break;
+        }
+        out += len;
+        continue;
+
+      more:
+        /* start over from the cut off code next time, with the rest of the input in hold */
+        next = code_next;
+        have = code_have;
+        hold = code_hold;
+        bits = code_bits;
+        while (have != 0 && bits <= 56) {
+            hold |= (uint64_t)(*next++) << bits;
+            have--;
+            bits += 8;
+        }
+        ret = 0;
+        break;
+    }
+
+    if (ret != 0) {
+        /* return the whole bytes read ahead, only those of this call are still in next_in */
+        back = MIN(bits >> 3, (unsigned)(next - start));
+        next -= back;
+        have += back;
+        bits -= back << 3;
+    }
+    if (ret == 1) {
+        state->back = -1;
+        state->mode = TYPE;
+    }
+    hold &= ((uint64_t)1 << bits) - 1;
+
+    taken = (uint32_t)(next - start);
+    strm->next_in = (z_const unsigned char *)next;
+    strm->avail_in = have;
+    strm->total_in += taken;
+    strm->total_out += out;
+    state->hold = hold;
+    state->bits = bits;
+    state->total += out;
+    state->total_in64 += taken;
+    state->total_out64 += out;
+    return ret;
+}
+
+#undef SCAN_PULLBYTE
+#undef SCAN_REFILL
+#undef SCAN_DROPBITS
+#undef SCAN_NEEDBITS
+
+/* Adds a mark at the current position, if there is room, returns 0 if there is not */
+static int inflate_scan_mark(struct inflate_state *state, scan_mark *marks, unsigned max, unsigned *n, int type,
+                             int last) {
+    if (marks == NULL)
+        return 1;
+    if (*n == max)
+        return 0;
+    marks[*n].in = (z_off64_t)(state->total_in64 * 8 - state->bits);
+    marks[*n].out = (z_off64_t)state->total_out64;
+    marks[*n].type = type;
+    marks[*n].last = last;
+    (*n)++;
+    return 1;
+}
+
+int32_t Z_EXPORT PREFIX(inflateScan)(PREFIX3(stream) *strm, int32_t flush, scan_mark *marks, unsigned *count) {
+    struct inflate_state *state;
+    unsigned char *next_out;
+    uint32_t avail_out;
+    unsigned char sink;
+    unsigned max, n = 0;
+    uint64_t start_in, start_out;
+    int32_t ret = Z_OK;
+
+    if (inflateStateCheck(strm) || (flush != Z_NO_FLUSH && flush != Z_SYNC_FLUSH && flush != Z_FINISH) ||
+        (marks != NULL && count == NULL))
+        return Z_STREAM_ERROR;
+    state = (struct inflate_state *)strm->state;
+    /* the scan takes over at block boundaries and inside the codes, never inside a literal or match */
+    if (state->mode >= LENEXT && state->mode <= LIT)
+        return Z_STREAM_ERROR;
+    max = marks != NULL ? *count : 0;
+    start_in = state->total_in64;
+    start_out = state->total_out64;
+
+    /* inflate() is only left to read headers, tables and trailers, none of which write output */
+    next_out = strm->next_out;
+    avail_out = strm->avail_out;
+    strm->next_out = &sink;
+    strm->avail_out = 0;
+    state->scan = 1;
+
+    for (;;) {
+        inflate_mode mode = state->mode;
+
+        if (mode == HEAD && state->bits == 0) {
+            /* a member starts, unless there is no more input to tell */
+            if (strm->avail_in == 0 && state->wrap != 0)
+                break;
+            if (!inflate_scan_mark(state, marks, max, &n, Z_SCAN_MEMBER, 0))
+                break;
+            if (state->wrap == 0)
+                state->mode = mode = TYPEDO;
+        }
+
+        if ((mode == TYPE || mode == TYPEDO) && !state->last) {
+            /* peek at the block header for the mark, inflate() then reads it */
+            if (state->bits < 3) {
+                if (strm->avail_in == 0)
+                    break;
+                state->hold |= (uint64_t)(*strm->next_in++) << state->bits;
+                strm->avail_in--;
+                strm->total_in++;
+                state->total_in64++;
+                state->bits += 8;
+            }
+            if ((state->hold & 6) != 6 &&
+                !inflate_scan_mark(state, marks, max, &n, (int)((state->hold >> 1) & 3), (int)(state->hold & 1)))
+                break;
+        } else if ((mode == TYPE || mode == TYPEDO || mode == CHECK || mode == LENGTH) && marks != NULL && n == max) {
+            /* the end of the member may be next, keep room for its mark */
+            break;
+        }
+
+        if (mode == COPY_ || mode == COPY) {
+            /* stored block, skip its data */
+            uint32_t copy = MIN(state->length, strm->avail_in);
+            strm->next_in += copy;
+            strm->avail_in -= copy;
+            strm->total_in += copy;
+            strm->total_out += copy;
+            state->total += copy;
+            state->total_in64 += copy;
+            state->total_out64 += copy;
+            state->length -= copy;
+            if (state->length != 0)
+                break;
+            state->mode = TYPE;
+        } else if (mode == LEN_ || mode == LEN) {
+            int done = inflate_scan_codes(strm, state);
+            if (done < 0) {
+                ret = Z_DATA_ERROR;
+                break;
+            }
+            if (done == 0)
+                break;
+        } else if (mode == DONE) {
+#ifdef GUNZIP
+            /* go on into the next member of a gzip file */
+            if (state->flags > 0 && strm->avail_in != 0 && strm->next_in[0] == 0x1f &&
+                (strm->avail_in == 1 || strm->next_in[1] == 0x8b)) {
+                unsigned long total_in = strm->total_in, total_out = strm->total_out;
+                uint64_t member_in = state->total_in64, member_out = state->total_out64;
+
+                PREFIX(inflateReset)(strm);
+                strm->total_in = total_in;
+                strm->total_out = total_out;
+                state->total_in64 = member_in;
+                state->total_out64 = member_out;
+                continue;
+            }
+#endif
+            ret = Z_STREAM_END;
+            break;
+        } else if (mode == BAD) {
+            ret = Z_DATA_ERROR;
+            break;
+        } else {
+            /* headers, code tables and trailers */
+            unsigned long total_in = strm->total_in;
+
+            ret = PREFIX(inflate)(strm, Z_TREES);
+            if (ret == Z_STREAM_END) {
+                inflate_scan_mark(state, marks, max, &n, Z_SCAN_END, 1);
+                ret = Z_OK;
+                continue;
+            }
+            if (ret != Z_OK && ret != Z_BUF_ERROR)
+                break;
+            ret = Z_OK;
+            if (state->mode == mode && strm->total_in == total_in)
+                break;
+        }
+    }
+
+    state->scan = 0;
+    strm->next_out = next_out;
+    strm->avail_out = avail_out;
+    strm->data_type = (int)state->bits + (state->last ? 64 : 0) +
+                      (state->mode == TYPE ? 128 : 0) + (state->mode == LEN_ || state->mode == COPY_ ? 256 : 0);
+    if (count != NULL)
+        *count = n;
+
+    if (ret == Z_OK && (n == 0 || n < max) &&
+        ((state->total_in64 == start_in && state->total_out64 == start_out) || flush == Z_FINISH))
+        ret = Z_BUF_ERROR;
     return ret;
 }
 
@@ -1194,6 +1924,11 @@ int32_t Z_EXPORT PREFIX(inflateEnd)(PREFIX3(stream) *strm) {
     if (inflateStateCheck(strm))
         return Z_STREAM_ERROR;
 
+    zprobe3(inflate_end, strm, strm->total_in, strm->total_out);
+#ifdef WITH_PROFILE
+    zprofile_add(&((struct inflate_state *)strm->state)->profile.total);
+#endif
+
     /* Free allocated buffers */
     free_inflate(strm);
 
@@ -1229,7 +1964,7 @@ int32_t Z_EXPORT PREFIX(inflateSetDictionary)(PREFIX3(stream) *strm, const uint8
     if (inflateStateCheck(strm))
         return Z_STREAM_ERROR;
     state = (struct inflate_state *)strm->state;
-    if (state->wrap != 0 && state->mode != DICT)
+    if ((state->wrap != 0 && state->mode != DICT) || state->windowless)
         return Z_STREAM_ERROR;
 
     /* check for correct dictionary identifier */
@@ -1266,6 +2001,79 @@ int32_t Z_EXPORT PREFIX(inflateGetHeader)(PREFIX3(stream) *strm, PREFIX(gz_heade
     return Z_OK;
 }
 
+inflate_cache * Z_EXPORT PREFIX(inflateCacheCreate)(unsigned entries) {
+    inflate_cache *cache;
+    uint32_t size = INFLATE_CACHE_DEFAULT;
+
+    if (entries > INFLATE_CACHE_MAX)
+        entries = INFLATE_CACHE_MAX;
+    if (entries) {
+        size = 1;
+        while (size < entries)
+            size <<= 1;
+    }
+
+    if (zng_mem_take(sizeof(inflate_cache) + size * sizeof(inflate_cache_entry)))
+        return NULL;
+    cache = (inflate_cache *)zng_alloc(sizeof(inflate_cache) + size * sizeof(inflate_cache_entry));
+    if (cache == NULL) {
+        zng_mem_give(sizeof(inflate_cache) + size * sizeof(inflate_cache_entry));
+        return NULL;
+    }
+    cache->mask = size - 1;
+    cache->entries = (inflate_cache_entry *)(cache + 1);
+    for (uint32_t i = 0; i < size; i++)
+        cache->entries[i].ready = INFLATE_CACHE_EMPTY;
+    return cache;
+}
+
+int32_t Z_EXPORT PREFIX(inflateGetProfile)(PREFIX3(stream) *strm, z_profile *profile) {
+#ifdef WITH_PROFILE
+    if (inflateStateCheck(strm) || profile == NULL)
+        return Z_STREAM_ERROR;
+    memcpy(profile, &((struct inflate_state *)strm->state)->profile.total, sizeof(z_profile));
+    return Z_OK;
+#else
+    Z_UNUSED(strm);
+    Z_UNUSED(profile);
+    return Z_VERSION_ERROR;
+#endif
+}
+
+int32_t Z_EXPORT PREFIX(inflateGetMemory)(PREFIX3(stream) *strm, size_t *size) {
+    if (inflateStateCheck(strm) || size == NULL)
+        return Z_STREAM_ERROR;
+    *size = ((struct inflate_state *)strm->state)->alloc_bufs->size;
+    return Z_OK;
+}
+
+int32_t Z_EXPORT PREFIX(inflateSetBlockCallback)(PREFIX3(stream) *strm, inflate_block_func func, void *opaque) {
+    struct inflate_state *state;
+
+    if (inflateStateCheck(strm))
+        return Z_STREAM_ERROR;
+    state = (struct inflate_state *)strm->state;
+    state->block_func = func;
+    state->block_opaque = opaque;
+    return Z_OK;
+}
+
+int32_t Z_EXPORT PREFIX(inflateSetCache)(PREFIX3(stream) *strm, inflate_cache *cache) {
+    struct inflate_state *state;
+
+    if (inflateStateCheck(strm))
+        return Z_STREAM_ERROR;
+    state = (struct inflate_state *)strm->state;
+    state->cache = cache;
+    return Z_OK;
+}
+
+void Z_EXPORT PREFIX(inflateCacheFree)(inflate_cache *cache) {
+    if (cache != NULL)
+        zng_mem_give(sizeof(inflate_cache) + (cache->mask + 1) * sizeof(inflate_cache_entry));
+    zng_free(cache);
+}
+
 /*
    Search buf[0..len-1] for the pattern: 0, 0, 0xff, 0xff.  Return when found
    or when out of input.  When called, *have is the number of pattern bytes
@@ -1298,6 +2106,7 @@ static uint32_t syncsearch(uint32_t *have, const uint8_t *buf, uint32_t len) {
 int32_t Z_EXPORT PREFIX(inflateSync)(PREFIX3(stream) *strm) {
     struct inflate_state *state;
     size_t in, out;             /* temporary to save total_in and total_out */
+    uint64_t total_in64, total_out64;   /* and their 64-bit counterparts */
     unsigned len;               /* number of bytes to look at or looked at */
     int flags;                  /* temporary to save header status */
     unsigned char buf[4];       /* to restore bit buffer to byte string */
@@ -1329,6 +2138,7 @@ int32_t Z_EXPORT PREFIX(inflateSync)(PREFIX3(stream) *strm) {
     strm->avail_in -= len;
     strm->next_in += len;
     strm->total_in += len;
+    state->total_in64 += len;
 
     /* return no joy or set up to restart inflate() on a new block */
     if (state->have != 4)
@@ -1340,9 +2150,13 @@ int32_t Z_EXPORT PREFIX(inflateSync)(PREFIX3(stream) *strm) {
     flags = state->flags;
     in = strm->total_in;
     out = strm->total_out;
+    total_in64 = state->total_in64;
+    total_out64 = state->total_out64;
     PREFIX(inflateReset)(strm);
     strm->total_in = (z_uintmax_t)in; /* Can't use z_size_t here as it will overflow on 64-bit Windows */
     strm->total_out = (z_uintmax_t)out;
+    state->total_in64 = total_in64;
+    state->total_out64 = total_out64;
     state->flags = flags;
     state->mode = TYPE;
     return Z_OK;
@@ -1379,7 +2193,7 @@ int32_t Z_EXPORT PREFIX(inflateCopy)(PREFIX3(stream) *dest, PREFIX3(stream) *sou
     memcpy((void *)dest, (void *)source, sizeof(PREFIX3(stream)));
 
     /* allocate space */
-    inflate_allocs *alloc_bufs = alloc_inflate(dest);
+    inflate_allocs *alloc_bufs = alloc_inflate(dest, state->windowless, NULL, NULL);
     if (alloc_bufs == NULL)
         return Z_MEM_ERROR;
     copy = alloc_bufs->state;
@@ -1387,6 +2201,9 @@ int32_t Z_EXPORT PREFIX(inflateCopy)(PREFIX3(stream) *dest, PREFIX3(stream) *sou
     /* copy state */
     memcpy(copy, state, sizeof(struct inflate_state));
     copy->strm = dest;
+#ifdef WITH_PROFILE
+    memset(&copy->profile, 0, sizeof(copy->profile));
+#endif
     if (state->lencode >= state->codes && state->lencode <= state->codes + ENOUGH - 1) {
         copy->lencode = copy->codes + (state->lencode - state->codes);
         copy->distcode = copy->codes + (state->distcode - state->codes);
@@ -1396,7 +2213,8 @@ int32_t Z_EXPORT PREFIX(inflateCopy)(PREFIX3(stream) *dest, PREFIX3(stream) *sou
     copy->alloc_bufs = alloc_bufs;
 
     /* window */
-    memcpy(copy->window, state->window, INFLATE_ADJUST_WINDOW_SIZE((size_t)state->wsize));
+    if (copy->window != NULL)
+        memcpy(copy->window, state->window, INFLATE_ADJUST_WINDOW_SIZE((size_t)state->wsize));
 
     dest->state = (struct internal_state *)copy;
     return Z_OK;
@@ -12,6 +12,8 @@
 #define INFLATE_H_
 
 #include "crc32.h"
+#include "zprofile.h"
+#include "zprobe.h"
 
 #ifdef S390_DFLTCC_INFLATE
 #  include "arch/s390/dfltcc_common.h"
@@ -86,10 +88,36 @@ typedef enum {
  */
 typedef struct inflate_state inflate_state;
 
+/* Cache of dynamic code tables shared between inflate streams, see inflateCacheCreate() */
+#define INFLATE_CACHE_DEFAULT 64     /* entries when zero is requested */
+#define INFLATE_CACHE_MAX     4096   /* maximum number of entries, each takes about 8K */
+
+#define INFLATE_CACHE_EMPTY   0      /* entry is unused */
+#define INFLATE_CACHE_BUSY    1      /* entry is being filled by a stream */
+#define INFLATE_CACHE_READY   2      /* entry is published and never changes again */
+
+typedef struct inflate_cache_entry_s {
+    int32_t ready;              /* one of INFLATE_CACHE_EMPTY, BUSY or READY */
+    uint32_t hash;              /* crc32 of the code lengths */
+    uint16_t nlen;              /* number of length code lengths */
+    uint16_t ndist;             /* number of distance code lengths */
+    uint16_t lenbits;           /* index bits for the length/literal table */
+    uint16_t distbits;          /* index bits for the distance table */
+    uint16_t dist;              /* offset of the distance table in codes[] */
+    uint16_t lens[286+30];      /* code lengths the tables were built from */
+    code codes[ENOUGH];         /* length/literal table followed by distance table */
+} inflate_cache_entry;
+
+struct inflate_cache_s {
+    uint32_t mask;                  /* number of entries minus one */
+    inflate_cache_entry *entries;   /* direct-mapped by hash */
+};
+
 /* Struct for memory allocation handling */
 typedef struct inflate_allocs_s {
     char            *buf_start;
     free_func        zfree;
+    size_t           size;      /* bytes taken from zalloc, counted in zlibGetMemory(), 0 for a workspace */
     inflate_state   *state;
     unsigned char   *window;
 } inflate_allocs;
@@ -118,6 +146,18 @@ struct ALIGNED_(64) inflate_state {
     uint32_t whave;             /* valid bytes in the window */
     uint32_t wnext;             /* window write index */
     unsigned char *window;      /* allocated sliding window, if needed */
+    int windowless;             /* true if output is contiguous across calls and no window is kept */
+    uint32_t ohave;             /* valid bytes before next_out written by earlier calls, if windowless */
+    int verify;                 /* true while inflateVerify() decodes straight into the window */
+    int scan;                   /* true while inflateScan() walks the stream, no check value is computed */
+    uint64_t total_in64;        /* input bytes taken since the last reset, total_in may wrap where long is 32 bits */
+    uint64_t total_out64;       /* output bytes produced, or walked over by inflateScan(), since the last reset */
+    inflate_block_func block_func;  /* called at each block once its header is read, if not NULL */
+    void *block_opaque;         /* passed to block_func */
+    inflate_block block;        /* the block whose header is being read */
+#ifdef WITH_PROFILE
+    zprofile profile;           /* phase times returned by inflateGetProfile() */
+#endif
 
         /* bit accumulator */
     uint64_t hold;              /* input bit accumulator */
@@ -149,6 +189,7 @@ struct ALIGNED_(64) inflate_state {
     code codes[ENOUGH];         /* space for code tables */
 
     inflate_allocs *alloc_bufs; /* struct for handling memory allocations */
+    struct inflate_cache_s *cache; /* shared dynamic table cache or NULL */
 
 #ifdef INFLATE_STRICT
     unsigned dmax;              /* zlib header max distance (INFLATE_STRICT) */
@@ -165,7 +206,7 @@ struct ALIGNED_(64) inflate_state {
 };
 
 void Z_INTERNAL PREFIX(fixedtables)(struct inflate_state *state);
-Z_INTERNAL inflate_allocs* alloc_inflate(PREFIX3(stream) *strm);
+Z_INTERNAL inflate_allocs* alloc_inflate(PREFIX3(stream) *strm, int windowless, void *work, size_t *work_size);
 Z_INTERNAL void free_inflate(PREFIX3(stream) *strm);
 
 #endif /* INFLATE_H_ */
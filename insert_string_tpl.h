@@ -95,6 +95,7 @@ Z_FORCEINLINE static void INSERT_STRING(deflate_state *const s, uint32_t str, ui
     Pos *prevp = s->prev;
     const unsigned int w_mask = W_MASK(s);
 
+    profile_start(s, Z_PROFILE_INSERT_STRING);
     for (uint32_t idx = str; strstart < strend; idx++, strstart++) {
         uint32_t val, hm, head;
 
@@ -110,6 +111,7 @@ Z_FORCEINLINE static void INSERT_STRING(deflate_state *const s, uint32_t str, ui
             headp[hm] = (Pos)idx;
         }
     }
+    profile_stop(s, Z_PROFILE_INSERT_STRING);
 }
 
 // Cleanup
@@ -934,6 +934,1445 @@ static void test_deflate_tune(unsigned char *compr, size_t comprLen) {
     CHECK_ERR(err, "deflateEnd");
 }
 
+/* ===========================================================================
+ * Next value of the pseudo-random generator the tests draw their data from
+ */
+static uint32_t next_random(uint32_t *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed;
+}
+
+/* ===========================================================================
+ * Fill len bytes at data, or at a new buffer if data is NULL, with the hello string over and over, with on average
+ * one byte in every random_one_in replaced by a random byte: all of them for 1, none for 0. The same seed gives the
+ * same data. Returns data.
+ */
+static unsigned char *test_data(unsigned char *data, size_t len, unsigned random_one_in, uint32_t seed) {
+    if (data == NULL && (data = (unsigned char *)malloc(len)) == NULL)
+        error("out of memory\n");
+    for (size_t i = 0; i < len; i++) {
+        uint32_t r = next_random(&seed);
+
+        if (random_one_in && (r >> 16) % random_one_in == 0)
+            data[i] = (unsigned char)(r >> 24);
+        else
+            data[i] = (unsigned char)hello[i % strlen(hello)];
+    }
+    return data;
+}
+
+/* ===========================================================================
+ * Test deflateEstimate() against the actual compressed size
+ */
+static void test_deflate_estimate(void) {
+    PREFIX3(stream) c_stream; /* compression stream */
+    static const int levels[] = { 0, 1, 1, 1, 6, 9 };
+    static const int strategies[] = { Z_DEFAULT_STRATEGY, Z_DEFAULT_STRATEGY, Z_HUFFMAN_ONLY, Z_RLE,
+                                      Z_DEFAULT_STRATEGY, Z_DEFAULT_STRATEGY };
+    const size_t len = 512*1024;
+    size_t comprLen = len + len/8;
+    unsigned char *data, *compr;
+    unsigned long estimate, actual;
+    uint32_t seed = 1;
+    int err;
+
+    data = (unsigned char *)malloc(len);
+    compr = (unsigned char *)malloc(comprLen);
+    if (data == NULL || compr == NULL)
+        error("out of memory\n");
+
+    /* Text-like words picked from a small skewed vocabulary */
+    for (size_t i = 0; i < len; ) {
+        static const char *words[] = { "the ", "deflate ", "stream ", "of ", "window ", "match ", "hello, ", "\n" };
+        uint32_t r = next_random(&seed);
+        const char *w = words[(r >> 16) % 8 & ((r >> 24) & 3 ? 3 : 7)];
+        for (; *w && i < len; w++)
+            data[i++] = (unsigned char)*w;
+    }
+
+    for (size_t l = 0; l < sizeof(levels)/sizeof(levels[0]); l++) {
+        memset(&c_stream, 0, sizeof(c_stream));
+        err = PREFIX(deflateInit2)(&c_stream, levels[l], Z_DEFLATED, MAX_WBITS, DEF_MEM_LEVEL, strategies[l]);
+        CHECK_ERR(err, "deflateInit2");
+
+        estimate = PREFIX(deflateEstimate)(&c_stream, data, len);
+
+        /* The stream must be usable as is after the estimate */
+        c_stream.next_in = data;
+        c_stream.avail_in = (uint32_t)len/2;
+        c_stream.next_out = compr;
+        c_stream.avail_out = (uint32_t)comprLen;
+        err = PREFIX(deflate)(&c_stream, Z_NO_FLUSH);
+        CHECK_ERR(err, "deflate after deflateEstimate");
+
+        /* A used stream only gets the bound */
+        if (PREFIX(deflateEstimate)(&c_stream, data, len) != PREFIX(deflateBound)(&c_stream, len))
+            error("deflateEstimate on used stream\n");
+
+        c_stream.avail_in += (uint32_t)(len - len/2);
+        err = PREFIX(deflate)(&c_stream, Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("deflate after deflateEstimate level %d: %d\n", levels[l], err);
+        actual = (unsigned long)c_stream.total_out;
+
+        if (estimate < actual - actual/4 || estimate > actual + actual/4)
+            error("deflateEstimate level %d, strategy %d: estimated %lu, actual %lu\n", levels[l], strategies[l],
+                  estimate, actual);
+
+        /* A finished stream gets the bound of an inconsistent one */
+        if (PREFIX(deflateEstimate)(&c_stream, data, len) != PREFIX(deflateBound)(NULL, len))
+            error("deflateEstimate on finished stream\n");
+
+        err = PREFIX(deflateEnd)(&c_stream);
+        CHECK_ERR(err, "deflateEnd");
+    }
+    printf("deflateEstimate(): OK\n");
+
+    free(data);
+    free(compr);
+}
+
+/* ===========================================================================
+ * Test deflate() on input with an incompressible middle section, forcing small
+ * output buffers so that stored runs are interrupted
+ */
+static void test_deflate_incompressible(void) {
+    PREFIX3(stream) c_stream; /* compression stream */
+    static const int levels[] = { 2, 3, 4, 6, 7, 8, 9 };
+    const size_t len = 256*1024;
+    size_t comprLen = len + len/8;
+    unsigned char *data, *compr, *uncompr;
+    z_uintmax_t uncomprLen;
+    int err;
+
+    data = test_data(NULL, len, 0, 0);
+    test_data(data + len/4, len/2, 1, 12345);
+    compr = (unsigned char *)malloc(comprLen);
+    uncompr = (unsigned char *)malloc(len);
+    if (compr == NULL || uncompr == NULL)
+        error("out of memory\n");
+
+    /* Random middle half stored, then copies of one random block that has to be matched, not stored */
+    for (int repeats = 0; repeats < 2; repeats++) {
+        size_t limit = repeats ? len/8 : len/2 + len/2/64;
+
+        if (repeats) {
+            for (size_t i = 16*1024; i < len; i++)
+                data[i] = data[i % (16*1024) + len/4];
+            memcpy(data, data + len/4, 16*1024);
+        }
+        for (size_t l = 0; l < sizeof(levels)/sizeof(levels[0]); l++) {
+            memset(&c_stream, 0, sizeof(c_stream));
+            err = PREFIX(deflateInit)(&c_stream, levels[l]);
+            CHECK_ERR(err, "deflateInit");
+
+            c_stream.next_in = data;
+            c_stream.avail_in = (uint32_t)len;
+            c_stream.next_out = compr;
+            do {
+                c_stream.avail_out = MIN(997, (uint32_t)(comprLen - c_stream.total_out));
+                err = PREFIX(deflate)(&c_stream, Z_FINISH);
+            } while (err == Z_OK);
+            if (err != Z_STREAM_END)
+                error("deflate incompressible level %d: %d\n", levels[l], err);
+            if (c_stream.total_out > limit)
+                error("deflate incompressible level %d, repeats %d: %lu bytes\n", levels[l], repeats,
+                      (unsigned long)c_stream.total_out);
+
+            uncomprLen = len;
+            err = PREFIX(uncompress)(uncompr, &uncomprLen, compr, c_stream.total_out);
+            CHECK_ERR(err, "uncompress");
+            if (uncomprLen != len || memcmp(uncompr, data, len) != 0)
+                error("bad inflate of incompressible data at level %d\n", levels[l]);
+
+            err = PREFIX(deflateEnd)(&c_stream);
+            CHECK_ERR(err, "deflateEnd");
+        }
+    }
+    printf("deflate incompressible: OK\n");
+
+    free(data);
+    free(compr);
+    free(uncompr);
+}
+
+#ifndef NO_BLOCK_SPLIT
+/* ===========================================================================
+ * Bits of the best prefix code for the byte counts freq, a lower bound for a block with one set of Huffman trees
+ */
+static uint64_t huffman_bits(const uint32_t *freq) {
+    uint64_t weight[256], bits = 0;
+    int n = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (freq[i])
+            weight[n++] = freq[i];
+    }
+    while (n > 1) {
+        /* Merge the two lightest, the cost of a Huffman code is the sum of all merged weights */
+        for (int k = 0; k < 2; k++) {
+            int m = k;
+            for (int i = k + 1; i < n; i++) {
+                if (weight[i] < weight[m])
+                    m = i;
+            }
+            uint64_t t = weight[k];
+            weight[k] = weight[m];
+            weight[m] = t;
+        }
+        weight[0] += weight[1];
+        bits += weight[0];
+        weight[1] = weight[--n];
+    }
+    return bits;
+}
+#endif
+
+/* ===========================================================================
+ * Test deflate() ending a block where the symbol statistics shift
+ */
+static void test_deflate_block_split(void) {
+    PREFIX3(stream) c_stream, d_stream; /* compression and decompression streams */
+    static const int strategies[] = { Z_HUFFMAN_ONLY, Z_DEFAULT_STRATEGY };
+    const unsigned half = 12000;
+    static unsigned char data[24000], compr[24000], uncompr[24000];
+    unsigned long block_out[4];
+    uint32_t freq[256] = { 0 }, seed = 7;
+    int err;
+
+    /* Random lower case letters, then random bytes out of 16 high values, both fit in one symbol buffer */
+    for (unsigned i = 0; i < 2 * half; i++) {
+        uint32_t r = next_random(&seed);
+        data[i] = (unsigned char)(i < half ? 'a' + (r >> 16) % 26 : 0xf0 + ((r >> 16) & 15));
+        freq[data[i]]++;
+    }
+
+    for (size_t l = 0; l < sizeof(strategies)/sizeof(strategies[0]); l++) {
+        unsigned blocks = 0;
+
+        memset(&c_stream, 0, sizeof(c_stream));
+        err = PREFIX(deflateInit2)(&c_stream, 6, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, strategies[l]);
+        CHECK_ERR(err, "deflateInit2");
+        c_stream.next_in = data;
+        c_stream.avail_in = sizeof(data);
+        c_stream.next_out = compr;
+        c_stream.avail_out = sizeof(compr);
+        err = PREFIX(deflate)(&c_stream, Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("deflate block split: %d\n", err);
+        err = PREFIX(deflateEnd)(&c_stream);
+        CHECK_ERR(err, "deflateEnd");
+
+        /* Inflate a block at a time, noting where each one starts in the output */
+        memset(&d_stream, 0, sizeof(d_stream));
+        err = PREFIX(inflateInit2)(&d_stream, -MAX_WBITS);
+        CHECK_ERR(err, "inflateInit2");
+        d_stream.next_in = compr;
+        d_stream.avail_in = (uint32_t)c_stream.total_out;
+        d_stream.next_out = uncompr;
+        d_stream.avail_out = sizeof(uncompr);
+        block_out[blocks++] = 0;
+        do {
+            err = PREFIX(inflate)(&d_stream, Z_BLOCK);
+            if (err == Z_OK && (d_stream.data_type & 192) == 128) {
+                if (blocks < sizeof(block_out)/sizeof(block_out[0]))
+                    block_out[blocks] = (unsigned long)d_stream.total_out;
+                blocks++;
+            }
+        } while (err == Z_OK);
+        if (err != Z_STREAM_END || d_stream.total_out != sizeof(data) || memcmp(uncompr, data, sizeof(data)))
+            error("inflate block split: %d\n", err);
+        err = PREFIX(inflateEnd)(&d_stream);
+        CHECK_ERR(err, "inflateEnd");
+
+#ifndef NO_BLOCK_SPLIT
+        /* The split is found at the first check after the shift, or the one after it */
+        if (blocks != 2 || block_out[1] < half || block_out[1] > half + 3 * SPLIT_CHECK_INTERVAL)
+            error("deflate block split strategy %d: %u blocks, split at %lu\n", strategies[l], blocks,
+                  blocks > 1 ? block_out[1] : 0UL);
+
+        /* Literals only, so without the split the one block can't be smaller than the best code for all bytes */
+        if (strategies[l] == Z_HUFFMAN_ONLY && c_stream.total_out * 8 >= huffman_bits(freq))
+            error("deflate block split: %lu bytes, one block takes at least %lu\n",
+                  (unsigned long)c_stream.total_out, (unsigned long)(huffman_bits(freq) / 8));
+#else
+        Z_UNUSED(blocks);
+        Z_UNUSED(freq);
+#endif
+    }
+    printf("deflate block split: OK\n");
+}
+
+/* ===========================================================================
+ * Inflate the raw deflate stream in compr into out with Z_TREES, recording the bit offsets where each block starts
+ * in start[] and where its header ends in end[], up to max of them. Returns the number of blocks.
+ */
+static unsigned inflate_headers(unsigned char *compr, size_t comprLen, unsigned char *out, size_t outLen,
+                                z_off64_t *start, z_off64_t *end, unsigned max) {
+    PREFIX3(stream) d_stream; /* decompression stream */
+    unsigned n = 0;
+    int err;
+
+    memset(&d_stream, 0, sizeof(d_stream));
+    err = PREFIX(inflateInit2)(&d_stream, -MAX_WBITS);
+    CHECK_ERR(err, "inflateInit2");
+    d_stream.next_in = compr;
+    d_stream.avail_in = (uint32_t)comprLen;
+    d_stream.next_out = out;
+    d_stream.avail_out = (uint32_t)outLen;
+    if (max)
+        start[0] = 0;
+    do {
+        err = PREFIX(inflate)(&d_stream, Z_TREES);
+        if (err != Z_OK)
+            break;
+        if ((d_stream.data_type & 256) && n < max)
+            end[n] = (z_off64_t)d_stream.total_in * 8 - (d_stream.data_type & 7);
+        if (d_stream.data_type & 256)
+            n++;
+        else if ((d_stream.data_type & 192) == 128 && n < max)
+            start[n] = (z_off64_t)d_stream.total_in * 8 - (d_stream.data_type & 7);
+    } while (1);
+    if (err != Z_STREAM_END)
+        error("inflate with Z_TREES: %d\n", err);
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+    return n;
+}
+
+/* ===========================================================================
+ * Value of the n bits of buf starting at bit pos, in deflate's bit order
+ */
+static unsigned get_bits(const unsigned char *buf, z_off64_t pos, int n) {
+    unsigned val = 0;
+
+    for (int i = 0; i < n; i++)
+        val |= (unsigned)((buf[(pos + i) >> 3] >> ((pos + i) & 7)) & 1) << i;
+    return val;
+}
+
+#ifndef NO_TREE_REUSE
+/* ===========================================================================
+ * True if len bits of a starting at bit apos equal those of b starting at bit bpos
+ */
+static int same_bits(const unsigned char *a, z_off64_t apos, const unsigned char *b, z_off64_t bpos, z_off64_t len) {
+    for (z_off64_t i = 0; i < len; i++) {
+        if (get_bits(a, apos + i, 1) != get_bits(b, bpos + i, 1))
+            return 0;
+    }
+    return 1;
+}
+#endif
+
+/* ===========================================================================
+ * Test deflate() reusing the trees of the previous block for a block of similar data
+ */
+static void test_deflate_tree_reuse(void) {
+    PREFIX3(stream) c_stream; /* compression stream */
+    const unsigned chunk = 12000;
+    static unsigned char data[24000], compr[2][24000], uncompr[24000];
+    z_off64_t start[2][2], end[2][2], block_bits, fresh_bits;
+    size_t comprLen[2];
+    uint32_t seed = 11;
+    unsigned blocks;
+    int err;
+
+    /* Two chunks drawn from one skewed distribution, their best trees are close but not the same */
+    for (unsigned i = 0; i < 2 * chunk; i++) {
+        uint32_t r = next_random(&seed);
+        data[i] = (unsigned char)('a' + ((r >> 16) & 15) + ((r >> 24) & 15));
+    }
+
+    /* Both chunks in one stream, each in a block of its own, and the second chunk alone */
+    for (int k = 0; k < 2; k++) {
+        memset(&c_stream, 0, sizeof(c_stream));
+        err = PREFIX(deflateInit2)(&c_stream, 6, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_HUFFMAN_ONLY);
+        CHECK_ERR(err, "deflateInit2");
+        c_stream.next_out = compr[k];
+        c_stream.avail_out = sizeof(compr[k]);
+        if (k == 0) {
+            c_stream.next_in = data;
+            c_stream.avail_in = chunk;
+            err = PREFIX(deflate)(&c_stream, Z_BLOCK);
+            CHECK_ERR(err, "deflate");
+        }
+        c_stream.next_in = data + chunk;
+        c_stream.avail_in = chunk;
+        err = PREFIX(deflate)(&c_stream, Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("deflate tree reuse: %d\n", err);
+        comprLen[k] = (size_t)c_stream.total_out;
+        err = PREFIX(deflateEnd)(&c_stream);
+        CHECK_ERR(err, "deflateEnd");
+    }
+
+    blocks = inflate_headers(compr[0], comprLen[0], uncompr, sizeof(uncompr), start[0], end[0], 2);
+    if (blocks != 2 || memcmp(uncompr, data, sizeof(data)))
+        error("inflate tree reuse: %u blocks\n", blocks);
+    blocks = inflate_headers(compr[1], comprLen[1], uncompr, sizeof(uncompr), start[1], end[1], 1);
+    if (blocks != 1 || memcmp(uncompr, data + chunk, chunk))
+        error("inflate tree reuse: %u blocks alone\n", blocks);
+
+    /* The second block beats the fixed codes, which take at least 8 bits a literal, and costs little more than
+     * trees built for it alone
+     */
+    block_bits = (z_off64_t)comprLen[0] * 8 - start[0][1];
+    fresh_bits = (z_off64_t)comprLen[1] * 8;
+    if (get_bits(compr[0], start[0][1] + 1, 2) != 2 || block_bits >= (z_off64_t)chunk * 8 ||
+        block_bits > fresh_bits + fresh_bits / 64)
+        error("deflate tree reuse: %ld bits, %ld on its own\n", (long)block_bits, (long)fresh_bits);
+
+#ifndef NO_TREE_REUSE
+    /* Its header is a copy of the first block's, where trees built for it alone would differ */
+    if (end[0][1] - start[0][1] != end[0][0] - start[0][0] ||
+        !same_bits(compr[0], start[0][0] + 3, compr[0], start[0][1] + 3, end[0][0] - start[0][0] - 3))
+        error("deflate tree reuse: second block has trees of its own\n");
+    if (end[1][0] - start[1][0] == end[0][0] - start[0][0] &&
+        same_bits(compr[1], start[1][0] + 3, compr[0], start[0][0] + 3, end[1][0] - start[1][0] - 3))
+        error("deflate tree reuse: both chunks have the same trees\n");
+#endif
+    printf("deflate tree reuse: OK\n");
+}
+
+/* ===========================================================================
+ * Test inflate() with a dynamic table cache shared by two streams
+ */
+static void test_inflate_cache(void) {
+    PREFIX3(stream) c_stream, d_stream; /* compression and decompression streams */
+    unsigned char data[4096], compr[4096], uncompr[4096];
+    inflate_cache *cache;
+    unsigned long comprLen, codesUsed = 0;
+    int err;
+
+    test_data(data, sizeof(data), 4, 7);
+
+    memset(&c_stream, 0, sizeof(c_stream));
+    err = PREFIX(deflateInit)(&c_stream, Z_BEST_COMPRESSION);
+    CHECK_ERR(err, "deflateInit");
+    c_stream.next_in = data;
+    c_stream.avail_in = sizeof(data);
+    c_stream.next_out = compr;
+    c_stream.avail_out = sizeof(compr);
+    err = PREFIX(deflate)(&c_stream, Z_FINISH);
+    if (err != Z_STREAM_END)
+        error("deflate for cache: %d\n", err);
+    comprLen = (unsigned long)c_stream.total_out;
+    err = PREFIX(deflateEnd)(&c_stream);
+    CHECK_ERR(err, "deflateEnd");
+
+    cache = PREFIX(inflateCacheCreate)(0);
+    if (cache == NULL)
+        error("inflateCacheCreate failed\n");
+
+    memset(&d_stream, 0, sizeof(d_stream));
+    err = PREFIX(inflateInit)(&d_stream);
+    CHECK_ERR(err, "inflateInit");
+    err = PREFIX(inflateSetCache)(&d_stream, cache);
+    CHECK_ERR(err, "inflateSetCache");
+
+    for (int pass = 0; pass < 2; pass++) {
+        err = PREFIX(inflateReset)(&d_stream);
+        CHECK_ERR(err, "inflateReset");
+        d_stream.next_in = compr;
+        d_stream.avail_in = (uint32_t)comprLen;
+        d_stream.next_out = uncompr;
+        d_stream.avail_out = sizeof(uncompr);
+        err = PREFIX(inflate)(&d_stream, Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("inflate with cache pass %d: %d\n", pass, err);
+        if (d_stream.total_out != sizeof(data) || memcmp(uncompr, data, sizeof(data)) != 0)
+            error("bad inflate with cache pass %d\n", pass);
+
+        /* Only the first pass builds the literal/length and distance tables, the second one finds them in the
+         * cache and only uses codes[] for the code length code */
+        if (pass == 1 && PREFIX(inflateCodesUsed)(&d_stream) >= codesUsed)
+            error("inflate cache not used\n");
+        codesUsed = PREFIX(inflateCodesUsed)(&d_stream);
+    }
+
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+    PREFIX(inflateCacheFree)(cache);
+    printf("inflateSetCache(): OK\n");
+}
+
+/* ===========================================================================
+ * Test inflateInitOneShot() with input and output provided in small pieces of
+ * one contiguous buffer
+ */
+static void test_inflate_one_shot(void) {
+    PREFIX3(stream) d_stream; /* decompression stream */
+    const size_t len = 128*1024;
+    z_uintmax_t comprLen = PREFIX(compressBound)(len);
+    unsigned char *data, *compr, *uncompr;
+    int err;
+
+    data = test_data(NULL, len, 16, 3);
+    compr = (unsigned char *)malloc(comprLen);
+    uncompr = (unsigned char *)malloc(len);
+    if (compr == NULL || uncompr == NULL)
+        error("out of memory\n");
+
+    err = PREFIX(compress)(compr, &comprLen, data, len);
+    CHECK_ERR(err, "compress");
+
+    memset(&d_stream, 0, sizeof(d_stream));
+    err = PREFIX(inflateInitOneShot)(&d_stream, MAX_WBITS);
+    CHECK_ERR(err, "inflateInitOneShot");
+
+    d_stream.next_in = compr;
+    d_stream.next_out = uncompr;
+    do {
+        d_stream.avail_in = (uint32_t)MIN(97, comprLen - d_stream.total_in);
+        d_stream.avail_out = (uint32_t)MIN(1009, len - d_stream.total_out);
+        err = PREFIX(inflate)(&d_stream, Z_NO_FLUSH);
+    } while (err == Z_OK);
+    if (err != Z_STREAM_END)
+        error("inflate one shot: %d\n", err);
+    if (d_stream.total_out != len || memcmp(uncompr, data, len) != 0)
+        error("bad inflate one shot\n");
+
+    if (PREFIX(inflateSetDictionary)(&d_stream, (const unsigned char *)dictionary, (int)sizeof(dictionary)) != Z_STREAM_ERROR)
+        error("inflateSetDictionary on one shot stream\n");
+
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+    printf("inflateInitOneShot(): OK\n");
+
+    free(data);
+    free(compr);
+    free(uncompr);
+}
+
+/* ===========================================================================
+ * Test inflateVerify() on a valid gzip stream and with a corrupted trailer
+ */
+static void test_inflate_verify(void) {
+    PREFIX3(stream) c_stream, d_stream; /* compression and decompression streams */
+    const size_t len = 200*1000;
+    size_t comprLen = len + len/8 + 64;
+    unsigned char *data, *compr;
+    unsigned long compressed;
+    int err;
+
+    data = test_data(NULL, len, 8, 11);
+    compr = (unsigned char *)malloc(comprLen);
+    if (compr == NULL)
+        error("out of memory\n");
+
+    memset(&c_stream, 0, sizeof(c_stream));
+    err = PREFIX(deflateInit2)(&c_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+    CHECK_ERR(err, "deflateInit2");
+    c_stream.next_in = data;
+    c_stream.avail_in = (uint32_t)len;
+    c_stream.next_out = compr;
+    c_stream.avail_out = (uint32_t)comprLen;
+    err = PREFIX(deflate)(&c_stream, Z_FINISH);
+    if (err != Z_STREAM_END)
+        error("deflate for verify: %d\n", err);
+    compressed = (unsigned long)c_stream.total_out;
+    err = PREFIX(deflateEnd)(&c_stream);
+    CHECK_ERR(err, "deflateEnd");
+
+    for (int corrupt = 0; corrupt < 2; corrupt++) {
+        /* Flip a bit of the CRC-32 in the gzip trailer on the second pass */
+        if (corrupt)
+            compr[compressed - 8] ^= 1;
+
+        memset(&d_stream, 0, sizeof(d_stream));
+        err = PREFIX(inflateInit2)(&d_stream, MAX_WBITS + 16);
+        CHECK_ERR(err, "inflateInit2");
+
+        /* No output buffer at all, input in pieces */
+        d_stream.next_in = compr;
+        do {
+            d_stream.avail_in = (uint32_t)MIN(4093, compressed - d_stream.total_in);
+            err = PREFIX(inflateVerify)(&d_stream, Z_NO_FLUSH);
+        } while (err == Z_OK);
+
+        if (err != (corrupt ? Z_DATA_ERROR : Z_STREAM_END))
+            error("inflateVerify %s stream: %d\n", corrupt ? "corrupt" : "valid", err);
+        if (!corrupt && d_stream.total_out != len)
+            error("inflateVerify length %lu, expected %lu\n", (unsigned long)d_stream.total_out, (unsigned long)len);
+
+        err = PREFIX(inflateEnd)(&d_stream);
+        CHECK_ERR(err, "inflateEnd");
+    }
+    printf("inflateVerify(): OK\n");
+
+    free(data);
+    free(compr);
+}
+
+/* ===========================================================================
+ * Test compressBatch() against compress2() on items of mixed sizes
+ */
+#define BATCH_ITEMS 40
+
+static void test_compress_batch(void) {
+    compress_item items[BATCH_ITEMS];
+    const size_t len = 64*1024;
+    unsigned char *data, *compr, *expect;
+    z_uintmax_t bound = PREFIX(compressBound)(len), expectLen;
+    int err;
+
+    data = test_data(NULL, len, 8, 17);
+    compr = (unsigned char *)malloc(bound * BATCH_ITEMS);
+    expect = (unsigned char *)malloc(bound);
+    if (compr == NULL || expect == NULL)
+        error("out of memory\n");
+
+    for (int level = 1; level <= 9; level += 4) {
+        for (int i = 0; i < BATCH_ITEMS; i++) {
+            /* From a few bytes up to past the window size, the last item does not fit in its buffer */
+            items[i].source = data + i * 97;
+            items[i].sourceLen = (unsigned long)(((size_t)i * i * 29 + 3) % (len - i * 97));
+            items[i].dest = compr + i * bound;
+            items[i].destLen = i == BATCH_ITEMS - 1 ? 10 : (unsigned long)bound;
+        }
+        err = PREFIX(compressBatch)(items, BATCH_ITEMS, level, 3);
+        CHECK_ERR(err, "compressBatch");
+
+        for (int i = 0; i < BATCH_ITEMS; i++) {
+            expectLen = i == BATCH_ITEMS - 1 ? 10 : bound;
+            err = PREFIX(compress2)(expect, &expectLen, items[i].source, items[i].sourceLen, level);
+            if (items[i].status != err || items[i].destLen != expectLen ||
+                (err == Z_OK && memcmp(items[i].dest, expect, expectLen) != 0))
+                error("compressBatch level %d item %d: %d, compress2: %d\n", level, i, items[i].status, err);
+        }
+    }
+    if (items[BATCH_ITEMS - 1].status != Z_BUF_ERROR)
+        error("compressBatch into a short buffer: %d\n", items[BATCH_ITEMS - 1].status);
+
+    printf("compressBatch(): OK\n");
+
+    free(data);
+    free(compr);
+    free(expect);
+}
+
+/* ===========================================================================
+ * Test adler32_multi() and crc32_multi() against one call per buffer
+ */
+#define MULTI_ITEMS 61
+
+static void test_checksum_multi(void) {
+    static const size_t edge[] = { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 1500, 5552, 5553, 11104, 11200 };
+    const unsigned char *buf[MULTI_ITEMS];
+    size_t len[MULTI_ITEMS];
+    unsigned long adler[MULTI_ITEMS], crc[MULTI_ITEMS];
+    const size_t size = 64*1024;
+    unsigned char *data;
+
+    /* The second half is all 0xff, the worst case for the Adler-32 sums */
+    data = test_data(NULL, size, 1, 29);
+    memset(data + size / 2, 0xff, size / 2);
+
+    for (int i = 0; i < MULTI_ITEMS; i++) {
+        size_t off = (size_t)i * 523 % (size / 4);
+        len[i] = i < (int)(sizeof(edge) / sizeof(edge[0])) ? edge[i] : (size_t)i * i * 37 % 1600;
+        if (i % 3 == 1)
+            off += size / 2;
+        buf[i] = data + off;
+        adler[i] = i % 4 ? PREFIX(adler32)(1, data + i, (unsigned)i) : 1;
+        crc[i] = i % 4 ? PREFIX(crc32)(0, data + i, (unsigned)i) : 0;
+    }
+
+    PREFIX(adler32_multi)(adler, buf, len, MULTI_ITEMS);
+    PREFIX(crc32_multi)(crc, buf, len, MULTI_ITEMS);
+
+    for (int i = 0; i < MULTI_ITEMS; i++) {
+        unsigned long expect_adler = PREFIX(adler32_z)(i % 4 ? PREFIX(adler32)(1, data + i, (unsigned)i) : 1,
+                                                      buf[i], len[i]);
+        unsigned long expect_crc = PREFIX(crc32_z)(i % 4 ? PREFIX(crc32)(0, data + i, (unsigned)i) : 0,
+                                                  buf[i], len[i]);
+        if (adler[i] != expect_adler)
+            error("adler32_multi item %d length %lu: %08lx, expected %08lx\n", i, (unsigned long)len[i],
+                  adler[i], expect_adler);
+        if (crc[i] != expect_crc)
+            error("crc32_multi item %d length %lu: %08lx, expected %08lx\n", i, (unsigned long)len[i],
+                  crc[i], expect_crc);
+    }
+
+    printf("adler32_multi(), crc32_multi(): OK\n");
+
+    free(data);
+}
+
+/* ===========================================================================
+ * Test adler32_parallel() and crc32_parallel() against the single-threaded checksums
+ */
+static void test_checksum_parallel(void) {
+    /* Long enough for several slices, with an odd length so the last slice is short */
+    const size_t size = 9*1024*1024 + 4093;
+    unsigned long adler, crc, expect_adler, expect_crc;
+    unsigned char *data;
+
+    data = test_data(NULL, size, 1, 31);
+    for (size_t i = 0; i < size; i += 3)
+        data[i] = 0xff;
+
+    expect_adler = PREFIX(adler32_z)(0x12345678 % 65521, data, size);
+    expect_crc = PREFIX(crc32_z)(0x12345678, data, size);
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        adler = PREFIX(adler32_parallel)(0x12345678 % 65521, data, size, threads);
+        crc = PREFIX(crc32_parallel)(0x12345678, data, size, threads);
+        if (adler != expect_adler)
+            error("adler32_parallel with %d threads: %08lx, expected %08lx\n", threads, adler, expect_adler);
+        if (crc != expect_crc)
+            error("crc32_parallel with %d threads: %08lx, expected %08lx\n", threads, crc, expect_crc);
+    }
+
+    /* Short buffers take the single-threaded path */
+    if (PREFIX(crc32_parallel)(0, data, 1000, 4) != PREFIX(crc32_z)(0, data, 1000))
+        error("crc32_parallel short buffer mismatch\n");
+
+    printf("adler32_parallel(), crc32_parallel(): OK\n");
+
+    free(data);
+}
+
+/* ===========================================================================
+ * Test crc32_combine_gen_multi() and the operators it generates
+ */
+#define COMBINE_ITEMS 23
+
+static void test_crc32_combine_gen_multi(void) {
+    const size_t size = 70000;
+    z_off64_t len2[COMBINE_ITEMS];
+    unsigned long op[COMBINE_ITEMS];
+    unsigned long crc1, crc2, crc;
+    unsigned char *data;
+
+    data = test_data(NULL, size, 1, 37);
+
+    for (int i = 0; i < COMBINE_ITEMS; i++)
+        len2[i] = i < 8 ? i : (z_off64_t)i * i * i * 5 + i;
+    PREFIX(crc32_combine_gen_multi)(op, len2, COMBINE_ITEMS);
+
+    crc1 = PREFIX(crc32)(0, data, 100);
+    for (int i = 0; i < COMBINE_ITEMS; i++) {
+        if (op[i] != PREFIX(crc32_combine_gen)((z_off_t)len2[i]))
+            error("crc32_combine_gen_multi item %d: %08lx, expected %08lx\n", i, op[i],
+                  PREFIX(crc32_combine_gen)((z_off_t)len2[i]));
+        crc2 = PREFIX(crc32_z)(0, data + 100, (size_t)len2[i]);
+        crc = PREFIX(crc32_combine_op)(crc1, crc2, op[i]);
+        if (crc != PREFIX(crc32_z)(0, data, 100 + (size_t)len2[i]))
+            error("crc32_combine_op length %lu: %08lx, expected %08lx\n", (unsigned long)len2[i], crc,
+                  PREFIX(crc32_z)(0, data, 100 + (size_t)len2[i]));
+    }
+
+    printf("crc32_combine_gen_multi(): OK\n");
+
+    free(data);
+}
+
+/* ===========================================================================
+ * Test crc32c() and crc64() against their check values, piecewise against whole, and their copy and combine
+ */
+static void test_crc32c_crc64(void) {
+    const size_t size = 5000;
+    static const unsigned char check[] = "123456789";
+    unsigned long c32, c32_whole;
+    uint64_t c64, c64_whole;
+    unsigned char *data, *copy;
+
+    c32 = PREFIX(crc32c)(PREFIX(crc32c)(0, NULL, 0), check, 9);
+    if (c32 != 0xe3069283)
+        error("crc32c check value: %08lx\n", c32);
+    c64 = PREFIX(crc64)(0, check, 9);
+    if (c64 != 0x995dc9bbdf1939faULL)
+        error("crc64 check value: %016llx\n", (unsigned long long)c64);
+
+    data = test_data(NULL, size, 1, 41);
+    copy = (unsigned char *)malloc(size);
+    if (copy == NULL)
+        error("out of memory\n");
+
+    c32_whole = PREFIX(crc32c)(0, data, size);
+    c64_whole = PREFIX(crc64)(0, data, size);
+    for (size_t split = 0; split < size; split += split < 100 ? 1 : 397) {
+        /* Odd offsets and lengths take the folding loops through every tail length */
+        c32 = PREFIX(crc32c)(PREFIX(crc32c)(0, data, split), data + split, size - split);
+        if (c32 != c32_whole)
+            error("crc32c split at %lu: %08lx, expected %08lx\n", (unsigned long)split, c32, c32_whole);
+        c64 = PREFIX(crc64)(PREFIX(crc64)(0, data, split), data + split, size - split);
+        if (c64 != c64_whole)
+            error("crc64 split at %lu: %016llx\n", (unsigned long)split, (unsigned long long)c64);
+
+        c32 = PREFIX(crc32c_combine)(PREFIX(crc32c)(0, data, split), PREFIX(crc32c)(0, data + split, size - split),
+                                     (z_off64_t)(size - split));
+        if (c32 != c32_whole)
+            error("crc32c_combine at %lu: %08lx, expected %08lx\n", (unsigned long)split, c32, c32_whole);
+        c64 = PREFIX(crc64_combine)(PREFIX(crc64)(0, data, split), PREFIX(crc64)(0, data + split, size - split),
+                                    (z_off64_t)(size - split));
+        if (c64 != c64_whole)
+            error("crc64_combine at %lu: %016llx\n", (unsigned long)split, (unsigned long long)c64);
+
+        memset(copy, 0, size);
+        c32 = PREFIX(crc32c_copy)(PREFIX(crc32c)(0, data, split), copy + split, data + split, size - split);
+        c64 = PREFIX(crc64_copy)(PREFIX(crc64)(0, data, split), copy, data + split, size - split);
+        if (c32 != c32_whole || c64 != c64_whole || memcmp(copy, data + split, size - split) != 0)
+            error("crc32c_copy/crc64_copy at %lu: bad checksum or copy\n", (unsigned long)split);
+    }
+
+    printf("crc32c(), crc64(): OK\n");
+
+    free(copy);
+    free(data);
+}
+
+/* ===========================================================================
+ * Test deflateGetStats() counters against what each level and strategy must produce
+ */
+static void test_deflate_stats(void) {
+    static const int levels[] = { 0, 1, 6, 9, 6, 6 };
+    static const int strategies[] = { Z_DEFAULT_STRATEGY, Z_DEFAULT_STRATEGY, Z_DEFAULT_STRATEGY,
+                                      Z_DEFAULT_STRATEGY, Z_HUFFMAN_ONLY, Z_RLE };
+    static const int funcs[] = { Z_STATS_STORED, Z_STATS_QUICK, Z_STATS_MEDIUM, Z_STATS_SLOW,
+                                 Z_STATS_HUFF, Z_STATS_RLE };
+    PREFIX3(stream) c_stream;
+    const size_t len = 200*1000;
+    size_t comprLen = len + len/8 + 64;
+    unsigned char *data, *compr;
+    deflate_stats stats;
+    uint64_t lengths, dists;
+    int err;
+
+    data = test_data(NULL, len, 8, 47);
+    compr = (unsigned char *)malloc(comprLen);
+    if (compr == NULL)
+        error("out of memory\n");
+
+    for (int t = 0; t < (int)(sizeof(levels) / sizeof(levels[0])); t++) {
+        memset(&c_stream, 0, sizeof(c_stream));
+        err = PREFIX(deflateInit2)(&c_stream, levels[t], Z_DEFLATED, MAX_WBITS, 8, strategies[t]);
+        CHECK_ERR(err, "deflateInit2");
+        c_stream.next_in = data;
+        c_stream.avail_in = (uint32_t)len;
+        c_stream.next_out = compr;
+        c_stream.avail_out = (uint32_t)comprLen;
+        err = PREFIX(deflate)(&c_stream, Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("deflate for stats: %d\n", err);
+
+        err = PREFIX(deflateGetStats)(&c_stream, &stats);
+        if (err == Z_VERSION_ERROR) {
+            /* built without WITH_DEFLATE_STATS */
+            PREFIX(deflateEnd)(&c_stream);
+            break;
+        }
+        CHECK_ERR(err, "deflateGetStats");
+
+        lengths = dists = 0;
+        for (int i = 0; i < 29; i++)
+            lengths += stats.match_lengths[i];
+        for (int i = 0; i < 30; i++)
+            dists += stats.match_dists[i];
+        if (lengths != stats.matches || dists != stats.matches)
+            error("deflateGetStats level %d: histograms do not add up to %lu matches\n", levels[t],
+                  (unsigned long)stats.matches);
+        if (stats.func_in[funcs[t]] != len || stats.func_out[funcs[t]] == 0 ||
+            stats.func_out[funcs[t]] > c_stream.total_out)
+            error("deflateGetStats level %d: %lu in, %lu out\n", levels[t],
+                  (unsigned long)stats.func_in[funcs[t]], (unsigned long)stats.func_out[funcs[t]]);
+        if (levels[t] == 0 && (stats.blocks[0] == 0 || stats.blocks[1] || stats.blocks[2] || stats.literals))
+            error("deflateGetStats level 0: not only stored blocks\n");
+        if (levels[t] != 0 && (stats.literals == 0 || stats.blocks[0] + stats.blocks[1] + stats.blocks[2] == 0))
+            error("deflateGetStats level %d: no literals or blocks\n", levels[t]);
+        if (strategies[t] == Z_HUFFMAN_ONLY && (stats.matches || stats.literals != len))
+            error("deflateGetStats Z_HUFFMAN_ONLY: %lu literals\n", (unsigned long)stats.literals);
+        if (strategies[t] == Z_RLE && stats.match_dists[0] != stats.matches)
+            error("deflateGetStats Z_RLE: matches not at distance 1\n");
+        if (levels[t] == 6 && strategies[t] == Z_DEFAULT_STRATEGY && (stats.matches == 0 || stats.window_slides == 0))
+            error("deflateGetStats level 6: no matches or window slides\n");
+
+        /* deflateReset() starts the counters over */
+        err = PREFIX(deflateReset)(&c_stream);
+        CHECK_ERR(err, "deflateReset");
+        err = PREFIX(deflateGetStats)(&c_stream, &stats);
+        CHECK_ERR(err, "deflateGetStats");
+        if (stats.literals || stats.matches || stats.func_in[funcs[t]])
+            error("deflateGetStats: counters not reset\n");
+        err = PREFIX(deflateEnd)(&c_stream);
+        CHECK_ERR(err, "deflateEnd");
+    }
+    printf("deflateGetStats(): %s\n", err == Z_VERSION_ERROR ? "not built in" : "OK");
+
+    free(data);
+    free(compr);
+}
+
+/* ===========================================================================
+ * Test inflateScan() on two gzip members, one compressed and one stored, whole and in small pieces
+ */
+#define SCAN_MARKS 64
+
+static void test_inflate_scan(void) {
+    PREFIX3(stream) c_stream, d_stream; /* compression and decompression streams */
+    const size_t len = 200*1000, stored_len = 3000;
+    size_t comprLen = len + len/8 + 256;
+    scan_mark marks[SCAN_MARKS], piece;
+    unsigned count, n, blocks = 0, ends = 0;
+    unsigned char *data, *compr;
+    unsigned long compressed = 0;
+    int err;
+
+    data = test_data(NULL, len, 8, 43);
+    compr = (unsigned char *)malloc(comprLen);
+    if (compr == NULL)
+        error("out of memory\n");
+
+    /* A compressed member of the whole data followed by a stored member of its start */
+    for (int member = 0; member < 2; member++) {
+        int level = member ? Z_NO_COMPRESSION : Z_DEFAULT_COMPRESSION;
+
+        memset(&c_stream, 0, sizeof(c_stream));
+        err = PREFIX(deflateInit2)(&c_stream, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+        CHECK_ERR(err, "deflateInit2");
+        c_stream.next_in = data;
+        c_stream.avail_in = (uint32_t)(member ? stored_len : len);
+        c_stream.next_out = compr + compressed;
+        c_stream.avail_out = (uint32_t)(comprLen - compressed);
+        err = PREFIX(deflate)(&c_stream, Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("deflate for scan: %d\n", err);
+        compressed += (unsigned long)c_stream.total_out;
+        err = PREFIX(deflateEnd)(&c_stream);
+        CHECK_ERR(err, "deflateEnd");
+    }
+
+    memset(&d_stream, 0, sizeof(d_stream));
+    err = PREFIX(inflateInit2)(&d_stream, MAX_WBITS + 16);
+    CHECK_ERR(err, "inflateInit2");
+    d_stream.next_in = compr;
+    d_stream.avail_in = (uint32_t)compressed;
+    count = SCAN_MARKS;
+    err = PREFIX(inflateScan)(&d_stream, Z_FINISH, marks, &count);
+    if (err != Z_STREAM_END)
+        error("inflateScan: %d\n", err);
+    if (d_stream.total_out != len + stored_len || d_stream.total_in != compressed)
+        error("inflateScan totals %lu in, %lu out\n", (unsigned long)d_stream.total_in,
+              (unsigned long)d_stream.total_out);
+    for (unsigned i = 0; i < count; i++) {
+        if (marks[i].type == Z_SCAN_END)
+            ends++;
+        else if (marks[i].type != Z_SCAN_MEMBER)
+            blocks++;
+    }
+    if (count == SCAN_MARKS || marks[0].type != Z_SCAN_MEMBER || marks[0].in != 0 || ends != 2 || blocks < 2 ||
+        marks[count - 1].out != (z_off64_t)(len + stored_len))
+        error("inflateScan marks: %u marks, %u blocks, %u ends\n", count, blocks, ends);
+
+    /* Input a few bytes at a time with room for one mark at a time gives the same marks */
+    err = PREFIX(inflateReset)(&d_stream);
+    CHECK_ERR(err, "inflateReset");
+    d_stream.next_in = compr;
+    d_stream.avail_in = 0;
+    n = 0;
+    do {
+        if (d_stream.avail_in == 0)
+            d_stream.avail_in = (uint32_t)MIN(7, compressed - d_stream.total_in);
+        count = 1;
+        err = PREFIX(inflateScan)(&d_stream, Z_NO_FLUSH, &piece, &count);
+        if (count && (n == SCAN_MARKS || memcmp(&piece, &marks[n++], sizeof(piece)) != 0))
+            error("inflateScan in pieces: mark %u differs\n", n - 1);
+    } while (err == Z_OK || (err == Z_STREAM_END && d_stream.total_in != compressed));
+    if (err != Z_STREAM_END || d_stream.total_out != len + stored_len || marks[n - 1].type != Z_SCAN_END)
+        error("inflateScan in pieces: %d, %lu out\n", err, (unsigned long)d_stream.total_out);
+
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+    printf("inflateScan(): OK\n");
+
+    free(data);
+    free(compr);
+}
+
+/* ===========================================================================
+ * Test inflateSetBlockCallback() against the block boundaries inflateScan() finds, and clearing it
+ */
+#define BLOCK_EVENTS 256
+
+typedef struct block_events_s {
+    inflate_block block[BLOCK_EVENTS];
+    unsigned count;
+} block_events;
+
+static void record_block(void *opaque, const inflate_block *block) {
+    block_events *events = (block_events *)opaque;
+
+    if (events->count < BLOCK_EVENTS)
+        events->block[events->count] = *block;
+    events->count++;
+}
+
+static void test_inflate_block_callback(void) {
+    PREFIX3(stream) c_stream, d_stream; /* compression and decompression streams */
+    const size_t len = 200*1000, stored_len = 3000;
+    size_t comprLen = len + len/8 + 256;
+    scan_mark marks[SCAN_MARKS];
+    block_events *events;
+    unsigned count, n = 0, stored = 0, dynamic = 0;
+    unsigned char *data, *compr, out[1024];
+    int err;
+
+    data = test_data(NULL, len, 8, 47);
+    compr = (unsigned char *)malloc(comprLen);
+    events = (block_events *)calloc(1, sizeof(block_events));
+    if (compr == NULL || events == NULL)
+        error("out of memory\n");
+
+    /* Compressed blocks of the data followed by stored blocks of its start, in one stream */
+    memset(&c_stream, 0, sizeof(c_stream));
+    err = PREFIX(deflateInit)(&c_stream, Z_DEFAULT_COMPRESSION);
+    CHECK_ERR(err, "deflateInit");
+    c_stream.next_in = data;
+    c_stream.avail_in = (uint32_t)len;
+    c_stream.next_out = compr;
+    c_stream.avail_out = (uint32_t)comprLen;
+    err = PREFIX(deflate)(&c_stream, Z_NO_FLUSH);
+    CHECK_ERR(err, "deflate");
+    err = PREFIX(deflateParams)(&c_stream, Z_NO_COMPRESSION, Z_DEFAULT_STRATEGY);
+    CHECK_ERR(err, "deflateParams");
+    c_stream.next_in = data;
+    c_stream.avail_in = (uint32_t)stored_len;
+    err = PREFIX(deflate)(&c_stream, Z_FINISH);
+    if (err != Z_STREAM_END)
+        error("deflate for block callback: %d\n", err);
+    err = PREFIX(deflateEnd)(&c_stream);
+    CHECK_ERR(err, "deflateEnd");
+
+    memset(&d_stream, 0, sizeof(d_stream));
+    err = PREFIX(inflateInit)(&d_stream);
+    CHECK_ERR(err, "inflateInit");
+    d_stream.next_in = compr;
+    d_stream.avail_in = (uint32_t)c_stream.total_out;
+    count = SCAN_MARKS;
+    err = PREFIX(inflateScan)(&d_stream, Z_FINISH, marks, &count);
+    if (err != Z_STREAM_END || count == SCAN_MARKS)
+        error("inflateScan for block callback: %d\n", err);
+
+    /* Inflate a little output at a time, the callback sees every block inflateScan() marked. Its offsets count from
+     * the reset, not from totals that wrap where long is 32 bits.
+     */
+    err = PREFIX(inflateReset)(&d_stream);
+    CHECK_ERR(err, "inflateReset");
+    err = PREFIX(inflateSetBlockCallback)(&d_stream, record_block, events);
+    CHECK_ERR(err, "inflateSetBlockCallback");
+    d_stream.next_in = compr;
+    d_stream.avail_in = (uint32_t)c_stream.total_out;
+    d_stream.total_in = d_stream.total_out = 0xffffff00UL;
+    do {
+        d_stream.next_out = out;
+        d_stream.avail_out = sizeof(out);
+        err = PREFIX(inflate)(&d_stream, Z_NO_FLUSH);
+    } while (err == Z_OK);
+    if (err != Z_STREAM_END || d_stream.total_out - 0xffffff00UL != len + stored_len)
+        error("inflate with block callback: %d, %lu out\n", err, (unsigned long)(d_stream.total_out - 0xffffff00UL));
+
+    for (unsigned i = 0; i < count; i++) {
+        const inflate_block *block = &events->block[n];
+
+        if (marks[i].type > Z_SCAN_DYNAMIC)
+            continue;
+        if (n == events->count || n == BLOCK_EVENTS || block->type != marks[i].type || block->last != marks[i].last ||
+            block->in != marks[i].in || block->out != marks[i].out)
+            error("block callback: block %u differs from inflateScan()\n", n);
+        if (block->type == Z_SCAN_STORED)
+            stored += block->length;
+        if (block->type == Z_SCAN_DYNAMIC && (block->nlen < 257 || block->ndist < 1 || block->ncode < 4))
+            error("block callback: block %u has %u/%u/%u codes\n", n, block->nlen, block->ndist, block->ncode);
+        dynamic += block->type == Z_SCAN_DYNAMIC;
+        n++;
+    }
+    if (n != events->count || stored < stored_len || dynamic == 0)
+        error("block callback: %u of %u blocks, %u stored bytes\n", n, events->count, stored);
+
+    /* Without a callback nothing more is recorded */
+    err = PREFIX(inflateReset)(&d_stream);
+    CHECK_ERR(err, "inflateReset");
+    err = PREFIX(inflateSetBlockCallback)(&d_stream, NULL, NULL);
+    CHECK_ERR(err, "inflateSetBlockCallback");
+    d_stream.next_in = compr;
+    d_stream.avail_in = (uint32_t)c_stream.total_out;
+    do {
+        d_stream.next_out = out;
+        d_stream.avail_out = sizeof(out);
+        err = PREFIX(inflate)(&d_stream, Z_NO_FLUSH);
+    } while (err == Z_OK);
+    if (err != Z_STREAM_END || events->count != n)
+        error("inflate after clearing block callback: %d\n", err);
+
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+    printf("inflateSetBlockCallback(): OK\n");
+
+    free(events);
+    free(data);
+    free(compr);
+}
+
+/* ===========================================================================
+ * Test deflateGetProfile(), inflateGetProfile() and the totals of ended streams
+ */
+static void test_profile(void) {
+    PREFIX3(stream) c_stream, d_stream; /* compression and decompression streams */
+    const size_t len = 200*1000;
+    size_t comprLen = len + len/8 + 64;
+    unsigned char *data, *compr, *uncompr;
+    z_profile deflated, inflated, totals;
+    char dump[2048];
+    int err, n;
+
+    data = test_data(NULL, len, 8, 53);
+    compr = (unsigned char *)malloc(comprLen);
+    uncompr = (unsigned char *)malloc(len);
+    if (compr == NULL || uncompr == NULL)
+        error("out of memory\n");
+
+    err = PREFIX(zlibGetProfile)(&totals, 1);
+    if (err == Z_VERSION_ERROR) {
+        /* built without WITH_PROFILE */
+        printf("zlibGetProfile(): not built in\n");
+        free(data);
+        free(compr);
+        free(uncompr);
+        return;
+    }
+    CHECK_ERR(err, "zlibGetProfile");
+
+    memset(&c_stream, 0, sizeof(c_stream));
+    err = PREFIX(deflateInit)(&c_stream, Z_DEFAULT_COMPRESSION);
+    CHECK_ERR(err, "deflateInit");
+    c_stream.next_in = data;
+    c_stream.avail_in = (uint32_t)len;
+    c_stream.next_out = compr;
+    c_stream.avail_out = (uint32_t)comprLen;
+    err = PREFIX(deflate)(&c_stream, Z_FINISH);
+    if (err != Z_STREAM_END)
+        error("deflate for profile: %d\n", err);
+    err = PREFIX(deflateGetProfile)(&c_stream, &deflated);
+    CHECK_ERR(err, "deflateGetProfile");
+    if (deflated.calls[Z_PROFILE_DEFLATE] == 0 || deflated.calls[Z_PROFILE_LONGEST_MATCH] == 0 ||
+        deflated.calls[Z_PROFILE_FLUSH_BLOCK] == 0 || deflated.calls[Z_PROFILE_READ_BUF] == 0 ||
+        deflated.ticks[Z_PROFILE_FILL_WINDOW] < deflated.ticks[Z_PROFILE_READ_BUF] ||
+        deflated.ticks[Z_PROFILE_FLUSH_BLOCK] < deflated.ticks[Z_PROFILE_COMPRESS_BLOCK] ||
+        deflated.calls[Z_PROFILE_INFLATE])
+        error("deflateGetProfile: phases missing or not nested\n");
+
+    memset(&d_stream, 0, sizeof(d_stream));
+    err = PREFIX(inflateInit)(&d_stream);
+    CHECK_ERR(err, "inflateInit");
+    d_stream.next_in = compr;
+    d_stream.avail_in = (uint32_t)c_stream.total_out;
+    d_stream.next_out = uncompr;
+    d_stream.avail_out = (uint32_t)len;
+    err = PREFIX(inflate)(&d_stream, Z_FINISH);
+    if (err != Z_STREAM_END || memcmp(data, uncompr, len))
+        error("inflate for profile: %d\n", err);
+    err = PREFIX(inflateGetProfile)(&d_stream, &inflated);
+    CHECK_ERR(err, "inflateGetProfile");
+    if (inflated.calls[Z_PROFILE_INFLATE] != 1 || inflated.calls[Z_PROFILE_INFLATE_FAST] == 0 ||
+        inflated.calls[Z_PROFILE_INFLATE_TABLE] == 0 || inflated.calls[Z_PROFILE_INFLATE_CHECK] == 0 ||
+        inflated.ticks[Z_PROFILE_INFLATE] < inflated.ticks[Z_PROFILE_INFLATE_FAST] ||
+        inflated.calls[Z_PROFILE_DEFLATE])
+        error("inflateGetProfile: phases missing or not nested\n");
+
+    /* Ending the streams adds their totals to the global ones */
+    err = PREFIX(deflateEnd)(&c_stream);
+    CHECK_ERR(err, "deflateEnd");
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+    err = PREFIX(zlibGetProfile)(&totals, 1);
+    CHECK_ERR(err, "zlibGetProfile");
+    for (int i = 0; i < Z_PROFILE_PHASES; i++) {
+        if (totals.calls[i] != deflated.calls[i] + inflated.calls[i] ||
+            totals.ticks[i] != deflated.ticks[i] + inflated.ticks[i])
+            error("zlibGetProfile: phase %d totals differ\n", i);
+    }
+
+    n = PREFIX(zlibProfileDump)(&totals, dump, sizeof(dump));
+    if (n <= 0 || n >= (int)sizeof(dump) || strstr(dump, "longest_match") == NULL ||
+        strstr(dump, "(state machine)") == NULL || PREFIX(zlibProfileDump)(&totals, dump, 16) != n ||
+        strlen(dump) != 15)
+        error("zlibProfileDump: %d\n", n);
+    printf("zlibGetProfile(): OK\n");
+
+    free(data);
+    free(compr);
+    free(uncompr);
+}
+
+/* ===========================================================================
+ * Test zlibSetDispatch() capping and pinning the functions zlibGetDispatch() reports
+ */
+static void dispatch_compress(const unsigned char *in, z_uintmax_t len, unsigned char packed[2][70000],
+                              z_uintmax_t packed_len[2]) {
+    int err;
+
+    /* Levels 1 and 4 run deflate_quick and deflate_medium, which have per-cpu variants */
+    for (int i = 0; i < 2; i++) {
+        packed_len[i] = 70000;
+        err = PREFIX(compress2)(packed[i], &packed_len[i], in, len, i ? 4 : 1);
+        CHECK_ERR(err, "compress2");
+    }
+}
+
+static void test_dispatch(void) {
+    static const char data[] = "hello, hello! dispatch gives the same checksums whichever functions it picks";
+    static unsigned char in[65536], packed[2][2][70000];
+    z_uintmax_t packed_len[2][2];
+    char info[4096];
+    uint32_t adler, crc;
+    int err, n;
+
+    n = PREFIX(zlibGetDispatch)(info, sizeof(info));
+    if (n <= 0 || n >= (int)sizeof(info) || strncmp(info, "features:", 9))
+        error("zlibGetDispatch: %d\n", n);
+    err = PREFIX(zlibSetDispatch)("");
+    if (err == Z_VERSION_ERROR) {
+        /* built without runtime CPU detection */
+        printf("zlibSetDispatch(): not built in\n");
+        return;
+    }
+    CHECK_ERR(err, "zlibSetDispatch");
+    adler = (uint32_t)PREFIX(adler32)(1, (const unsigned char *)data, (uint32_t)strlen(data));
+    crc = (uint32_t)PREFIX(crc32)(0, (const unsigned char *)data, (uint32_t)strlen(data));
+    test_data(in, sizeof(in), 8, 59);
+    dispatch_compress(in, sizeof(in), packed[0], packed_len[0]);
+
+    err = PREFIX(zlibSetDispatch)("isa=sse2, crc32=braid");
+    CHECK_ERR(err, "zlibSetDispatch");
+    PREFIX(zlibGetDispatch)(info, sizeof(info));
+    if (strstr(info, "isa: sse2\n") == NULL || strstr(info, "crc32: crc32_braid\n") == NULL ||
+        strstr(strchr(info, '\n'), "avx") != NULL)
+        error("zlibSetDispatch: not capped or pinned:\n%s", info);
+    if (PREFIX(adler32)(1, (const unsigned char *)data, (uint32_t)strlen(data)) != adler ||
+        PREFIX(crc32)(0, (const unsigned char *)data, (uint32_t)strlen(data)) != crc)
+        error("zlibSetDispatch: checksums differ\n");
+    dispatch_compress(in, sizeof(in), packed[1], packed_len[1]);
+    for (int i = 0; i < 2; i++) {
+        if (packed_len[0][i] != packed_len[1][i] || memcmp(packed[0][i], packed[1][i], (size_t)packed_len[0][i]))
+            error("zlibSetDispatch: level %d output differs\n", i ? 4 : 1);
+    }
+
+    /* An invalid spec leaves the choice as it was */
+    if (PREFIX(zlibSetDispatch)("crc32") != Z_STREAM_ERROR || PREFIX(zlibSetDispatch)("isa=none") != Z_STREAM_ERROR ||
+        PREFIX(zlibSetDispatch)("no_such_function=c") != Z_STREAM_ERROR)
+        error("zlibSetDispatch: invalid spec accepted\n");
+    PREFIX(zlibGetDispatch)(info, sizeof(info));
+    if (strstr(info, "crc32: crc32_braid\n") == NULL)
+        error("zlibSetDispatch: invalid spec changed the choice\n");
+
+    err = PREFIX(zlibSetDispatch)(NULL);
+    CHECK_ERR(err, "zlibSetDispatch");
+    printf("zlibSetDispatch(): OK\n");
+}
+
+/* ===========================================================================
+ * Test streams kept in a caller-provided workspace, which must never allocate
+ */
+static void *workspace_zalloc(void *opaque, unsigned items, unsigned size) {
+    Z_UNUSED(opaque);
+    Z_UNUSED(items);
+    Z_UNUSED(size);
+    error("workspace stream called zalloc\n");
+    return NULL;
+}
+
+static void workspace_zfree(void *opaque, void *ptr) {
+    Z_UNUSED(opaque);
+    Z_UNUSED(ptr);
+    error("workspace stream called zfree\n");
+}
+
+static void test_workspace(void) {
+    static unsigned char in[50000], packed[60000], out[50000];
+    PREFIX3(stream) c_stream, d_stream;
+    size_t dsize, isize;
+    unsigned char *work;
+    int err;
+
+    test_data(in, sizeof(in), 8, 61);
+
+    dsize = PREFIX(deflateWorkspaceSize)(-MAX_WBITS, 8);
+    isize = PREFIX(inflateWorkspaceSize)(MAX_WBITS);
+    if (dsize == 0 || isize == 0 || PREFIX(deflateWorkspaceSize)(MAX_WBITS, 0) != 0)
+        error("workspace sizes: %lu %lu\n", (unsigned long)dsize, (unsigned long)isize);
+    work = (unsigned char *)malloc(dsize + isize + 1);
+    if (work == NULL)
+        error("out of memory\n");
+
+    memset(&c_stream, 0, sizeof(c_stream));
+    c_stream.zalloc = workspace_zalloc;
+    c_stream.zfree = workspace_zfree;
+    err = PREFIX(deflateInitWorkspace)(&c_stream, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY, work + 1,
+                                       dsize - 1);
+    if (err != Z_MEM_ERROR)
+        error("deflateInitWorkspace: too small a workspace accepted\n");
+    /* Misaligned on purpose */
+    err = PREFIX(deflateInitWorkspace)(&c_stream, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY, work + 1, dsize);
+    CHECK_ERR(err, "deflateInitWorkspace");
+    c_stream.next_in = in;
+    c_stream.avail_in = sizeof(in);
+    c_stream.next_out = packed;
+    c_stream.avail_out = sizeof(packed);
+    err = PREFIX(deflate)(&c_stream, Z_FINISH);
+    if (err != Z_STREAM_END)
+        error("deflate: %d\n", err);
+    err = PREFIX(deflateEnd)(&c_stream);
+    CHECK_ERR(err, "deflateEnd");
+
+    memset(&d_stream, 0, sizeof(d_stream));
+    d_stream.zalloc = workspace_zalloc;
+    d_stream.zfree = workspace_zfree;
+    err = PREFIX(inflateInitWorkspace)(&d_stream, -MAX_WBITS, work + 1 + dsize, isize);
+    CHECK_ERR(err, "inflateInitWorkspace");
+    d_stream.next_in = packed;
+    d_stream.avail_in = (uint32_t)c_stream.total_out;
+    d_stream.next_out = out;
+    d_stream.avail_out = sizeof(out);
+    err = PREFIX(inflate)(&d_stream, Z_FINISH);
+    if (err != Z_STREAM_END)
+        error("inflate: %d\n", err);
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+    if (d_stream.total_out != sizeof(in) || memcmp(in, out, sizeof(in)))
+        error("workspace round trip differs\n");
+
+    free(work);
+    printf("deflateInitWorkspace(): OK\n");
+}
+
+/* ===========================================================================
+ * Test streams with their state on huge pages, from the default allocator and from zlibHugeAlloc()
+ */
+static void test_hugepages(void) {
+    static unsigned char in[100000], packed[2][110000], out[100000];
+    PREFIX3(stream) c_stream[2], d_stream;
+    int built, err;
+
+    for (size_t i = 0; i < sizeof(in); i++)
+        in[i] = (unsigned char)hello[(i / 5 + i % 11) % strlen(hello)];
+
+    err = PREFIX(zlibSetHugePages)(1);
+    built = err != Z_VERSION_ERROR;
+    if (built)
+        CHECK_ERR(err, "zlibSetHugePages");
+
+    /* Two streams open at once, so the second takes its state from the slab of the first */
+    for (int n = 0; n < 2; n++) {
+        memset(&c_stream[n], 0, sizeof(c_stream[n]));
+        if (n == 1) {
+            c_stream[n].zalloc = PREFIX(zlibHugeAlloc);
+            c_stream[n].zfree = PREFIX(zlibHugeFree);
+        }
+        err = PREFIX(deflateInit2)(&c_stream[n], 6 + n, Z_DEFLATED, MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        CHECK_ERR(err, "deflateInit2");
+        c_stream[n].next_in = in;
+        c_stream[n].avail_in = sizeof(in);
+        c_stream[n].next_out = packed[n];
+        c_stream[n].avail_out = sizeof(packed[n]);
+    }
+    for (int n = 0; n < 2; n++) {
+        err = PREFIX(deflate)(&c_stream[n], Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("deflate: %d\n", err);
+    }
+    /* Give the huge pages up before the inflate stream is made, which then comes from malloc() */
+    if (built)
+        PREFIX(zlibSetHugePages)(0);
+    for (int n = 0; n < 2; n++) {
+        err = PREFIX(deflateEnd)(&c_stream[n]);
+        CHECK_ERR(err, "deflateEnd");
+
+        memset(&d_stream, 0, sizeof(d_stream));
+        err = PREFIX(inflateInit)(&d_stream);
+        CHECK_ERR(err, "inflateInit");
+        d_stream.next_in = packed[n];
+        d_stream.avail_in = (uint32_t)c_stream[n].total_out;
+        d_stream.next_out = out;
+        d_stream.avail_out = sizeof(out);
+        err = PREFIX(inflate)(&d_stream, Z_FINISH);
+        if (err != Z_STREAM_END)
+            error("inflate: %d\n", err);
+        err = PREFIX(inflateEnd)(&d_stream);
+        CHECK_ERR(err, "inflateEnd");
+        if (d_stream.total_out != sizeof(in) || memcmp(in, out, sizeof(in)))
+            error("huge page round trip %d differs\n", n);
+    }
+
+    printf("zlibSetHugePages(): %s\n", built ? "OK" : "not built in");
+}
+
+/* ===========================================================================
+ * Test the memory totals of zlibGetMemory() and the budget of zlibSetMemoryBudget()
+ */
+static void test_memory(void) {
+    PREFIX3(stream) c_stream, d_stream, refused;
+    z_memory base, mem;
+    size_t dsize, isize;
+    inflate_cache *cache;
+    int err;
+
+    err = PREFIX(zlibGetMemory)(&base, 1);
+    CHECK_ERR(err, "zlibGetMemory");
+    PREFIX(zlibGetMemory)(&base, 0);
+    if (base.peak != base.current || base.budget != 0)
+        error("zlibGetMemory: peak %lu, budget %lu\n", (unsigned long)base.peak, (unsigned long)base.budget);
+
+    memset(&c_stream, 0, sizeof(c_stream));
+    err = PREFIX(deflateInit)(&c_stream, 6);
+    CHECK_ERR(err, "deflateInit");
+    err = PREFIX(deflateGetMemory)(&c_stream, &dsize);
+    CHECK_ERR(err, "deflateGetMemory");
+    memset(&d_stream, 0, sizeof(d_stream));
+    err = PREFIX(inflateInit)(&d_stream);
+    CHECK_ERR(err, "inflateInit");
+    err = PREFIX(inflateGetMemory)(&d_stream, &isize);
+    CHECK_ERR(err, "inflateGetMemory");
+    if (dsize < PREFIX(deflateWorkspaceSize)(MAX_WBITS, DEF_MEM_LEVEL) || isize == 0)
+        error("stream memory: %lu %lu\n", (unsigned long)dsize, (unsigned long)isize);
+
+    PREFIX(zlibGetMemory)(&mem, 0);
+    if (mem.current != base.current + dsize + isize || mem.peak != mem.current)
+        error("zlibGetMemory: current %lu, peak %lu\n", (unsigned long)mem.current, (unsigned long)mem.peak);
+
+    /* One byte short of another deflate stream, refused before zalloc is called */
+    PREFIX(zlibSetMemoryBudget)(mem.current + dsize - 1);
+    memset(&refused, 0, sizeof(refused));
+    refused.zalloc = workspace_zalloc;
+    refused.zfree = workspace_zfree;
+    err = PREFIX(deflateInit)(&refused, 6);
+    if (err != Z_MEM_ERROR)
+        error("deflateInit over budget: %d\n", err);
+    cache = PREFIX(inflateCacheCreate)(4096);
+    if (cache != NULL)
+        error("inflateCacheCreate over budget\n");
+    err = PREFIX(inflateEnd)(&d_stream);
+    CHECK_ERR(err, "inflateEnd");
+
+    /* The inflate stream made room for a small cache */
+    cache = PREFIX(inflateCacheCreate)(1);
+    if (cache == NULL)
+        error("inflateCacheCreate within budget\n");
+    PREFIX(zlibSetMemoryBudget)(0);
+    PREFIX(inflateCacheFree)(cache);
+    err = PREFIX(deflateEnd)(&c_stream);
+    CHECK_ERR(err, "deflateEnd");
+
+    PREFIX(zlibGetMemory)(&mem, 1);
+    if (mem.current != base.current || mem.peak < base.current + dsize + isize || mem.budget != 0)
+        error("zlibGetMemory after end: current %lu, peak %lu\n", (unsigned long)mem.current,
+              (unsigned long)mem.peak);
+    PREFIX(zlibGetMemory)(&mem, 0);
+    if (mem.peak != base.current)
+        error("zlibGetMemory: peak not reset\n");
+
+    printf("zlibGetMemory(): OK\n");
+}
+
 /* ===========================================================================
  * Usage:  example [output.gz  [input.gz]]
  */
@@ -994,6 +2433,26 @@ int main(int argc, char *argv[]) {
     test_deflate_tune(compr, comprLen);
     test_deflate_pending(compr, comprLen);
     test_deflate_prime(compr, comprLen, uncompr, uncomprLen);
+    test_deflate_incompressible();
+    test_deflate_estimate();
+    test_deflate_block_split();
+    test_deflate_tree_reuse();
+    test_inflate_cache();
+    test_inflate_one_shot();
+    test_inflate_verify();
+    test_compress_batch();
+    test_checksum_multi();
+    test_checksum_parallel();
+    test_crc32_combine_gen_multi();
+    test_crc32c_crc64();
+    test_inflate_scan();
+    test_deflate_stats();
+    test_inflate_block_callback();
+    test_profile();
+    test_dispatch();
+    test_workspace();
+    test_hugepages();
+    test_memory();
 
     free(compr);
     free(uncompr);
@@ -18,6 +18,8 @@
 #include "zutil.h"
 #include "inftrees.h"
 #include "inflate.h"
+#include "functable.h"
+#include "arch_functions.h"
 
 /* -- memory tracking routines -- */
 
@@ -642,6 +644,86 @@ static void cover_trees(void) {
     fputs("inflate_table not enough errors\n", stderr);
     Z_UNUSED(ret);
 }
+
+/* next value of a small pseudo-random generator */
+static unsigned cover_rand(uint32_t *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return (unsigned)(*seed >> 16);
+}
+
+/* compare the dispatched inflate_table(), inflate_table_avx2() on a cpu with
+   AVX2, against inflate_table_c() on random complete, incomplete and
+   oversubscribed codes, with stale lengths past the code as in inflate() */
+static void cover_trees_dispatch(void) {
+    static const unsigned root[3] = {7, 10, 9}, maxlen[3] = {7, 15, 15};
+    static code table[2][ENOUGH];
+    uint16_t lens[2][320], work[288], depth[286];
+    unsigned n, k, i, leaves, bits[2];
+    code *next[2];
+    uint32_t seed = 1;
+    codetype type;
+    int ret[2], round;
+
+    for (round = 0; round < 30000; round++) {
+        type = (codetype)(round % 3);
+        n = type == CODES ? 19 : type == LENS ? 257 + cover_rand(&seed) % 30 :
+            1 + cover_rand(&seed) % 30;
+
+        /* a complete code of up to n lengths, by splitting random leaves */
+        k = 2 + cover_rand(&seed) % (n - 1 + (n == 1));
+        depth[0] = depth[1] = 1;
+        for (leaves = 2, i = 0; leaves < k && i < 10 * n; i++) {
+            unsigned leaf = cover_rand(&seed) % leaves;
+            if (depth[leaf] < maxlen[type]) {
+                depth[leaf]++;
+                depth[leaves++] = depth[leaf];
+            }
+        }
+        for (i = 0; i < 320; i++)
+            lens[0][i] = i < n ? (i < leaves ? depth[i] : 0) :
+                         (uint16_t)(cover_rand(&seed) % 16);
+        for (i = n - 1; i > 0; i--) {
+            unsigned j = cover_rand(&seed) % (i + 1);
+            uint16_t t = lens[0][i];
+            lens[0][i] = lens[0][j];
+            lens[0][j] = t;
+        }
+
+        /* then make it incomplete, oversubscribed or a single code */
+        i = cover_rand(&seed) % n;
+        switch ((round / 3) % 4) {
+        case 1:
+            lens[0][i] = 0;
+            break;
+        case 2:
+            if (lens[0][i] > 1)
+                lens[0][i]--;
+            else
+                lens[0][i] = 1;
+            break;
+        case 3:
+            memset(lens[0], 0, n * sizeof(uint16_t));
+            lens[0][i] = 1;
+            break;
+        }
+        memcpy(lens[1], lens[0], sizeof(lens[0]));
+
+        for (k = 0; k < 2; k++) {
+            memset(table[k], 0xa5, sizeof(table[k]));
+            next[k] = table[k];
+            bits[k] = root[type];
+            ret[k] = k ? FUNCTABLE_CALL(inflate_table)(type, lens[k], n, &next[k], &bits[k], work) :
+                         inflate_table_c(type, lens[k], n, &next[k], &bits[k], work);
+        }
+        assert(ret[0] == ret[1]);
+        if (ret[0] == 0) {
+            assert(bits[0] == bits[1]);
+            assert(next[0] - table[0] == next[1] - table[1]);
+            assert(memcmp(table[0], table[1], sizeof(table[0])) == 0);
+        }
+    }
+    fputs("inflate_table dispatch matches generic\n", stderr);
+}
 #endif
 
 /* cover remaining inffast.c decoding and window copying */
@@ -676,6 +758,7 @@ int main(void) {
     cover_inflate();
 #ifndef TEST_STOCK_ZLIB
     cover_trees();
+    cover_trees_dispatch();
 #endif
     cover_fast();
     cover_cve_2022_37434();
@@ -36,6 +36,7 @@
 #include "trees.h"
 #include "trees_emit.h"
 #include "trees_tbl.h"
+#include "zutil_p.h"
 
 /* The lengths of the bit length codes are sent in order of decreasing
  * probability, to avoid transmitting the lengths for unused bit length codes.
@@ -92,6 +93,7 @@ void Z_INTERNAL zng_tr_init(deflate_state *s) {
 
     s->bi_buf = 0;
     s->bi_valid = 0;
+    s->tree_cache_len = 0;
 #ifdef ZLIB_DEBUG
     s->compressed_len = 0L;
     s->bits_sent = 0L;
@@ -118,6 +120,44 @@ static void init_block(deflate_state *s) {
     s->dyn_ltree[END_BLOCK].Freq = 1;
     s->opt_len = s->static_len = 0;
     s->sym_next = s->matches = 0;
+
+    memset(s->split_obs, 0, sizeof(s->split_obs));
+    memset(s->split_new_obs, 0, sizeof(s->split_new_obs));
+    s->split_num_obs = s->split_num_new = 0;
+}
+
+/* ===========================================================================
+ * Compare the symbol observations since the last check with those of the
+ * current block, and return true if they diverge enough that starting a new
+ * block with new Huffman trees is likely to pay for its header. Otherwise
+ * merge them into the block. Longer blocks are split more readily, and blocks
+ * shorter than SPLIT_MIN_BLOCK input bytes are never split.
+ */
+int Z_INTERNAL zng_tr_split_check(deflate_state *s) {
+    uint32_t num_obs = s->split_num_obs, num_new = s->split_num_new;
+    uint32_t block_len = (uint32_t)((int)s->strstart - s->block_start);
+    int i;
+
+    if (num_obs > 0 && block_len >= SPLIT_MIN_BLOCK) {
+        uint32_t total_delta = 0;
+
+        /* Sum of the differences of the class probabilities, scaled by num_obs * num_new */
+        for (i = 0; i < SPLIT_OBS_TYPES; i++) {
+            uint32_t expected = s->split_obs[i] * num_new;
+            uint32_t actual = s->split_new_obs[i] * num_obs;
+            total_delta += actual > expected ? actual - expected : expected - actual;
+        }
+        if (total_delta + (block_len / 4096) * num_obs >= num_obs * (SPLIT_CHECK_INTERVAL * 200 / 512))
+            return 1;
+    }
+
+    for (i = 0; i < SPLIT_OBS_TYPES; i++) {
+        s->split_obs[i] += s->split_new_obs[i];
+        s->split_new_obs[i] = 0;
+    }
+    s->split_num_obs += num_new;
+    s->split_num_new = 0;
+    return 0;
 }
 
 #define SMALLEST 1
@@ -621,6 +661,97 @@ void Z_INTERNAL zng_tr_align(deflate_state *s) {
     zng_tr_flush_bits(s);
 }
 
+#ifndef NO_TREE_REUSE
+/* ===========================================================================
+ * Add the bit length of the symbols counted in tree when coded with the
+ * static codes to *static_len, their extra bits to *extra_len and, unless
+ * *code_len is UINT32_MAX, their length with codes to *code_len. *code_len is
+ * set to UINT32_MAX if codes can't represent one of the symbols. Returns the
+ * order-0 entropy of the symbols in bits with 8 fractional bits, which is a
+ * lower bound for the length of any code for them.
+ */
+static uint64_t tree_cost(const ct_data *tree, const static_tree_desc *desc, const ct_data *codes,
+                          uint32_t *code_len, uint32_t *static_len, uint32_t *extra_len) {
+    const ct_data *stree = desc->static_tree;
+    uint64_t sum = 0;
+    uint32_t total = 0;
+    int n;
+
+    for (n = 0; n < desc->elems; n++) {
+        uint32_t f = tree[n].Freq, xbits;
+        if (f == 0)
+            continue;
+        xbits = n >= desc->extra_base ? desc->extra_bits[n - desc->extra_base] : 0;
+        total += f;
+        sum += (uint64_t)f * zng_log2_q8(f);
+        *static_len += f * stree[n].Len;
+        *extra_len += f * xbits;
+        if (*code_len != UINT32_MAX)
+            *code_len = codes[n].Len ? *code_len + f * codes[n].Len : UINT32_MAX;
+    }
+    return total ? (uint64_t)total * zng_log2_q8(total) - sum : 0;
+}
+#endif
+
+/* ===========================================================================
+ * Remember the trees of a dynamic block and their encoded representation,
+ * which send_all_trees() has just written starting at byte pending of
+ * pending_buf plus bi_valid bits. entropy is the order-0 entropy of the block
+ * data as returned by tree_cost() and code_len the bit length of the data
+ * with the new trees, excluding extra bits.
+ */
+static void cache_trees(deflate_state *s, uint32_t pending, uint32_t bi_valid, uint64_t entropy, uint32_t code_len) {
+    uint32_t avail = s->pending - pending, shift = bi_valid & 7, skip = bi_valid >> 3;
+    uint32_t bits = avail * 8 + s->bi_valid - bi_valid;
+    uint32_t i, k;
+
+    s->tree_cache_len = 0;
+    if (entropy == 0 || bits > (TREE_CACHE_SIZE - 4) * 8)
+        return;
+
+    /* The header continues from pending_buf into bi_buf, extract it starting at bit 0 of the cache */
+    for (i = 0; i < (bits + 7) >> 3; i++) {
+        uint32_t b = 0;
+        for (k = 0; k < 2; k++) {
+            uint32_t pos = skip + i + k;
+            if (pos < avail)
+                b |= (uint32_t)s->pending_buf[pending + pos] << (k * 8);
+            else if (pos - avail < 8)
+                b |= (uint32_t)(s->bi_buf >> ((pos - avail) * 8) & 0xff) << (k * 8);
+        }
+        s->tree_cache_bits[i] = (unsigned char)(b >> shift);
+    }
+    memcpy(s->tree_cache_ltree, s->dyn_ltree, sizeof(s->tree_cache_ltree));
+    memcpy(s->tree_cache_dtree, s->dyn_dtree, sizeof(s->tree_cache_dtree));
+    /* Clear the guards set by scan_tree() */
+    if (s->l_desc.max_code + 1 < L_CODES)
+        s->tree_cache_ltree[s->l_desc.max_code + 1].Len = 0;
+    if (s->d_desc.max_code + 1 < D_CODES)
+        s->tree_cache_dtree[s->d_desc.max_code + 1].Len = 0;
+    s->tree_cache_len = bits;
+    s->tree_cache_ratio = (uint32_t)MIN(((uint64_t)code_len << 24) / entropy, UINT32_MAX);
+}
+
+/* ===========================================================================
+ * Send the cached encoded representation of the trees of an earlier block.
+ */
+static void send_cached_trees(deflate_state *s) {
+    uint32_t bi_valid = s->bi_valid;
+    uint64_t bi_buf = s->bi_buf;
+    uint32_t pos;
+
+    for (pos = 0; pos < s->tree_cache_len; pos += 32) {
+        uint32_t chunk_len = MIN(32, s->tree_cache_len - pos);
+        uint32_t chunk = Z_U32_FROM_LE(zng_memread_4(s->tree_cache_bits + (pos >> 3)));
+        if (chunk_len < 32)
+            chunk &= (1u << chunk_len) - 1;
+        send_bits(s, chunk, chunk_len, bi_buf, bi_valid);
+    }
+
+    s->bi_buf = bi_buf;
+    s->bi_valid = bi_valid;
+}
+
 /* ===========================================================================
  * Determine the best encoding for the current block: dynamic trees, static
  * trees or store, and write out the encoded block.
@@ -631,7 +762,12 @@ void Z_INTERNAL zng_tr_flush_block(deflate_state *s, char *buf, uint32_t stored_
     /* last: one if this is the last block for a file */
     unsigned int opt_lenb, static_lenb; /* opt_len and static_len in bytes */
     int max_blindex = 0;  /* index of last bit length code of non zero freq */
+    int reuse = 0;        /* true if the trees of the last dynamic block are reused */
+    uint32_t data_len = 0; /* bit length of the block data with new trees */
+    uint64_t entropy = 0; /* order-0 entropy of the block data, 8 fractional bits */
+    uint32_t extra_len = 0; /* extra bits of the lengths and distances in the block */
 
+    profile_start(s, Z_PROFILE_FLUSH_BLOCK);
     /* Build the Huffman trees unless a stored block is forced */
     if (UNLIKELY(s->sym_next == 0)) {
         /* Emit an empty static tree block with no codes */
@@ -642,20 +778,43 @@ void Z_INTERNAL zng_tr_flush_block(deflate_state *s, char *buf, uint32_t stored_
         if (s->strm->data_type == Z_UNKNOWN)
             s->strm->data_type = detect_data_type(s);
 
-        /* Construct the literal and distance trees */
-        build_tree(s, (tree_desc *)(&(s->l_desc)));
-        Tracev((stderr, "\nlit data: dyn %u, stat %u", s->opt_len, s->static_len));
-
-        build_tree(s, (tree_desc *)(&(s->d_desc)));
-        Tracev((stderr, "\ndist data: dyn %u, stat %u", s->opt_len, s->static_len));
-        /* At this point, opt_len and static_len are the total bit lengths of
-         * the compressed block data, excluding the tree representations.
+#ifndef NO_TREE_REUSE
+        /* Price the block with the codes of the last dynamic block. Consecutive blocks of homogeneous data get
+         * near-identical trees. If the old ones are as close to the entropy as they were on their own block,
+         * reuse them along with their encoded representation and skip tree construction entirely.
          */
+        {
+            uint32_t cached_len = s->tree_cache_len ? 0 : UINT32_MAX, static_len = 0;
+
+            entropy = tree_cost(s->dyn_ltree, &static_l_desc, s->tree_cache_ltree, &cached_len, &static_len, &extra_len);
+            entropy += tree_cost(s->dyn_dtree, &static_d_desc, s->tree_cache_dtree, &cached_len, &static_len, &extra_len);
+            if (cached_len != UINT32_MAX &&
+                    ((uint64_t)cached_len << 8) <= ((entropy * s->tree_cache_ratio) >> 16) + entropy / TREE_REUSE_SLACK) {
+                reuse = 1;
+                s->opt_len = cached_len + extra_len + s->tree_cache_len;
+                s->static_len = static_len + extra_len;
+                Tracev((stderr, "\nreused trees: dyn %u, stat %u", s->opt_len, s->static_len));
+            }
+        }
+#endif
 
-        /* Build the bit length tree for the above two trees, and get the index
-         * in bl_order of the last bit length code to send.
-         */
-        max_blindex = build_bl_tree(s);
+        if (!reuse) {
+            /* Construct the literal and distance trees */
+            build_tree(s, (tree_desc *)(&(s->l_desc)));
+            Tracev((stderr, "\nlit data: dyn %u, stat %u", s->opt_len, s->static_len));
+
+            build_tree(s, (tree_desc *)(&(s->d_desc)));
+            Tracev((stderr, "\ndist data: dyn %u, stat %u", s->opt_len, s->static_len));
+            /* At this point, opt_len and static_len are the total bit lengths of
+             * the compressed block data, excluding the tree representations.
+             */
+            data_len = s->opt_len;
+
+            /* Build the bit length tree for the above two trees, and get the index
+             * in bl_order of the last bit length code to send.
+             */
+            max_blindex = build_bl_tree(s);
+        }
 
         /* Determine the best encoding. Compute the block lengths in bytes. */
         opt_lenb = (s->opt_len + 3 + 7) >> 3;
@@ -682,16 +841,30 @@ void Z_INTERNAL zng_tr_flush_block(deflate_state *s, char *buf, uint32_t stored_
          * transform a block into a stored block.
          */
         zng_tr_stored_block(s, buf, stored_len, last);
+        zprobe4(deflate_block, s->strm, STORED_BLOCK, stored_len, stored_len + 4);
 
     } else if (static_lenb == opt_lenb) {
         zng_tr_emit_tree(s, STATIC_TREES, last);
         compress_block(s, (const ct_data *)static_ltree, (const ct_data *)static_dtree);
         cmpr_bits_add(s, s->static_len);
+        zprobe4(deflate_block, s->strm, STATIC_TREES, stored_len, static_lenb);
+    } else if (reuse) {
+        zng_tr_emit_tree(s, DYN_TREES, last);
+        send_cached_trees(s);
+        compress_block(s, (const ct_data *)s->tree_cache_ltree, (const ct_data *)s->tree_cache_dtree);
+        cmpr_bits_add(s, s->opt_len);
+        zprobe4(deflate_block, s->strm, DYN_TREES, stored_len, opt_lenb);
     } else {
+        uint32_t pending, bi_valid;
+
         zng_tr_emit_tree(s, DYN_TREES, last);
+        pending = s->pending;
+        bi_valid = s->bi_valid;
         send_all_trees(s, s->l_desc.max_code+1, s->d_desc.max_code+1, max_blindex+1);
+        cache_trees(s, pending, bi_valid, entropy, data_len - extra_len);
         compress_block(s, (const ct_data *)s->dyn_ltree, (const ct_data *)s->dyn_dtree);
         cmpr_bits_add(s, s->opt_len);
+        zprobe4(deflate_block, s->strm, DYN_TREES, stored_len, opt_lenb);
     }
     Assert(s->compressed_len == s->bits_sent, "bad compressed size");
     /* The above check is made mod 2^32, for files larger than 512 MB
@@ -703,6 +876,29 @@ void Z_INTERNAL zng_tr_flush_block(deflate_state *s, char *buf, uint32_t stored_
         zng_tr_emit_align(s);
     }
     Tracev((stderr, "\ncomprlen %lu(%lu) ", s->compressed_len>>3, s->compressed_len-7*last));
+    profile_stop(s, Z_PROFILE_FLUSH_BLOCK);
+}
+
+/* ===========================================================================
+ * Size the current block without emitting it and start a new block. Sets
+ * *dyn_bits to the bit length of the block data with dynamic trees, *tree_bits
+ * to the bit length of the tree representation and *static_bits to the bit
+ * length of the block with static trees, block type bits included.
+ */
+void Z_INTERNAL zng_tr_estimate_block(deflate_state *s, uint32_t *dyn_bits, uint32_t *tree_bits, uint32_t *static_bits) {
+    unsigned int data_len;
+
+    build_tree(s, (tree_desc *)(&(s->l_desc)));
+    build_tree(s, (tree_desc *)(&(s->d_desc)));
+    data_len = s->opt_len;
+
+    /* build_bl_tree() adds the size of the tree representation to opt_len */
+    Z_UNUSED(build_bl_tree(s));
+
+    *dyn_bits = data_len;
+    *tree_bits = s->opt_len - data_len + 3;
+    *static_bits = s->static_len + 3;
+    init_block(s);
 }
 
 /* ===========================================================================
@@ -724,6 +920,7 @@ static void compress_block(deflate_state *s, const ct_data *ltree, const ct_data
     unsigned char *sym_buf = s->sym_buf;
 #endif
 
+    profile_start(s, Z_PROFILE_COMPRESS_BLOCK);
     if (sym_next != 0) {
         do {
 #ifdef LIT_MEM
@@ -750,6 +947,7 @@ static void compress_block(deflate_state *s, const ct_data *ltree, const ct_data
     }
 
     zng_emit_end_block(s, ltree, 0);
+    profile_stop(s, Z_PROFILE_COMPRESS_BLOCK);
 }
 
 /* ===========================================================================
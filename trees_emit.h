@@ -113,6 +113,7 @@ static inline uint32_t zng_emit_lit(deflate_state *s, const ct_data *ltree, unsi
     s->bi_buf = bi_buf;
 
     Tracecv(isgraph(c & 0xff), (stderr, " '%c' ", c));
+    stats_add(s, literals, 1);
 
     return ltree[c].Len;
 }
@@ -134,6 +135,8 @@ static uint32_t zng_emit_dist(deflate_state *s, const ct_data *ltree, const ct_d
     c = code+LITERALS+1;
     Assert(c < L_CODES, "bad l_code");
     send_code_trace(s, c);
+    stats_add(s, matches, 1);
+    stats_add(s, match_lengths[code], 1);
 
     match_bits = ltree[c].Code;
     match_bits_len = ltree[c].Len;
@@ -148,6 +151,7 @@ static uint32_t zng_emit_dist(deflate_state *s, const ct_data *ltree, const ct_d
     code = d_code(dist);
     Assert(code < D_CODES, "bad d_code");
     send_code_trace(s, code);
+    stats_add(s, match_dists[code], 1);
 
     /* Send the distance code */
     match_bits |= ((uint64_t)dtree[code].Code << match_bits_len);
@@ -205,6 +209,7 @@ static inline void zng_tr_emit_tree(deflate_state *s, int type, const int last)
     uint32_t header_bits = (type << 1) + last;
     send_bits(s, header_bits, 3, bi_buf, bi_valid);
     cmpr_bits_add(s, 3);
+    stats_add(s, blocks[type], 1);
     s->bi_valid = bi_valid;
     s->bi_buf = bi_buf;
     Tracev((stderr, "\n--- Emit Tree: Last: %u\n", last));
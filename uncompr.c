@@ -44,7 +44,8 @@ z_int32_t Z_EXPORT PREFIX(uncompress2)(unsigned char *dest, z_uintmax_t *destLen
     stream.zfree = NULL;
     stream.opaque = NULL;
 
-    err = PREFIX(inflateInit)(&stream);
+    /* dest is written contiguously, so inflate can use it as history and skip the sliding window */
+    err = PREFIX(inflateInitOneShot)(&stream, DEF_WBITS);
     if (err != Z_OK) return err;
 
     stream.next_out = dest;
@@ -0,0 +1,150 @@
+/* zatomic.h -- Private atomic accesses to flags and counters shared between threads
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ZATOMIC_H
+#define ZATOMIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Loads acquire, stores release and read-modify-writes do both, so a flag or counter may guard the data written
+ * before it was updated. Without compiler support the accesses are plain, and only one thread may use them.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#  define ZATOMIC_GNUC
+#elif defined(_MSC_VER)
+#  include <intrin.h>
+#  define ZATOMIC_MSVC
+#elif defined(WITH_THREADS)
+#  error Unable to detect atomic intrinsic support, build without WITH_THREADS.
+#endif
+
+static inline int32_t zng_atomic_load_32(const int32_t *ptr) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(ZATOMIC_MSVC)
+    return (int32_t)_InterlockedCompareExchange((long volatile *)ptr, 0, 0);
+#else
+    return *ptr;
+#endif
+}
+
+static inline void zng_atomic_store_32(int32_t *ptr, int32_t val) {
+#if defined(ZATOMIC_GNUC)
+    __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+#elif defined(ZATOMIC_MSVC)
+    _InterlockedExchange((long volatile *)ptr, (long)val);
+#else
+    *ptr = val;
+#endif
+}
+
+/* Sets *ptr to val if it is expected, returns true if it was */
+static inline int zng_atomic_cas_32(int32_t *ptr, int32_t expected, int32_t val) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_compare_exchange_n(ptr, &expected, val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#elif defined(ZATOMIC_MSVC)
+    return _InterlockedCompareExchange((long volatile *)ptr, (long)val, (long)expected) == (long)expected;
+#else
+    if (*ptr != expected)
+        return 0;
+    *ptr = val;
+    return 1;
+#endif
+}
+
+static inline size_t zng_atomic_load_size(const size_t *ptr) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(ZATOMIC_MSVC) && defined(_WIN64)
+    return (size_t)_InterlockedCompareExchange64((__int64 volatile *)ptr, 0, 0);
+#elif defined(ZATOMIC_MSVC)
+    return (size_t)_InterlockedCompareExchange((long volatile *)ptr, 0, 0);
+#else
+    return *ptr;
+#endif
+}
+
+static inline void zng_atomic_store_size(size_t *ptr, size_t val) {
+#if defined(ZATOMIC_GNUC)
+    __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+#elif defined(ZATOMIC_MSVC) && defined(_WIN64)
+    _InterlockedExchange64((__int64 volatile *)ptr, (__int64)val);
+#elif defined(ZATOMIC_MSVC)
+    _InterlockedExchange((long volatile *)ptr, (long)val);
+#else
+    *ptr = val;
+#endif
+}
+
+/* Sets *ptr to val if it is expected, returns true if it was */
+static inline int zng_atomic_cas_size(size_t *ptr, size_t expected, size_t val) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_compare_exchange_n(ptr, &expected, val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#elif defined(ZATOMIC_MSVC) && defined(_WIN64)
+    return _InterlockedCompareExchange64((__int64 volatile *)ptr, (__int64)val, (__int64)expected) == (__int64)expected;
+#elif defined(ZATOMIC_MSVC)
+    return _InterlockedCompareExchange((long volatile *)ptr, (long)val, (long)expected) == (long)expected;
+#else
+    if (*ptr != expected)
+        return 0;
+    *ptr = val;
+    return 1;
+#endif
+}
+
+/* Adds val to *ptr, returns the value before */
+static inline size_t zng_atomic_add_size(size_t *ptr, size_t val) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_fetch_add(ptr, val, __ATOMIC_ACQ_REL);
+#elif defined(ZATOMIC_MSVC) && defined(_WIN64)
+    return (size_t)_InterlockedExchangeAdd64((__int64 volatile *)ptr, (__int64)val);
+#elif defined(ZATOMIC_MSVC)
+    return (size_t)_InterlockedExchangeAdd((long volatile *)ptr, (long)val);
+#else
+    size_t old = *ptr;
+    *ptr += val;
+    return old;
+#endif
+}
+
+static inline uint64_t zng_atomic_load_64(const uint64_t *ptr) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(ZATOMIC_MSVC)
+    return (uint64_t)_InterlockedCompareExchange64((__int64 volatile *)ptr, 0, 0);
+#else
+    return *ptr;
+#endif
+}
+
+/* Sets *ptr to val if it is expected, returns true if it was */
+static inline int zng_atomic_cas_64(uint64_t *ptr, uint64_t expected, uint64_t val) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_compare_exchange_n(ptr, &expected, val, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#elif defined(ZATOMIC_MSVC)
+    return _InterlockedCompareExchange64((__int64 volatile *)ptr, (__int64)val, (__int64)expected) == (__int64)expected;
+#else
+    if (*ptr != expected)
+        return 0;
+    *ptr = val;
+    return 1;
+#endif
+}
+
+/* Adds val to *ptr, returns the value before */
+static inline uint64_t zng_atomic_add_64(uint64_t *ptr, uint64_t val) {
+#if defined(ZATOMIC_GNUC)
+    return __atomic_fetch_add(ptr, val, __ATOMIC_ACQ_REL);
+#else
+    /* 32-bit Windows has no 64-bit add */
+    uint64_t old;
+    do {
+        old = zng_atomic_load_64(ptr);
+    } while (!zng_atomic_cas_64(ptr, old, old + val));
+    return old;
+#endif
+}
+
+#endif
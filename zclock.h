@@ -0,0 +1,47 @@
+/* zclock.h -- Monotonic clock for timing inside the library
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ZCLOCK_H_
+#define ZCLOCK_H_
+
+#include "zbuild.h"
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+#if defined(_MSC_VER) && defined(ARCH_X86)
+#  include <intrin.h>
+#elif defined(ARCH_X86)
+#  include <x86intrin.h>
+#endif
+
+/* Nanoseconds since an arbitrary start, only the difference of two readings means anything */
+static inline uint64_t zclock_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)(count.QuadPart / freq.QuadPart) * 1000000000 +
+           (uint64_t)(count.QuadPart % freq.QuadPart) * 1000000000 / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Ticks of the cheapest clock to read, the time stamp counter on x86 and nanoseconds elsewhere */
+static inline uint64_t zclock_ticks(void) {
+#ifdef ARCH_X86
+    return __rdtsc();
+#else
+    return zclock_ns();
+#endif
+}
+
+#endif
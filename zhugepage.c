@@ -0,0 +1,198 @@
+/* zhugepage.c -- Slab allocator on transparent huge pages for stream state, kept if WITH_HUGEPAGES is defined
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * The window, prev and head arrays of a deflate stream take about 256K and hash chain walks hit them at random,
+ * so with 4K pages most of the lookups miss the TLB. Blocks are carved here from 2M slabs aligned to 2M and
+ * advised as huge pages, which the kernel then backs with a single TLB entry each. A slab holds blocks of one
+ * size, a multiple of 64K, and is bound to the NUMA node of the thread that mapped it; a thread only takes
+ * blocks from the slabs of its own node. Requests over 2M get a mapping of their own. One slab with room is
+ * kept per size and node when blocks are freed, so streams that come and go don't map and fault in a new slab
+ * each time.
+ */
+
+#include "zbuild.h"
+#include "zutil.h"
+#include "zutil_p.h"
+#include "zhugepage.h"
+#include "zatomic.h"
+
+#ifdef HAVE_HUGEPAGES
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef WITH_THREADS
+#  include <pthread.h>
+#endif
+
+#define HUGE_SLAB_SIZE  (2 * 1024 * 1024)
+#define HUGE_UNIT       (64 * 1024)
+#define HUGE_UNITS      (HUGE_SLAB_SIZE / HUGE_UNIT)    /* units in a slab, and most blocks one can hold */
+
+#define HUGE_MPOL_PREFERRED 1       /* from <linux/mempolicy.h>, which isn't always installed */
+
+typedef struct zhuge_slab_s {
+    struct zhuge_slab_s *next;
+    unsigned char *base;            /* start of the mapping, aligned to HUGE_SLAB_SIZE */
+    size_t size;                    /* length of the mapping */
+    int node;                       /* NUMA node the mapping is bound to */
+    unsigned units;                 /* units in each block, or 0 if the mapping is one large block */
+    uint32_t full;                  /* used when every block is handed out */
+    uint32_t used;                  /* bit i is set while block i is handed out */
+} zhuge_slab;
+
+static zhuge_slab *huge_slabs;
+static int32_t huge_mapped;       /* slabs in huge_slabs, changed under the lock */
+static int32_t huge_enabled;
+#ifdef WITH_THREADS
+static pthread_mutex_t huge_lock = PTHREAD_MUTEX_INITIALIZER;
+#  define HUGE_LOCK() pthread_mutex_lock(&huge_lock)
+#  define HUGE_UNLOCK() pthread_mutex_unlock(&huge_lock)
+#else
+#  define HUGE_LOCK()
+#  define HUGE_UNLOCK()
+#endif
+
+/* NUMA node of the CPU the calling thread runs on, 0 if the kernel won't tell */
+static int huge_node(void) {
+#ifdef SYS_getcpu
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+        return (int)node;
+#endif
+    return 0;
+}
+
+/* Maps size bytes aligned to HUGE_SLAB_SIZE, advised as huge pages and preferably placed on node */
+static unsigned char *huge_map(size_t size, int node) {
+    unsigned char *p = (unsigned char *)mmap(NULL, size + HUGE_SLAB_SIZE, PROT_READ | PROT_WRITE,
+                                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    size_t lead;
+
+    if (p == MAP_FAILED)
+        return NULL;
+    lead = (size_t)(-(uintptr_t)p & (HUGE_SLAB_SIZE - 1));
+    if (lead)
+        munmap(p, lead);
+    if (lead != HUGE_SLAB_SIZE)
+        munmap(p + lead + size, HUGE_SLAB_SIZE - lead);
+    p += lead;
+#ifdef MADV_HUGEPAGE
+    madvise(p, size, MADV_HUGEPAGE);
+#endif
+#ifdef SYS_mbind
+    if (node < (int)(sizeof(unsigned long) * 8)) {
+        unsigned long mask = 1UL << node;
+        syscall(SYS_mbind, p, size, HUGE_MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0);
+    }
+#else
+    Z_UNUSED(node);
+#endif
+    return p;
+}
+
+/* True if another slab of the same block size and node as slab has a free block */
+static int huge_spare(const zhuge_slab *slab) {
+    for (const zhuge_slab *s = huge_slabs; s != NULL; s = s->next) {
+        if (s != slab && s->units == slab->units && s->node == slab->node && s->used != s->full)
+            return 1;
+    }
+    return 0;
+}
+
+Z_INTERNAL void *zhuge_alloc(size_t size) {
+    zhuge_slab *s = NULL;
+    size_t units;
+    int node, i;
+
+    if (size > SIZE_MAX / 2)
+        return NULL;
+    units = MAX((size + HUGE_UNIT - 1) / HUGE_UNIT, 1);
+    node = huge_node();
+
+    HUGE_LOCK();
+    if (units <= HUGE_UNITS) {
+        for (s = huge_slabs; s != NULL; s = s->next) {
+            if (s->units == units && s->node == node && s->used != s->full)
+                break;
+        }
+    }
+    if (s == NULL) {
+        size_t len = units <= HUGE_UNITS ? HUGE_SLAB_SIZE : (units * HUGE_UNIT + HUGE_SLAB_SIZE - 1) &
+                                                            ~(size_t)(HUGE_SLAB_SIZE - 1);
+        unsigned blocks = units <= HUGE_UNITS ? HUGE_UNITS / (unsigned)units : 1;
+
+        s = (zhuge_slab *)zng_alloc(sizeof(zhuge_slab));
+        if (s == NULL || (s->base = huge_map(len, node)) == NULL) {
+            HUGE_UNLOCK();
+            zng_free(s);
+            return NULL;
+        }
+        s->size = len;
+        s->node = node;
+        s->units = units <= HUGE_UNITS ? (unsigned)units : 0;
+        s->full = (uint32_t)(((uint64_t)1 << blocks) - 1);
+        s->used = 0;
+        s->next = huge_slabs;
+        huge_slabs = s;
+        zng_atomic_store_32(&huge_mapped, huge_mapped + 1);
+    }
+    i = __builtin_ctz(~s->used);
+    s->used |= (uint32_t)1 << i;
+    HUGE_UNLOCK();
+    return s->base + (size_t)i * s->units * HUGE_UNIT;
+}
+
+Z_INTERNAL int zhuge_free(void *ptr) {
+    unsigned char *p = (unsigned char *)ptr;
+    zhuge_slab *s, **link;
+
+    /* Streams on the default allocator come through here, keep them off the lock until a slab is mapped */
+    if (p == NULL || zng_atomic_load_32(&huge_mapped) == 0)
+        return 0;
+
+    HUGE_LOCK();
+    for (link = &huge_slabs; (s = *link) != NULL; link = &s->next) {
+        if (p >= s->base && p < s->base + s->size)
+            break;
+    }
+    if (s != NULL) {
+        unsigned i = s->units ? (unsigned)((size_t)(p - s->base) / ((size_t)s->units * HUGE_UNIT)) : 0;
+
+        s->used &= ~((uint32_t)1 << i);
+        if (s->used == 0 && (s->units == 0 || huge_spare(s))) {
+            *link = s->next;
+            zng_atomic_store_32(&huge_mapped, huge_mapped - 1);
+            munmap(s->base, s->size);
+            zng_free(s);
+        }
+    }
+    HUGE_UNLOCK();
+    return s != NULL;
+}
+
+Z_INTERNAL int zhuge_default(void) {
+    return zng_atomic_load_32(&huge_enabled);
+}
+
+int32_t Z_EXPORT PREFIX(zlibSetHugePages)(int32_t enable) {
+    zng_atomic_store_32(&huge_enabled, enable != 0);
+    return Z_OK;
+}
+#else
+int32_t Z_EXPORT PREFIX(zlibSetHugePages)(int32_t enable) {
+    Z_UNUSED(enable);
+    return Z_VERSION_ERROR;
+}
+#endif
+
+void Z_EXPORT *PREFIX(zlibHugeAlloc)(void *opaque, unsigned items, unsigned size) {
+    void *ptr = zhuge_alloc((size_t)items * (size_t)size);
+    Z_UNUSED(opaque);
+    return ptr != NULL ? ptr : zng_alloc((size_t)items * (size_t)size);
+}
+
+void Z_EXPORT PREFIX(zlibHugeFree)(void *opaque, void *ptr) {
+    Z_UNUSED(opaque);
+    if (!zhuge_free(ptr))
+        zng_free(ptr);
+}
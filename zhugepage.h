@@ -0,0 +1,29 @@
+/* zhugepage.h -- Slab allocator on transparent huge pages for stream state, kept if WITH_HUGEPAGES is defined
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ZHUGEPAGE_H_
+#define ZHUGEPAGE_H_
+
+#include "zbuild.h"
+
+#if defined(WITH_HUGEPAGES) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#  define HAVE_HUGEPAGES
+
+/* Returns a block of at least size bytes from the huge page slabs of the calling thread's NUMA node, or NULL if
+ * none could be mapped, in which case the caller falls back to zng_alloc().
+ */
+Z_INTERNAL void *zhuge_alloc(size_t size);
+
+/* Gives ptr back and returns 1 if it came from zhuge_alloc(), else returns 0 and leaves ptr alone */
+Z_INTERNAL int zhuge_free(void *ptr);
+
+/* True if zlibSetHugePages() asked for the default allocator to use the slabs */
+Z_INTERNAL int zhuge_default(void);
+#else
+#  define zhuge_alloc(size) NULL
+#  define zhuge_free(ptr) 0
+#  define zhuge_default() 0
+#endif
+
+#endif
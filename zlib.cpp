@@ -7,7 +7,12 @@
 #define ZLIB_COMPAT 1
 
 //#define WITH_GZFILEOP
+//#define WITH_DEFLATE_STATS
+//#define WITH_PROFILE
+//#define WITH_USDT
+//#define WITH_HUGEPAGES
 #define WITH_OPTIM
+#define WITH_THREADS
 #define HAVE_BUILTIN_ASSUME_ALIGNED
 #define X86_AVX2
 #define X86_AVX512
@@ -137,13 +142,24 @@ ZLIB_TARGET_REGION("sse4.1,pclmul,bmi2,avx2")
 #include "arch/x86/adler32_ssse3.c"
 #include "arch/x86/adler32_sse42.c"
 #include "arch/x86/adler32_avx2.c"
+#include "arch/x86/adler32_multi_sse41.c"
+#include "arch/x86/adler32_multi_avx2.c"
 #   include "zlib_undef.inl"
 #include "crc32_braid_comb.c"
+#include "arch/generic/crc32_combine_c.c"
 #include "arch/generic/crc32_chorba_c.c"
 #include "arch/generic/crc32_braid_c.c"
 #include "arch/x86/crc32_pclmulqdq.c"
+#include "arch/x86/crc32_multi_pclmulqdq.c"
+#include "arch/x86/crc32_combine_pclmulqdq.c"
 #   include "zlib_undef.inl"
 #include "crc32.c"
+#include "crc32c.c"
+#include "arch/generic/crc32c_c.c"
+#include "arch/x86/crc32c_pclmulqdq.c"
+#include "crc64.c"
+#include "arch/generic/crc64_c.c"
+#include "arch/x86/crc64_pclmulqdq.c"
 #include "compress.c"
 #include "cpu_features.c"
 #include "deflate.c"
@@ -157,6 +173,7 @@ ZLIB_TARGET_REGION("sse4.1,pclmul,bmi2,avx2")
 #include "infback.c"
 #   include "zlib_undef.inl"
 #include "inftrees.c"
+#include "arch/x86/inftrees_avx2.c"
 #include "insert_string.c"
 #   include "zlib_undef.inl"
 #include "trees.c"
@@ -164,6 +181,9 @@ ZLIB_TARGET_REGION("sse4.1,pclmul,bmi2,avx2")
 #include "inflate.c"
 #   include "zlib_undef.inl"
 #include "zutil.c"
+#include "zthread.c"
+#include "zprofile.c"
+#include "zhugepage.c"
 #include "arch/x86/x86_features.c"
 #include "arch/x86/chorba_sse41.c"
 #include "arch/x86/chorba_sse2.c"
@@ -226,6 +246,10 @@ ZLIB_TARGET_REGION("sse4.1,pclmul,bmi2,avx2")
 #   include "zlib_undef.inl"
 #include "arch/x86/compare256_avx2.c"
 #   include "zlib_undef.inl"
+#include "arch/generic/entropy_probe_c.c"
+#include "arch/x86/entropy_probe_sse2.c"
+#include "arch/x86/entropy_probe_avx2.c"
+#include "arch/generic/checksum_multi_c.c"
 ZLIB_UNTARGET_REGION // avx2
 
 #define __AVX512F__ 1
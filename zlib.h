@@ -150,6 +150,12 @@ typedef struct gz_header_s {
 
 typedef gz_header *gz_headerp;
 
+/*
+    Opaque cache of inflate code tables that can be shared between streams,
+  see inflateCacheCreate().
+*/
+typedef struct inflate_cache_s inflate_cache;
+
 /*
      The application must update next_in and avail_in when avail_in has dropped
    to zero.  It must update next_out and avail_out when avail_out has dropped
@@ -774,6 +780,92 @@ Z_EXTERN unsigned long Z_EXPORT deflateBound(z_stream *strm, unsigned long sourc
    than Z_FINISH or Z_NO_FLUSH are used.
 */
 
+Z_EXTERN size_t Z_EXPORT deflateWorkspaceSize(int windowBits, int memLevel);
+/*
+     deflateWorkspaceSize() returns the number of bytes of state memory, the
+   deflate state, window, hash tables and pending buffer, that a stream
+   initialized with windowBits and memLevel as for deflateInit2() takes.  It
+   returns zero if windowBits or memLevel is not valid.
+*/
+
+Z_EXTERN int Z_EXPORT deflateInitWorkspace(z_stream *strm, int level, int method, int windowBits, int memLevel,
+                                           int strategy, void *work, size_t size);
+/*
+     Like deflateInit2(), but places all of the stream's state in the size
+   bytes at work instead of allocating it, for applications that must not
+   allocate memory once running.  size must be at least the value returned by
+   deflateWorkspaceSize() for the same windowBits and memLevel, and work must
+   stay valid and untouched by the application until deflateEnd(), which does
+   not free it.  Any alignment of work is accepted, the buffers inside it are
+   aligned from the room deflateWorkspaceSize() includes for that.  zalloc and
+   zfree are never called for such a stream, except by deflateCopy() that
+   allocates the copy as usual.
+
+     deflateInitWorkspace() returns Z_MEM_ERROR if size is too small,
+   Z_STREAM_ERROR if work is Z_NULL, and otherwise the same as deflateInit2().
+*/
+
+Z_EXTERN unsigned long Z_EXPORT deflateEstimate(z_stream *strm, const unsigned char *source, unsigned long sourceLen);
+/*
+     deflateEstimate() returns an estimate of the compressed size after
+   deflation of the sourceLen bytes at source with the level, strategy and
+   wrapper of strm, without compressing them.  Only evenly spaced samples of
+   the input, up to a window full and at most one sixteenth of large inputs,
+   are run through the match finder of the level and sized with Huffman trees
+   built as deflate() would, so the result takes a small fraction of the time
+   of a trial compression and is not a bound.  To compare levels, call
+   deflateParams() before each estimate.
+
+     deflateEstimate() must be called after deflateInit(), deflateInit2() or
+   deflateReset(), and after deflateSetHeader() or deflateParams() if used,
+   but before any input is provided and without a preset dictionary.  It uses
+   the stream as work space and then calls deflateReset(), which keeps the
+   header of deflateSetHeader() and the level and strategy but not the values
+   of deflateTune().  If the stream was already used or is inconsistent, or
+   source is NULL, the value of deflateBound() is returned instead, and for a
+   stream finished with Z_FINISH the value deflateBound() gives for an
+   inconsistent stream.
+*/
+
+#define Z_STATS_STORED 0
+#define Z_STATS_QUICK  1
+#define Z_STATS_FAST   2
+#define Z_STATS_MEDIUM 3
+#define Z_STATS_SLOW   4
+#define Z_STATS_HUFF   5
+#define Z_STATS_RLE    6
+#define Z_STATS_FUNCS  7
+/* Compression functions counted apart in deflate_stats: stored for level 0,
+   huff and rle for the Z_HUFFMAN_ONLY and Z_RLE strategies, and quick, fast,
+   medium or slow as the level selects */
+
+typedef struct deflate_stats_s {
+    uint64_t blocks[3];         /* blocks by type: 0 stored, 1 fixed and 2 dynamic */
+    uint64_t literals;          /* literals emitted */
+    uint64_t matches;           /* matches emitted */
+    uint64_t match_lengths[29]; /* matches by deflate length code, from 3 to 258 bytes */
+    uint64_t match_dists[30];   /* matches by deflate distance code, from 1 to 32768 bytes back */
+    uint64_t window_slides;     /* times the window was moved down to make room for input */
+    uint64_t func_in[Z_STATS_FUNCS];  /* bytes of input taken by each compression function */
+    uint64_t func_out[Z_STATS_FUNCS]; /* bytes of output written while it ran */
+} deflate_stats;
+
+Z_EXTERN int Z_EXPORT deflateGetStats(z_stream *strm, deflate_stats *stats);
+/*
+     deflateGetStats() copies the counters kept by strm since deflateInit()
+   or the last deflateReset() into *stats.  Blocks are counted as their
+   headers are written, literals and matches as their codes are written, so
+   symbols of a block still being gathered are not counted yet.  Output
+   written by deflate() outside the compression functions, such as headers,
+   trailers and flush markers, is not counted in func_out.
+
+     The counters are only kept if the library was built with
+   WITH_DEFLATE_STATS defined, otherwise they cost nothing.  deflateGetStats()
+   returns Z_OK on success, Z_STREAM_ERROR if the stream state was
+   inconsistent or stats is Z_NULL, and Z_VERSION_ERROR if the library was
+   built without WITH_DEFLATE_STATS.
+*/
+
 Z_EXTERN int Z_EXPORT deflatePending(z_stream *strm, uint32_t *pending, int *bits);
 /*
      deflatePending() returns the number of bytes and bits of output that have
@@ -880,6 +972,42 @@ Z_EXTERN int Z_EXPORT inflateInit2(z_stream *strm, int  windowBits);
    deferred until inflate() is called.
 */
 
+Z_EXTERN int Z_EXPORT inflateInitOneShot(z_stream *strm, int windowBits);
+/*
+     Like inflateInit2(), for applications that decompress into a single
+   contiguous output buffer: on every call of inflate() next_out must point
+   just past the output written by the previous call, as is the case when the
+   whole destination is provided up front.  Matches are then copied directly
+   from the output already written, so no sliding window is allocated and
+   inflate() never copies output into one.  Input may still be provided in
+   pieces.
+
+     inflateSetDictionary() is not available for such a stream and returns
+   Z_STREAM_ERROR.  Return values are the same as for inflateInit2().
+*/
+
+Z_EXTERN size_t Z_EXPORT inflateWorkspaceSize(int windowBits);
+/*
+     inflateWorkspaceSize() returns the number of bytes of state memory, the
+   inflate state and window, that a stream initialized with windowBits as for
+   inflateInit2() takes.  The window is always made large enough for the
+   largest windowBits a zlib or gzip header can ask for.
+*/
+
+Z_EXTERN int Z_EXPORT inflateInitWorkspace(z_stream *strm, int windowBits, void *work, size_t size);
+/*
+     Like inflateInit2(), but places all of the stream's state in the size
+   bytes at work instead of allocating it, for applications that must not
+   allocate memory once running.  size must be at least the value returned by
+   inflateWorkspaceSize(), and work must stay valid and untouched by the
+   application until inflateEnd(), which does not free it.  Any alignment of
+   work is accepted.  zalloc and zfree are never called for such a stream,
+   except by inflateCopy() that allocates the copy as usual.
+
+     inflateInitWorkspace() returns Z_MEM_ERROR if size is too small,
+   Z_STREAM_ERROR if work is Z_NULL, and otherwise the same as inflateInit2().
+*/
+
 Z_EXTERN int Z_EXPORT inflateSetDictionary(z_stream *strm, const unsigned char *dictionary, unsigned int dictLength);
 /*
      Initializes the decompression dictionary from the given uncompressed byte
@@ -933,6 +1061,78 @@ Z_EXTERN int Z_EXPORT inflateSync(z_stream *strm);
    input each time, until success or end of the input data.
 */
 
+Z_EXTERN int Z_EXPORT inflateVerify(z_stream *strm, int flush);
+/*
+     Decompresses like inflate(), but only to check the integrity of the
+   compressed data: the decoded bytes pass through the 32K sliding window and
+   the check value, and are then discarded.  next_out and avail_out are
+   neither used nor changed, so no output buffer is needed.  total_out counts
+   the decoded bytes as usual, and gives the exact uncompressed length once
+   the end of the stream is reached.  flush may be Z_NO_FLUSH, Z_SYNC_FLUSH or
+   Z_FINISH, with the same meaning as for inflate().
+
+     inflateVerify returns Z_STREAM_END if the whole stream was decoded and its
+   check value, and for gzip its length, matched the trailer.  It returns
+   Z_DATA_ERROR if the data is corrupted or the trailer does not match.  Other
+   return values are as for inflate(); Z_STREAM_ERROR is also returned for
+   streams initialized with inflateInitOneShot(), which have no window.  The
+   trailer is only compared if check value validation is enabled, which is the
+   default (see inflateValidate()).  The stream may be continued with
+   inflate(), or with further inflateVerify() calls.
+*/
+
+#define Z_SCAN_STORED  0
+#define Z_SCAN_FIXED   1
+#define Z_SCAN_DYNAMIC 2
+#define Z_SCAN_MEMBER  3
+#define Z_SCAN_END     4
+/* Kinds of scan_mark: start of a deflate block of the given type, start of a
+   member (its header), and end of a member (after its trailer) */
+
+typedef struct scan_mark_s {
+    z_off64_t in;       /* compressed offset in bits, from the last inflateReset() */
+    z_off64_t out;      /* uncompressed offset in bytes, from the same point */
+    int type;           /* one of the Z_SCAN_ values above */
+    int last;           /* true for the last block of a member */
+} scan_mark;
+
+Z_EXTERN int Z_EXPORT inflateScan(z_stream *strm, int flush, scan_mark *marks, unsigned *count);
+/*
+     Walks the compressed data like inflate(), but only to find the length of
+   the uncompressed data and where its blocks and members start.  The codes
+   of each block are decoded and the lengths of their literals and matches
+   added up, but no data is produced, and stored blocks are skipped by their
+   length.  Stored data is passed over at no cost, and compressed data is
+   taken faster than inflate() takes it, with no output buffer, window or
+   check value to keep up.  next_out and avail_out are neither used nor
+   changed.  total_out counts the uncompressed bytes as inflate() would.
+
+     If marks is not Z_NULL, *count gives its size on entry, and each block
+   start, member start and member end that is passed adds a mark, with
+   offsets in 64 bits even where total_in and total_out are 32 bits.  On
+   return *count is the number of marks added.  Once marks is full the scan
+   stops before the next mark, and can be continued by calling inflateScan()
+   again.  If marks is Z_NULL, count is not used.  The end mark of a member
+   has the total length of the uncompressed data so far in out.
+
+     For gzip data the scan goes on into a following member, as gzip
+   readers do, if there is more input starting with a gzip header, and
+   otherwise stops at the end of the member, leaving any further input.  If
+   the input ran out right at the end of a member, calling inflateScan()
+   again with more input goes on into the next member.  The
+   gzip length trailer is checked, but check values cannot be, since the data
+   they are computed over is never produced.
+
+     inflateScan returns Z_STREAM_END when it has reached the end of a member
+   with no other member following in the input, Z_OK if progress was made or
+   marks was filled, Z_BUF_ERROR if no progress was possible or if the end of
+   the data was not reached with flush set to Z_FINISH, Z_DATA_ERROR if the
+   data is corrupted, Z_NEED_DICT as inflate(), and Z_STREAM_ERROR if the
+   stream state was inconsistent.  The stream must be initialized with
+   inflateInit2() as for inflate(), and not be in the middle of a literal or
+   match left by inflate().
+*/
+
 Z_EXTERN int Z_EXPORT inflateCopy(z_stream *dest, z_stream *source);
 /*
      Sets the destination stream as a complete copy of the source stream.
@@ -1058,6 +1258,71 @@ Z_EXTERN int Z_EXPORT inflateGetHeader(z_stream *strm, gz_headerp head);
    stream state was inconsistent.
 */
 
+Z_EXTERN inflate_cache * Z_EXPORT inflateCacheCreate(unsigned entries);
+/*
+     Allocates a cache of the code tables that inflate() builds for blocks with
+   dynamic Huffman codes.  Once attached to one or more streams with
+   inflateSetCache(), blocks whose code lengths were seen before by any of
+   those streams reuse the tables already built instead of constructing them
+   again, which helps when inflating many small streams produced by the same
+   encoder.  entries is the number of distinct sets of code lengths that can be
+   held, rounded up to a power of two, each taking about 8K.  Zero selects a
+   default of 64, the maximum is 4096.
+
+     Entries are filled by the first stream to decode a set of code lengths
+   that hashes to a free entry, and never change afterwards.  Streams in
+   different threads may share a cache if the platform provides atomic
+   operations, which is the case with gcc, clang and MSVC.
+
+     inflateCacheCreate returns NULL if there was not enough memory, or if
+   the cache would go over the budget set with zlibSetMemoryBudget().
+*/
+
+Z_EXTERN int Z_EXPORT inflateSetCache(z_stream *strm, inflate_cache *cache);
+/*
+     Attaches cache to the stream, or detaches the current cache if cache is
+   NULL.  The cache remains attached across inflateReset() and is shared with
+   copies made by inflateCopy().  It must not be freed while any stream it is
+   attached to is still used.
+
+     inflateSetCache returns Z_OK if success, or Z_STREAM_ERROR if the stream
+   state was inconsistent.
+*/
+
+Z_EXTERN void Z_EXPORT inflateCacheFree(inflate_cache *cache);
+/*
+     Frees a cache allocated by inflateCacheCreate().  cache may be NULL.
+*/
+
+typedef struct inflate_block_s {
+    int type;           /* 0 stored, 1 fixed or 2 dynamic */
+    int last;           /* true for the last block of the stream */
+    z_off64_t in;       /* bit offset of the block header, from the last inflateReset() */
+    z_off64_t out;      /* offset of the first byte of the block, from the same point */
+    unsigned length;    /* length of a stored block */
+    unsigned nlen;      /* number of literal/length codes of a dynamic block */
+    unsigned ndist;     /* number of distance codes of a dynamic block */
+    unsigned ncode;     /* number of code length codes of a dynamic block */
+    uint64_t table_ns;  /* nanoseconds spent building the code tables of a dynamic block */
+} inflate_block;
+
+typedef void (*inflate_block_func)(void *opaque, const inflate_block *block);
+
+Z_EXTERN int Z_EXPORT inflateSetBlockCallback(z_stream *strm, inflate_block_func func, void *opaque);
+/*
+     Sets func to be called by inflate() with opaque and a description of
+   each deflate block, once its header has been read: after the length of a
+   stored block, or after the code tables of a dynamic block were built.  The
+   offsets are those of the start of the block header, so they can serve as
+   access points the way inflateMark() positions can.  func must not call
+   inflate functions on strm.  A NULL func stops the calls.  The callback
+   remains set across inflateReset() and is copied by inflateCopy().  Without
+   a callback inflate() neither fills in nor times anything for it.
+
+     inflateSetBlockCallback returns Z_OK if success, or Z_STREAM_ERROR if the
+   stream state was inconsistent.
+*/
+
 /*
 Z_EXTERN int Z_EXPORT inflateBackInit (z_stream *strm, int windowBits, unsigned char *window);
 
@@ -1199,6 +1464,166 @@ Z_EXTERN unsigned long Z_EXPORT zlibCompileFlags(void);
      27-31: 0 (reserved)
  */
 
+#define Z_PROFILE_DEFLATE        0
+#define Z_PROFILE_FILL_WINDOW    1
+#define Z_PROFILE_READ_BUF       2
+#define Z_PROFILE_SLIDE_HASH     3
+#define Z_PROFILE_INSERT_STRING  4
+#define Z_PROFILE_LONGEST_MATCH  5
+#define Z_PROFILE_FLUSH_BLOCK    6
+#define Z_PROFILE_COMPRESS_BLOCK 7
+#define Z_PROFILE_FLUSH_PENDING  8
+#define Z_PROFILE_INFLATE        9
+#define Z_PROFILE_INFLATE_FAST   10
+#define Z_PROFILE_INFLATE_TABLE  11
+#define Z_PROFILE_INFLATE_CHECK  12
+#define Z_PROFILE_PHASES         13
+/* Phases timed by the profiler.  Deflate: the compression function of the
+   level, fill_window() with read_buf() copying and checksumming the input and
+   slide_hash() inside it, insert_string() of runs of positions, longest_match(),
+   zng_tr_flush_block() with compress_block() inside it, and flush_pending().
+   Single positions inserted by the compression loops are left to the loops.
+   Inflate: the whole inflate() call, inflate_fast(), building the code tables
+   of dynamic blocks, and checksumming the output.  Phases nest as described,
+   the time of a phase includes the phases inside it. */
+
+typedef struct z_profile_s {
+    uint64_t ticks[Z_PROFILE_PHASES];   /* time spent in each phase */
+    uint64_t calls[Z_PROFILE_PHASES];   /* times each phase was entered */
+} z_profile;
+
+Z_EXTERN int Z_EXPORT deflateGetProfile(z_stream *strm, z_profile *profile);
+Z_EXTERN int Z_EXPORT inflateGetProfile(z_stream *strm, z_profile *profile);
+/*
+     Copy the time spent in each phase by strm since it was initialized into
+   *profile.  deflateReset() and inflateReset() do not clear the totals, and a
+   stream made by deflateCopy() or inflateCopy() starts from zero.  Ticks are
+   read from the time stamp counter on x86 and are nanoseconds elsewhere.
+   Reading the clock twice per phase costs tens of cycles, so short phases
+   such as longest_match() appear longer than they are, and the higher levels
+   run up to half again as long as without the profiler.
+
+     The phases are only timed if the library was built with WITH_PROFILE
+   defined, otherwise they cost nothing.  These functions return Z_OK on
+   success, Z_STREAM_ERROR if the stream state was inconsistent or profile is
+   Z_NULL, and Z_VERSION_ERROR if the library was built without WITH_PROFILE.
+*/
+
+Z_EXTERN int Z_EXPORT zlibGetProfile(z_profile *profile, int reset);
+/*
+     Copy the totals of all streams ended by deflateEnd() or inflateEnd() so
+   far into *profile, then clear them if reset is true.  Streams may end on
+   any thread, their totals are added atomically.  zlibGetProfile() returns
+   Z_OK on success, Z_STREAM_ERROR if profile is Z_NULL, and Z_VERSION_ERROR
+   if the library was built without WITH_PROFILE.
+*/
+
+Z_EXTERN int Z_EXPORT zlibProfileDump(const z_profile *profile, char *buf, size_t size);
+/*
+     Write a table of *profile to buf as text, one line per phase that was
+   entered with its calls, ticks and share of the deflate or inflate time it
+   falls under, followed for inflate by the share of the state machine outside
+   inflate_fast(), table building and checksumming.  At most size bytes are
+   written including the terminating null.  zlibProfileDump() returns the
+   length of the whole table as snprintf() does, so a return of size or more
+   means buf was too short, or -1 if profile is Z_NULL.
+*/
+
+Z_EXTERN int Z_EXPORT zlibSetDispatch(const char *spec);
+/*
+     Override the choice of optimized functions made from the features of the
+   CPU, and make the choice again.  spec is a list separated by commas or
+   spaces of isa=<level>, which caps the instruction set used at one of sse2,
+   ssse3, sse41, sse42, pclmulqdq, avx2, avx512, avx512vnni or vpclmulqdq on
+   x86, and <entry>=<variant>, which pins a function such as adler32 or
+   inflate_fast to the implementation of that name, for instance
+   "isa=avx2,crc32=braid" or "adler32=adler32_ssse3".  A pinned variant the CPU
+   or the isa cap does not allow, or that was not built in, is passed over for
+   the best allowed one.  An empty spec clears the overrides, and Z_NULL also
+   goes back to those given by the ZLIB_NG_DISPATCH environment variable,
+   which takes the same list and is read when the choice is first made.
+
+     Each function is switched atomically, so streams in use carry on with a
+   mix of old and new implementations, which give the same results.  The
+   overrides themselves are not protected, so zlibSetDispatch() should not be
+   called from two threads at once.  zlibSetDispatch() returns Z_OK on
+   success, Z_STREAM_ERROR if spec is not valid, leaving the choice as it was,
+   and Z_VERSION_ERROR if the library was built without runtime CPU detection.
+*/
+
+Z_EXTERN int Z_EXPORT zlibGetDispatch(char *buf, size_t size);
+/*
+     Write the CPU features detected, the isa cap if any, and the name of the
+   implementation chosen for each function as text to buf, one per line, in
+   the form "adler32: adler32_avx2".  At most size bytes are written including
+   the terminating null.  zlibGetDispatch() returns the length of the whole
+   text as snprintf() does, or -1 if the choice could not be made.
+*/
+
+Z_EXTERN int Z_EXPORT zlibSetHugePages(int enable);
+/*
+     Have the default allocator, used by streams whose zalloc is Z_NULL, take
+   the state, window and hash tables of the streams initialized from now on
+   from 2 MiB slabs advised as transparent huge pages, if enable is true, or
+   from malloc() again if it is false.  Each slab is bound to the NUMA node of
+   the thread that mapped it, and a stream takes its blocks from the slabs of
+   the node its initializing thread runs on.  This cuts the TLB misses of the
+   random hash chain walks of deflate.  Blocks that can't be had from a slab
+   come from malloc(), and streams keep the allocator they were initialized
+   with until they end.  zlibSetHugePages() returns Z_OK, or Z_VERSION_ERROR if
+   the library was built without WITH_HUGEPAGES or for a system other than
+   Linux.
+*/
+
+Z_EXTERN void * Z_EXPORT zlibHugeAlloc(void *opaque, unsigned int items, unsigned int size);
+Z_EXTERN void   Z_EXPORT zlibHugeFree(void *opaque, void *address);
+/*
+     The allocator of zlibSetHugePages(), to be set as zalloc and zfree of a
+   single stream before it is initialized.  opaque is not used.  Without
+   WITH_HUGEPAGES they are malloc() and free().
+*/
+
+typedef struct z_memory_s {
+    size_t current;     /* bytes held now */
+    size_t peak;        /* most bytes held at once */
+    size_t budget;      /* limit on current set by zlibSetMemoryBudget(), 0 if none */
+} z_memory;
+
+Z_EXTERN int Z_EXPORT zlibGetMemory(z_memory *memory, int reset);
+/*
+     Copy the bytes held by the library for all threads into *memory: the
+   buffers of the deflate and inflate streams taken from zalloc, which are
+   allocated in one piece when a stream is initialized and freed when it ends,
+   the buffers of gzFile objects, and the caches of inflateCacheCreate().
+   Workspaces given to deflateInitWorkspace() and inflateInitWorkspace() are
+   the application's and are not counted.  If reset is true, the peak is set
+   back to the current total after it is copied.  The totals are kept with
+   atomic operations at initialization and end only, so they cost nothing
+   while streams run.  zlibGetMemory() returns Z_OK, or Z_STREAM_ERROR if
+   memory is Z_NULL.
+*/
+
+Z_EXTERN int Z_EXPORT zlibSetMemoryBudget(size_t budget);
+/*
+     Limit the bytes counted by zlibGetMemory() to budget, or lift the limit
+   if budget is zero.  Initializing a stream, a gzFile's first read or write,
+   or inflateCacheCreate() that would go over the budget fails as if memory
+   had run out, with Z_MEM_ERROR or NULL, before calling zalloc.  Lowering the
+   budget below the current total frees nothing, it only refuses what comes
+   next.  zlibSetMemoryBudget() returns Z_OK.
+*/
+
+Z_EXTERN int Z_EXPORT deflateGetMemory(z_stream *strm, size_t *size);
+Z_EXTERN int Z_EXPORT inflateGetMemory(z_stream *strm, size_t *size);
+/*
+     Store in *size the bytes strm took from zalloc and counts in the totals
+   of zlibGetMemory(), or zero if it was initialized in a workspace.  This is
+   both what the stream holds now and its peak, as it allocates nothing after
+   initialization, and is the amount to budget for each stream made with the
+   same parameters.  These functions return Z_OK on success, or Z_STREAM_ERROR
+   if the stream state was inconsistent or size is Z_NULL.
+*/
+
 
 #ifndef Z_SOLO
 
@@ -1248,6 +1673,35 @@ Z_EXTERN unsigned long Z_EXPORT compressBound(unsigned long sourceLen);
    compress() or compress2() call to allocate the destination buffer.
 */
 
+typedef struct compress_item_s {
+    const unsigned char *source;    /* data to compress */
+    unsigned long sourceLen;        /* length of source */
+    unsigned char *dest;            /* buffer for the compressed data */
+    unsigned long destLen;          /* size of dest, set to the compressed length */
+    int status;                     /* set to what compress2() would return */
+} compress_item;
+
+Z_EXTERN int Z_EXPORT compressBatch(compress_item *items, z_size_t count, int level, int threads);
+/*
+     Compresses each of count independent items as compress2() would with
+   the given level, and sets its destLen and status as compress2() sets
+   destLen and its return value.  Rather than a full deflateInit() and
+   deflateEnd() per item, each thread sets up one deflate state and reuses it,
+   and after a small item only clears the part of the state that item used.
+   This is much cheaper than compress2() for many small items.  The
+   compressed data is the same as from compress2().
+
+     Up to threads threads are used, the calling thread being one of them; a
+   threads value below 2 compresses all items on the calling thread.  Threads
+   are only used if zlib was built with WITH_THREADS, otherwise, or if fewer
+   threads can be created, the calling thread and the threads that could be
+   created share out the items.  Items must not overlap each other's dest.
+
+     compressBatch returns Z_OK if the items were compressed, with the result
+   of each one in its status, which is Z_MEM_ERROR if no deflate state could
+   be allocated for it.  It returns Z_STREAM_ERROR if the level is not valid.
+*/
+
 Z_EXTERN int Z_EXPORT uncompress(unsigned char *dest, unsigned long *destLen, const unsigned char *source, unsigned long sourceLen);
 /*
      Decompresses the source buffer into the destination buffer.  sourceLen is
@@ -1691,6 +2145,30 @@ Z_EXTERN unsigned long Z_EXPORT adler32_z(unsigned long adler, const unsigned ch
      Same as adler32(), but with a size_t length.
 */
 
+Z_EXTERN void Z_EXPORT adler32_multi(unsigned long *adler, const unsigned char * const *buf, const size_t *len,
+                                     size_t count);
+/*
+     Update count independent running Adler-32 checksums at once, setting
+   adler[i] to adler32_z(adler[i], buf[i], len[i]) for each i below count.
+   buf[i] may only be Z_NULL if len[i] is zero, it does not return the initial
+   value as adler32() does, so the caller sets adler[i] to that beforehand.
+
+     This gives the same results as calling adler32_z() on each buffer, but
+   computes several checksums side by side, which is considerably faster when
+   there are many short buffers, such as network packets, to checksum.
+*/
+
+Z_EXTERN unsigned long Z_EXPORT adler32_parallel(unsigned long adler, const unsigned char *buf, size_t len,
+                                                 int threads);
+/*
+     Same as adler32_z(), but for a large buffer: buf is cut into slices that
+   are checksummed on up to threads threads, the calling thread being one of
+   them, and the slice checksums are merged as adler32_combine() would.  The
+   result is the same as from adler32_z().  Buffers too short for the threads
+   to pay off, a few megabytes or less, a threads value below 2, or a build
+   without WITH_THREADS checksum the whole buffer on the calling thread.
+*/
+
 /*
 Z_EXTERN unsigned long Z_EXPORT adler32_combine(unsigned long adler1, unsigned long adler2, z_off_t len2);
 
@@ -1725,6 +2203,22 @@ Z_EXTERN unsigned long Z_EXPORT crc32_z(unsigned long crc, const unsigned char *
      Same as crc32(), but with a size_t length.
 */
 
+Z_EXTERN void Z_EXPORT crc32_multi(unsigned long *crc, const unsigned char * const *buf, const size_t *len,
+                                   size_t count);
+/*
+     Update count independent running CRC-32 values at once, setting crc[i]
+   to crc32_z(crc[i], buf[i], len[i]) for each i below count, as for
+   adler32_multi() above.
+*/
+
+Z_EXTERN unsigned long Z_EXPORT crc32_parallel(unsigned long crc, const unsigned char *buf, size_t len, int threads);
+/*
+     Same as crc32_z(), but checksums slices of buf on up to threads threads
+   and merges them with crc32_combine_op(), as for adler32_parallel() above.
+   One operator is generated for the common slice length, so merging costs one
+   multiplication per slice.
+*/
+
 /*
 Z_EXTERN unsigned long Z_EXPORT crc32_combine(unsigned long crc1, unsigned long crc2, z_off64_t len2);
 
@@ -1750,6 +2244,42 @@ Z_EXTERN unsigned long Z_EXPORT crc32_combine_op(unsigned long crc1, unsigned lo
    crc32_combine() if the generated op is used more than once.
 */
 
+Z_EXTERN void Z_EXPORT crc32_combine_gen_multi(unsigned long *op, const z_off64_t *len2, size_t count);
+/*
+     Set op[i] to crc32_combine_gen(len2[i]) for each i below count.  This is
+   faster than generating the operators one at a time when there are many of
+   them, as when combining the CRC-32 values of many chunks of varying length.
+   Every len2[i] must be non-negative.
+*/
+
+Z_EXTERN unsigned long Z_EXPORT crc32c(unsigned long crc, const unsigned char *buf, size_t len);
+/*
+     Update a running CRC-32C (Castagnoli, as used by iSCSI, SCTP and ext4)
+   with the bytes buf[0..len-1] and return the updated CRC-32C, in the same
+   way as crc32_z() does for CRC-32.  If buf is Z_NULL, this function returns
+   the required initial value, which is zero.
+*/
+
+Z_EXTERN unsigned long Z_EXPORT crc32c_copy(unsigned long crc, unsigned char *dst, const unsigned char *src,
+                                            size_t len);
+/*
+     Same as crc32c(), but also copies src[0..len-1] to dst, which must not
+   overlap src.  This reads the data only once.
+*/
+
+Z_EXTERN unsigned long Z_EXPORT crc32c_combine(unsigned long crc1, unsigned long crc2, z_off64_t len2);
+/*
+     Combine two CRC-32C values into one, as crc32_combine() does for CRC-32.
+*/
+
+Z_EXTERN uint64_t Z_EXPORT crc64(uint64_t crc, const unsigned char *buf, size_t len);
+Z_EXTERN uint64_t Z_EXPORT crc64_copy(uint64_t crc, unsigned char *dst, const unsigned char *src, size_t len);
+Z_EXTERN uint64_t Z_EXPORT crc64_combine(uint64_t crc1, uint64_t crc2, z_off64_t len2);
+/*
+     The same three functions for CRC-64/XZ (ECMA-182 polynomial, as used by
+   xz), with a 64-bit check value.  The initial value is zero.
+*/
+
 
                         /* various hacks, don't look :) */
 
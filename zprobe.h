@@ -0,0 +1,68 @@
+/* zprobe.h -- USDT probes for tracing with bpftrace, perf or SystemTap, kept if WITH_USDT is defined
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Each probe is a nop at the probe site and a note in the .note.stapsdt section giving its address, provider,
+ * name and where to find its arguments, in the format of SystemTap's <sys/sdt.h>, which is not needed to build.
+ * A tracer attaching to a probe replaces its nop with a breakpoint, so unattached probes cost the nop and
+ * keeping their arguments at hand. The probes are listed with
+ *
+ *     readelf -n libz.so | grep -A3 stapsdt
+ *
+ * and attached to with, for instance, bpftrace -e 'usdt:libz.so:zlib:deflate_block { @[arg0] = hist(arg3); }'.
+ * Every argument is passed as a 64-bit integer.
+ */
+
+#ifndef ZPROBE_H_
+#define ZPROBE_H_
+
+#include "zbuild.h"
+
+#if defined(WITH_USDT) && defined(__ELF__) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+/* The note of a probe, see https://sourceware.org/systemtap/wiki/UserSpaceProbeImplementation. The
+   .stapsdt.base section lets tracers find how far the library was moved when it was loaded. */
+#define ZPROBE_ASM(name, args) \
+    "990: nop\n" \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+    ".balign 4\n" \
+    ".4byte 992f-991f, 994f-993f, 3\n" \
+    "991: .asciz \"stapsdt\"\n" \
+    "992: .balign 4\n" \
+    "993: .8byte 990b\n" \
+    ".8byte _.stapsdt.base\n" \
+    ".8byte 0\n" \
+    ".asciz \"zlib\"\n" \
+    ".asciz \"" #name "\"\n" \
+    ".asciz \"" args "\"\n" \
+    "994: .balign 4\n" \
+    ".popsection\n" \
+    ".ifndef _.stapsdt.base\n" \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+    ".weak _.stapsdt.base\n" \
+    ".hidden _.stapsdt.base\n" \
+    "_.stapsdt.base: .space 1\n" \
+    ".size _.stapsdt.base,1\n" \
+    ".popsection\n" \
+    ".endif\n"
+
+#  define zprobe0(name) \
+    __asm__ __volatile__(ZPROBE_ASM(name, ""))
+#  define zprobe1(name, a) \
+    __asm__ __volatile__(ZPROBE_ASM(name, "8@%0") :: "nor"((uint64_t)(a)))
+#  define zprobe2(name, a, b) \
+    __asm__ __volatile__(ZPROBE_ASM(name, "8@%0 8@%1") :: "nor"((uint64_t)(a)), "nor"((uint64_t)(b)))
+#  define zprobe3(name, a, b, c) \
+    __asm__ __volatile__(ZPROBE_ASM(name, "8@%0 8@%1 8@%2") :: "nor"((uint64_t)(a)), "nor"((uint64_t)(b)), \
+                         "nor"((uint64_t)(c)))
+#  define zprobe4(name, a, b, c, d) \
+    __asm__ __volatile__(ZPROBE_ASM(name, "8@%0 8@%1 8@%2 8@%3") :: "nor"((uint64_t)(a)), "nor"((uint64_t)(b)), \
+                         "nor"((uint64_t)(c)), "nor"((uint64_t)(d)))
+#else
+#  define zprobe0(name)
+#  define zprobe1(name, a)
+#  define zprobe2(name, a, b)
+#  define zprobe3(name, a, b, c)
+#  define zprobe4(name, a, b, c, d)
+#endif
+
+#endif
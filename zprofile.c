@@ -0,0 +1,96 @@
+/* zprofile.c -- Totals and dump of the phase timing kept if WITH_PROFILE is defined
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "zutil.h"
+#include "zprofile.h"
+#include "zatomic.h"
+
+#include <stdio.h>
+
+#ifdef WITH_PROFILE
+/* Totals of the streams ended so far */
+static z_profile profile_totals;
+
+static uint64_t profile_take(uint64_t *total, int reset) {
+    uint64_t n;
+
+    do {
+        n = zng_atomic_load_64(total);
+    } while (reset && !zng_atomic_cas_64(total, n, 0));
+    return n;
+}
+
+void Z_INTERNAL zprofile_add(const z_profile *profile) {
+    for (int i = 0; i < Z_PROFILE_PHASES; i++) {
+        if (profile->calls[i] == 0)
+            continue;
+        zng_atomic_add_64(&profile_totals.ticks[i], profile->ticks[i]);
+        zng_atomic_add_64(&profile_totals.calls[i], profile->calls[i]);
+    }
+}
+#endif
+
+int32_t Z_EXPORT PREFIX(zlibGetProfile)(z_profile *profile, int32_t reset) {
+#ifdef WITH_PROFILE
+    if (profile == NULL)
+        return Z_STREAM_ERROR;
+    for (int i = 0; i < Z_PROFILE_PHASES; i++) {
+        profile->ticks[i] = profile_take(&profile_totals.ticks[i], reset);
+        profile->calls[i] = profile_take(&profile_totals.calls[i], reset);
+    }
+    return Z_OK;
+#else
+    Z_UNUSED(profile);
+    Z_UNUSED(reset);
+    return Z_VERSION_ERROR;
+#endif
+}
+
+static const char * const profile_names[Z_PROFILE_PHASES] = {
+    "deflate", "  fill_window", "    read_buf", "    slide_hash", "  insert_string", "  longest_match",
+    "  flush_block", "    compress_block", "  flush_pending",
+    "inflate", "  inflate_fast", "  inflate_table", "  inflate_check"
+};
+
+int32_t Z_EXPORT PREFIX(zlibProfileDump)(const z_profile *profile, char *buf, size_t size) {
+    size_t len = 0;
+    uint64_t whole = 0, other;
+
+    if (profile == NULL)
+        return -1;
+
+/* Appends to buf as far as it goes, counting the whole length */
+#define PROFILE_PRINT(...) \
+    do { \
+        int n = snprintf(len < size ? buf + len : NULL, len < size ? size - len : 0, __VA_ARGS__); \
+        if (n > 0) \
+            len += (size_t)n; \
+    } while (0)
+
+    if (size)
+        buf[0] = 0;
+    PROFILE_PRINT("%-20s %12s %16s %7s\n", "phase", "calls", "ticks", "share");
+    for (int i = 0; i < Z_PROFILE_PHASES; i++) {
+        if (i == Z_PROFILE_DEFLATE || i == Z_PROFILE_INFLATE)
+            whole = profile->ticks[i];
+        if (profile->calls[i] == 0)
+            continue;
+        PROFILE_PRINT("%-20s %12llu %16llu %6.1f%%\n", profile_names[i], (unsigned long long)profile->calls[i],
+                      (unsigned long long)profile->ticks[i],
+                      whole ? 100.0 * (double)profile->ticks[i] / (double)whole : 0.0);
+    }
+
+    /* The inflate phases do not nest in each other, what is left of inflate() is the state machine */
+    whole = profile->ticks[Z_PROFILE_INFLATE];
+    other = profile->ticks[Z_PROFILE_INFLATE_FAST] + profile->ticks[Z_PROFILE_INFLATE_TABLE] +
+            profile->ticks[Z_PROFILE_INFLATE_CHECK];
+    other = whole > other ? whole - other : 0;
+    if (profile->calls[Z_PROFILE_INFLATE])
+        PROFILE_PRINT("%-20s %12s %16llu %6.1f%%\n", "  (state machine)", "", (unsigned long long)other,
+                      whole ? 100.0 * (double)other / (double)whole : 0.0);
+#undef PROFILE_PRINT
+
+    return (int32_t)len;
+}
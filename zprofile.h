@@ -0,0 +1,33 @@
+/* zprofile.h -- Phase timing for deflate and inflate, kept if WITH_PROFILE is defined
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ZPROFILE_H_
+#define ZPROFILE_H_
+
+#include "zbuild.h"
+#include "zutil.h"
+
+#ifdef WITH_PROFILE
+#include "zclock.h"
+
+typedef struct zprofile_s {
+    z_profile total;                        /* returned by deflateGetProfile() and inflateGetProfile() */
+    uint64_t start[Z_PROFILE_PHASES];       /* clock when each phase was last entered, so phases can nest */
+} zprofile;
+
+/* Adds the totals of an ending stream to those returned by zlibGetProfile() */
+void Z_INTERNAL zprofile_add(const z_profile *profile);
+
+#  define profile_start(s, phase)   (s)->profile.start[phase] = zclock_ticks()
+#  define profile_stop(s, phase) \
+    do { \
+        (s)->profile.total.ticks[phase] += zclock_ticks() - (s)->profile.start[phase]; \
+        (s)->profile.total.calls[phase]++; \
+    } while (0)
+#else
+#  define profile_start(s, phase)
+#  define profile_stop(s, phase)
+#endif
+
+#endif
@@ -0,0 +1,81 @@
+/* zthread.c -- Fork/join helper for the batch and parallel functions
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zbuild.h"
+#include "zthread.h"
+
+#ifdef WITH_THREADS
+#  ifdef _WIN32
+#    include <windows.h>
+#  else
+#    include <pthread.h>
+#  endif
+
+typedef struct zthread_job_s {
+    zthread_func func;
+    void *arg;
+    unsigned id;
+} zthread_job;
+
+#  ifdef _WIN32
+typedef HANDLE zthread_t;
+
+static DWORD WINAPI zthread_main(LPVOID job_ptr) {
+    zthread_job *job = (zthread_job *)job_ptr;
+    job->func(job->arg, job->id);
+    return 0;
+}
+
+static int zthread_start(zthread_t *thread, zthread_job *job) {
+    *thread = CreateThread(NULL, 0, zthread_main, job, 0, NULL);
+    return *thread != NULL;
+}
+
+static void zthread_join(zthread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#  else
+typedef pthread_t zthread_t;
+
+static void *zthread_main(void *job_ptr) {
+    zthread_job *job = (zthread_job *)job_ptr;
+    job->func(job->arg, job->id);
+    return NULL;
+}
+
+static int zthread_start(zthread_t *thread, zthread_job *job) {
+    return pthread_create(thread, NULL, zthread_main, job) == 0;
+}
+
+static void zthread_join(zthread_t thread) {
+    pthread_join(thread, NULL);
+}
+#  endif
+#endif
+
+Z_INTERNAL unsigned zthread_run(unsigned nthreads, zthread_func func, void *arg) {
+    unsigned started = 1;
+#ifdef WITH_THREADS
+    zthread_job jobs[ZTHREAD_MAX];
+    zthread_t threads[ZTHREAD_MAX];
+
+    nthreads = MIN(nthreads, ZTHREAD_MAX);
+    for (; started < nthreads; started++) {
+        jobs[started].func = func;
+        jobs[started].arg = arg;
+        jobs[started].id = started;
+        if (!zthread_start(&threads[started], &jobs[started]))
+            break;
+    }
+#else
+    Z_UNUSED(nthreads);
+#endif
+    func(arg, 0);
+#ifdef WITH_THREADS
+    for (unsigned i = 1; i < started; i++)
+        zthread_join(threads[i]);
+#endif
+    return started;
+}
@@ -0,0 +1,27 @@
+/* zthread.h -- Fork/join helper for the batch and parallel functions
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ZTHREAD_H_
+#define ZTHREAD_H_
+
+#include "zbuild.h"
+#include "zatomic.h"
+
+/* Most threads a single call will use */
+#define ZTHREAD_MAX 64
+
+typedef void (*zthread_func)(void *arg, unsigned id);
+
+/* Runs func(arg, id) for id 0 to nthreads - 1 and waits for all of them to return, id 0 runs on the calling
+ * thread. Returns how many ran: without WITH_THREADS, or when a thread can't be created, fewer than nthreads do,
+ * so work has to be handed out with zthread_next() rather than by id.
+ */
+Z_INTERNAL unsigned zthread_run(unsigned nthreads, zthread_func func, void *arg);
+
+/* Returns *counter and increments it, shared by all threads of a zthread_run() call */
+static inline size_t zthread_next(size_t *counter) {
+    return zng_atomic_add_size(counter, 1);
+}
+
+#endif
@@ -6,6 +6,8 @@
 #include "zbuild.h"
 #include "zutil_p.h"
 #include "zutil.h"
+#include "zhugepage.h"
+#include "zatomic.h"
 
 z_const char * const PREFIX(z_errmsg)[10] = {
     (z_const char *)"need dictionary",     /* Z_NEED_DICT       2  */
@@ -102,14 +104,19 @@ const char * Z_EXPORT PREFIX(zError)(z_int32_t err) {
 
 // Zlib-ng's default alloc/free implementation, used unless
 // application supplies its own alloc/free functions.
+// After zlibSetHugePages(1) the blocks come from the huge page slabs when they can.
 void Z_INTERNAL *PREFIX(zcalloc)(void *opaque, unsigned items, unsigned size) {
+    void *ptr;
     Z_UNUSED(opaque);
+    if (zhuge_default() && (ptr = zhuge_alloc((size_t)items * (size_t)size)) != NULL)
+        return ptr;
     return zng_alloc((size_t)items * (size_t)size);
 }
 
 void Z_INTERNAL PREFIX(zcfree)(void *opaque, void *ptr) {
     Z_UNUSED(opaque);
-    zng_free(ptr);
+    if (!zhuge_free(ptr))
+        zng_free(ptr);
 }
 
 /* Provide aligned allocations, only used by gz* code */
@@ -149,3 +156,43 @@ void Z_INTERNAL zng_free_aligned(void *ptr) {
     /* Free original memory allocation */
     zng_free(free_ptr);
 }
+
+/* Bytes held by streams, gzFile buffers and inflate caches, their peak and the budget, see zlibGetMemory() */
+static size_t mem_current, mem_peak, mem_budget;
+
+int Z_INTERNAL zng_mem_take(size_t size) {
+    size_t budget = zng_atomic_load_size(&mem_budget);
+    size_t current, peak;
+
+    do {
+        current = zng_atomic_load_size(&mem_current);
+        if (budget && (current > budget || size > budget - current))
+            return -1;
+    } while (!zng_atomic_cas_size(&mem_current, current, current + size));
+
+    current += size;
+    do {
+        peak = zng_atomic_load_size(&mem_peak);
+    } while (peak < current && !zng_atomic_cas_size(&mem_peak, peak, current));
+    return 0;
+}
+
+void Z_INTERNAL zng_mem_give(size_t size) {
+    zng_atomic_add_size(&mem_current, (size_t)0 - size);
+}
+
+int32_t Z_EXPORT PREFIX(zlibGetMemory)(z_memory *memory, int32_t reset) {
+    if (memory == NULL)
+        return Z_STREAM_ERROR;
+    memory->current = zng_atomic_load_size(&mem_current);
+    memory->peak = zng_atomic_load_size(&mem_peak);
+    memory->budget = zng_atomic_load_size(&mem_budget);
+    if (reset)
+        zng_atomic_store_size(&mem_peak, memory->current);
+    return Z_OK;
+}
+
+int32_t Z_EXPORT PREFIX(zlibSetMemoryBudget)(size_t budget) {
+    zng_atomic_store_size(&mem_budget, budget);
+    return Z_OK;
+}
@@ -136,6 +136,11 @@ void Z_INTERNAL  PREFIX(zcfree)(void *opaque, void *ptr);
 void Z_INTERNAL *zng_alloc_aligned(unsigned size, unsigned align);
 void Z_INTERNAL zng_free_aligned(void *ptr);
 
+/* Counts size bytes as held in the totals of zlibGetMemory(), or returns -1 and counts nothing if that would go
+   over the budget of zlibSetMemoryBudget(). zng_mem_give() takes them off again. */
+int  Z_INTERNAL zng_mem_take(size_t size);
+void Z_INTERNAL zng_mem_give(size_t size);
+
 typedef void *zng_calloc_func(void *opaque, unsigned items, unsigned size);
 typedef void  zng_cfree_func(void *opaque, void *ptr);
 
@@ -5,6 +5,7 @@
 #ifndef ZUTIL_P_H
 #define ZUTIL_P_H
 
+#include <stdint.h>
 #include <stdlib.h>
 
 // Zlib-ng's default alloc/free implementation, used unless
@@ -17,4 +18,24 @@ static inline void zng_free(void *ptr) {
     free(ptr);
 }
 
+/* Fixed-point log2 with 8 fractional bits, x must be non-zero */
+static inline uint32_t zng_log2_q8(uint32_t x) {
+    uint32_t bits = 0, result;
+    uint64_t m;
+
+    while (x >> (bits + 1))
+        bits++;
+    /* Normalize x to [1, 2) in Q31 and produce one fraction bit per squaring */
+    m = ((uint64_t)x << 31) >> bits;
+    result = bits << 8;
+    for (int i = 7; i >= 0; i--) {
+        m = (m * m) >> 31;
+        if (m >= ((uint64_t)2 << 31)) {
+            m >>= 1;
+            result |= 1u << i;
+        }
+    }
+    return result;
+}
+
 #endif